@@ -0,0 +1,76 @@
+/**
+ * @file miniargv-dict.c
+ * @brief miniargv tool for building and querying dictionaries used for completion
+ * @author Brecht Sanders
+ *
+ * This tool builds a sorted dictionary file from a text file with one entry per line (e.g. dataset IDs or host aliases),
+ * which can be used by a completion callback function via miniargv_complete_dict().
+ * It can also list the entries of a dictionary starting with a prefix and measure how long that takes.
+ */
+
+#include <miniargv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+int main (int argc, char *argv[])
+{
+  int showhelp = 0;
+  int maxresults = 0;
+  int benchmark = 0;
+  const char* dstfile = NULL;
+  const char* dictfile = NULL;
+  const char* param = NULL;
+  //definition of command line arguments
+  const miniargv_definition argdef[] = {
+    {'h', "help", NULL, miniargv_cb_increment_int, &showhelp, "show command line help", NULL},
+    {'o', "output", "DICT", miniargv_cb_set_const_str, &dstfile, "build dictionary file DICT from text file SOURCE", miniargv_complete_cb_file},
+    {'d', "dict", "DICT", miniargv_cb_set_const_str, &dictfile, "list entries in dictionary file DICT starting with PREFIX", miniargv_complete_cb_file},
+    {'m', "max", "N", miniargv_cb_set_int, &maxresults, "list at most N entries (default: 0 = no limit)", NULL},
+    {'b', "benchmark", "N", miniargv_cb_set_int, &benchmark, "measure time needed to list entries N times (redirect output to /dev/null)", NULL},
+    {0, NULL, "SOURCE|PREFIX", miniargv_cb_set_const_str, &param, "text file with one entry per line (with -o) or prefix of entries to list (with -d)", miniargv_complete_cb_file},
+    MINIARGV_DEFINITION_END
+  };
+  //parse command line arguments
+  if (miniargv_process_arg(argv, argdef, NULL, NULL) != 0)
+    return 1;
+  //show help if requested or if no action was specified
+  if (showhelp || (!dstfile && !dictfile)) {
+    int prognamelen;
+    const char* progname = miniargv_getprogramname(argv[0], &prognamelen);
+    printf("%.*s v%s\nUsage: %.*s ", prognamelen, progname, miniargv_get_version_string(), prognamelen, progname);
+    miniargv_arg_list(argdef, 1);
+    printf("\n");
+    miniargv_arg_help(argdef, 0, 0);
+    return 0;
+  }
+  //build dictionary
+  if (dstfile) {
+    if (!param) {
+      fprintf(stderr, "Missing source file\n");
+      return 1;
+    }
+    if (miniargv_dict_build(param, dstfile) != 0) {
+      fprintf(stderr, "Error building dictionary %s from %s\n", dstfile, param);
+      return 2;
+    }
+  }
+  //list entries starting with prefix
+  if (dictfile) {
+    clock_t start;
+    double elapsed;
+    int i;
+    int count;
+    start = clock();
+    for (i = 0; i < (benchmark > 0 ? benchmark : 1); i++) {
+      if ((count = miniargv_complete_dict(dictfile, (param ? param : ""), 0, maxresults)) < 0) {
+        fprintf(stderr, "Error reading dictionary %s\n", dictfile);
+        return 3;
+      }
+    }
+    elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (benchmark > 0)
+      fprintf(stderr, "%i lookups listing %i entries each in %.3f seconds (%.1f microseconds per lookup)\n", benchmark, count, elapsed, elapsed * 1000000 / benchmark);
+  }
+  return 0;
+}
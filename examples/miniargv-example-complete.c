@@ -46,6 +46,15 @@ int complete_test (char *argv[], char *env[], const miniargv_definition* argdef,
   return 0;
 }
 
+//values from a dictionary built with: miniargv-dict -o <dictionary> <textfile> (specified via environment variable DATASET_DICT)
+int complete_dataset (char *argv[], char *env[], const miniargv_definition* argdef, const miniargv_definition envdef[], const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata)
+{
+  const char* dictfile;
+  if ((dictfile = getenv("DATASET_DICT")) != NULL)
+    miniargv_complete_dict(dictfile, arg, argparampos, 100);
+  return 0;
+}
+
 int main (int argc, char *argv[], char *envp[])
 {
   int showhelp = 0;
@@ -54,6 +63,7 @@ int main (int argc, char *argv[], char *envp[])
   const char* name = NULL;
   const char* filepath = NULL;
   const char* envval = NULL;
+  const char* dataset = NULL;
   //definition of command line arguments
   const miniargv_definition argdef[] = {
     {'h', "help", NULL, miniargv_cb_increment_int, &showhelp, "show command line help", NULL},
@@ -63,6 +73,7 @@ int main (int argc, char *argv[], char *envp[])
     {'f', "file", "PATH", miniargv_cb_set_const_str, &filepath, "set file", miniargv_complete_cb_file},
     {'F', "folder", "PATH", miniargv_cb_set_const_str, &filepath, "set folder", miniargv_complete_cb_folder},
     {'e', "environment", "PATH", miniargv_cb_set_const_str, &envval, "set value (supports environment variables)", miniargv_complete_cb_env},
+    {'D', "dataset", "ID", miniargv_cb_set_const_str, &dataset, "set dataset ID (completed from dictionary specified by DATASET_DICT)", complete_dataset},
     {'d', NULL, "VALUE", miniargv_cb_noop, NULL, "dummy, ignore VALUE", NULL},
     {0, "dummy", "VALUE", miniargv_cb_noop, NULL, "dummy, ignore VALUE", NULL},
     {0, NULL, "PARAM", miniargv_cb_noop, NULL, "parameter", complete_test},
@@ -96,6 +107,7 @@ int main (int argc, char *argv[], char *envp[])
   printf("name = %s\n", (name ? name : ""));
   printf("file = %s\n", (filepath ? filepath : ""));
   printf("envval = %s\n", (envval ? envval : ""));
+  printf("dataset = %s\n", (dataset ? dataset : ""));
   //step through all command line values
   int i = 0;
   while ((i = miniargv_get_next_arg_param(i, argv, argdef, NULL)) > 0) {
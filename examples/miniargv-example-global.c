@@ -15,10 +15,12 @@
 static int showhelp = 0;
 static int verbose = 0;
 static int number = 0;
+static const char* helpsearch = NULL;
 
 //definition of command line arguments
 const miniargv_definition argdef[] = {
   {'h', "help", NULL, miniargv_cb_increment_int, &showhelp, "show command line help", NULL},
+  {0,   "help", "TERM", miniargv_cb_set_const_str, &helpsearch, "only show command line help matching TERM", NULL},
   {'v', "verbose", NULL, miniargv_cb_increment_int, &verbose, "increase verbose mode\n(may be specified multiple times)", NULL},
   {'n', "number", "N", miniargv_cb_set_int, &number, "set number to N", NULL},
   MINIARGV_DEFINITION_END
@@ -29,6 +31,12 @@ int main (int argc, char *argv[])
   //parse command line arguments
   if (miniargv_process_arg(argv, argdef, NULL, NULL) != 0)
     return 1;
+  //show matching help if searched
+  if (helpsearch) {
+    if (miniargv_help_search(argdef, helpsearch, 0, 0) <= 0)
+      printf("No command line arguments found matching: %s\n", helpsearch);
+    return 0;
+  }
   //show help if requested or if no command line arguments were given
   if (showhelp || argc <= 1) {
     int prognamelen;
@@ -0,0 +1,78 @@
+/**
+ * @file miniargv-example-keydir.c
+ * @brief miniargv example reading settings from a key-per-file directory
+ * @author Brecht Sanders
+ *
+ * This an example of how to read settings from a directory with one file per setting, like a Kubernetes ConfigMap or Secret mounted as a volume.
+ * When --watch is specified the settings are read again each time the ..data symbolic link in the directory is swapped.
+ */
+
+#include <miniargv.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+//settings read from the directory
+static int workers = 1;
+static int debug = 0;
+static char* name = NULL;
+static char* password = NULL;
+
+//definition of settings (each one is a file in the directory)
+const miniargv_definition cfgdef[] = {
+  {0, "workers", "N", miniargv_cb_set_int, &workers, "number of workers", NULL},
+  {0, "debug", "BOOL", miniargv_cb_set_boolean, &debug, "enable debugging", NULL},
+  {0, "name", "NAME", miniargv_cb_strdup, &name, "name of the service", NULL},
+  {0, "password", "SECRET", miniargv_cb_strdup, &password, "password of the service", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+//command line options
+static int showhelp = 0;
+static int watch = 0;
+static const char* keydir = NULL;
+
+//definition of command line arguments
+const miniargv_definition argdef[] = {
+  {'h', "help", NULL, miniargv_cb_increment_int, &showhelp, "show command line help", NULL},
+  {'w', "watch", NULL, miniargv_cb_set_int_to_one, &watch, "read settings again each time the directory is updated", NULL},
+  {0, NULL, "DIR", miniargv_cb_set_const_str, &keydir, "directory with one file per setting", miniargv_complete_cb_folder},
+  MINIARGV_DEFINITION_END
+};
+
+int main (int argc, char *argv[])
+{
+  miniargv_keydir_watch* keydirwatch = NULL;
+  //parse command line arguments
+  if (miniargv_process_arg(argv, argdef, NULL, NULL) != 0)
+    return 1;
+  //show help if requested or if no directory was given
+  if (showhelp || !keydir) {
+    int prognamelen;
+    const char* progname = miniargv_getprogramname(argv[0], &prognamelen);
+    printf("%.*s v%s\nUsage: %.*s ", prognamelen, progname, miniargv_get_version_string(), prognamelen, progname);
+    miniargv_arg_list(argdef, 1);
+    printf("\n");
+    miniargv_arg_help(argdef, 0, 0);
+    return 0;
+  }
+  //start watching before reading the settings, so no update is missed
+  if (watch && (keydirwatch = miniargv_keydir_watch_create(keydir)) == NULL) {
+    fprintf(stderr, "Error watching directory %s\n", keydir);
+    return 2;
+  }
+  do {
+    //read settings
+    miniargv_cleanup(cfgdef);
+    if (miniargv_process_keydir(keydir, cfgdef, NULL) != 0) {
+      fprintf(stderr, "Error reading settings from directory %s\n", keydir);
+      miniargv_keydir_watch_free(keydirwatch);
+      return 3;
+    }
+    //show settings
+    printf("workers = %i, debug = %i, name = %s, password = %s\n", workers, debug, (name ? name : "NULL"), (password ? "(set)" : "NULL"));
+    fflush(stdout);
+  } while (keydirwatch && miniargv_keydir_watch_wait(keydirwatch, -1) == 1);
+  miniargv_keydir_watch_free(keydirwatch);
+  miniargv_cleanup(cfgdef);
+  return 0;
+}
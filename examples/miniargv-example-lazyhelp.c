@@ -0,0 +1,141 @@
+/**
+ * @file miniargv-example-lazyhelp.c
+ * @brief miniargv example with compressed help texts that are only loaded when help is shown
+ * @author Brecht Sanders
+ *
+ * This an example of how to keep help texts out of the memory of an application until help is actually requested.
+ * When built normally the compressed help texts can be written with --write-help=FILE.
+ * When built with MINIARGV_COMPRESS_HELP defined the help texts are left out of the binary and read from that file only when help is shown.
+ */
+
+#include <miniargv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+//options
+int showhelp = 0;
+int benchmark = 0;
+int verbose = 0;
+int dryrun = 0;
+int compresslevel = 6;
+int threads = 1;
+long blocksize = 65536;
+long retention = 30;
+const char* helpfile = NULL;
+const char* writehelp = NULL;
+const char* source = NULL;
+const char* destination = NULL;
+const char* exclude = NULL;
+const char* keyfile = NULL;
+const char* logfile = NULL;
+const char* schedule = NULL;
+
+//definition of command line arguments
+const miniargv_definition argdef[] = {
+  {'h', "help", NULL, miniargv_cb_increment_int, &showhelp, MINIARGV_HELP("show command line help, using the compressed help texts from the file specified with --help-file when built with MINIARGV_COMPRESS_HELP"), NULL},
+  {0,   "help-file", "FILE", miniargv_cb_set_const_str, &helpfile, MINIARGV_HELP("file with compressed help texts written with --write-help, only read when help is shown"), miniargv_complete_cb_file},
+  {0,   "write-help", "FILE", miniargv_cb_set_const_str, &writehelp, MINIARGV_HELP("write compressed help texts of all command line arguments to FILE (only useful when not built with MINIARGV_COMPRESS_HELP)"), miniargv_complete_cb_file},
+  {'v', "verbose", NULL, miniargv_cb_increment_int, &verbose, MINIARGV_HELP("increase verbose mode, showing each file as it is processed and a summary of the number of files and bytes processed at the end\n(may be specified multiple times)"), NULL},
+  {'n', "dry-run", NULL, miniargv_cb_set_int_to_one, &dryrun, MINIARGV_HELP("only show which files would be processed, without reading or writing any of them, which is useful to check the effect of the exclude pattern"), NULL},
+  {'s', "source", "PATH", miniargv_cb_set_const_str, &source, MINIARGV_HELP("path of the folder to back up, which is processed recursively, following symbolic links only when they point to a location inside the folder"), miniargv_complete_cb_folder},
+  {'d', "destination", "PATH", miniargv_cb_set_const_str, &destination, MINIARGV_HELP("path of the folder where the backup is written, which is created if it doesn't exist yet and must not be located inside the source folder"), miniargv_complete_cb_folder},
+  {'x', "exclude", "PATTERN", miniargv_cb_set_const_str, &exclude, MINIARGV_HELP("pattern of files to exclude from the backup, where * matches any number of characters and ? matches exactly one character, applied to the path relative to the source folder"), NULL},
+  {'c', "compress", "LEVEL", miniargv_cb_set_int, &compresslevel, MINIARGV_HELP("compression level from 0 (no compression, fastest) to 9 (best compression, slowest), where higher levels use more memory and processing time (default: 6)"), NULL},
+  {'t', "threads", "N", miniargv_cb_set_int, &threads, MINIARGV_HELP("number of threads used for compressing and encrypting blocks, where each thread uses its own buffer of the block size (default: 1)"), NULL},
+  {0,   "block-size", "BYTES", miniargv_cb_set_long, &blocksize, MINIARGV_HELP("size of the blocks files are split into before compressing and encrypting them, where larger blocks compress better but use more memory (default: 65536)"), NULL},
+  {'k', "key-file", "FILE", miniargv_cb_set_const_str, &keyfile, MINIARGV_HELP("file containing the key used for encrypting the backup, which must be kept in a safe place as the backup can't be restored without it"), miniargv_complete_cb_file},
+  {'r', "retention", "DAYS", miniargv_cb_set_long, &retention, MINIARGV_HELP("number of days previous backups in the destination folder are kept before they are removed, where 0 means previous backups are never removed (default: 30)"), NULL},
+  {0,   "schedule", "WHEN", miniargv_cb_set_const_str, &schedule, MINIARGV_HELP("when to run the backup, either daily, weekly or monthly, which is written to the destination folder so the next backup knows when it is due"), NULL},
+  {'l', "log", "FILE", miniargv_cb_set_const_str, &logfile, MINIARGV_HELP("file where the messages shown in verbose mode are written to, which is appended to if it already exists so the messages of previous backups are kept"), miniargv_complete_cb_file},
+  {'b', "benchmark", "N", miniargv_cb_set_int, &benchmark, MINIARGV_HELP("measure time needed to process the command line arguments N times, and show the number of page faults and the memory used when done"), NULL},
+  MINIARGV_DEFINITION_END
+};
+
+//read the contents of a file, returns NULL on error
+void* read_file (const char* path, size_t* size)
+{
+  FILE* src;
+  long len;
+  void* data = NULL;
+  if ((src = fopen(path, "rb")) == NULL)
+    return NULL;
+  if (fseek(src, 0, SEEK_END) == 0 && (len = ftell(src)) > 0 && fseek(src, 0, SEEK_SET) == 0 && (data = malloc(len)) != NULL) {
+    if (fread(data, 1, len, src) == (size_t)len) {
+      *size = len;
+    } else {
+      free(data);
+      data = NULL;
+    }
+  }
+  fclose(src);
+  return data;
+}
+
+int main (int argc, char *argv[])
+{
+  int i;
+  //parse command line arguments
+  if (miniargv_process_arg(argv, argdef, NULL, NULL) != 0)
+    return 1;
+  //write compressed help texts if requested
+  if (writehelp) {
+    FILE* dst;
+    int status = -1;
+    if ((dst = fopen(writehelp, "wb")) != NULL) {
+      status = miniargv_help_compress(dst, argdef);
+      if (fclose(dst) != 0)
+        status = -1;
+    }
+    if (status != 0) {
+      fprintf(stderr, "Error writing compressed help texts to %s\n", writehelp);
+      return 2;
+    }
+  }
+  //show help if requested or if no command line arguments were given
+  if (showhelp || argc <= 1) {
+    int prognamelen;
+    void* blob = NULL;
+    size_t blobsize = 0;
+    const char* progname = miniargv_getprogramname(argv[0], &prognamelen);
+    //load compressed help texts (only needed when built with MINIARGV_COMPRESS_HELP)
+    if (helpfile) {
+      if ((blob = read_file(helpfile, &blobsize)) == NULL) {
+        fprintf(stderr, "Error reading compressed help texts from %s\n", helpfile);
+        return 3;
+      }
+      miniargv_set_compressed_help(argdef, blob, blobsize);
+    }
+    printf("%.*s v%s\nUsage: %.*s ", prognamelen, progname, miniargv_get_version_string(), prognamelen, progname);
+    miniargv_arg_list(argdef, 1);
+    printf("\n");
+    miniargv_arg_help(argdef, 0, 0);
+    miniargv_set_compressed_help(argdef, NULL, 0);
+    free(blob);
+    return 0;
+  }
+  //measure time needed to process the command line arguments
+  if (benchmark > 0) {
+    clock_t start;
+    double elapsed;
+    start = clock();
+    for (i = 0; i < benchmark; i++)
+      miniargv_process_arg(argv, argdef, NULL, NULL);
+    elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%i times processed in %.3f seconds (%.1f microseconds each)\n", benchmark, elapsed, elapsed * 1000000 / benchmark);
+#ifndef _WIN32
+    {
+      struct rusage usage;
+      if (getrusage(RUSAGE_SELF, &usage) == 0)
+        printf("page faults: %li minor, %li major, maximum resident set size: %li KB\n", (long)usage.ru_minflt, (long)usage.ru_majflt, (long)usage.ru_maxrss);
+    }
+#endif
+  }
+  //show values
+  if (verbose)
+    printf("source = %s, destination = %s, compress = %i, threads = %i, block size = %li, retention = %li\n", (source ? source : "NULL"), (destination ? destination : "NULL"), compresslevel, threads, blocksize, retention);
+  return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file miniargv-example-multicall.c
+ * @brief miniargv example for a multi-call binary
+ * @author Brecht Sanders
+ *
+ * This an example of how to use miniargv to implement a multi-call binary.
+ * Applets can be invoked as a symbolic link with the applet name, or with the applet name as the first argument.
+ * Bash completion for the binary and all applets can be configured with:
+ *   eval "$(miniargv-example-multicall --bash-complete-script)"
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <miniargv.h>
+
+//applet that prints a greeting
+int showhelp_hello = 0;
+const char* name_hello = "world";
+const miniargv_definition argdef_hello[] = {
+  {'h', "help", NULL, miniargv_cb_increment_int, &showhelp_hello, "show command line help", NULL},
+  {'n', "name", "NAME", miniargv_cb_set_const_str, &name_hello, "name to greet", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+int main_hello (int argc, char* argv[], char* env[])
+{
+  if (miniargv_process_arg(argv, argdef_hello, NULL, NULL) != 0)
+    return 1;
+  if (showhelp_hello) {
+    printf("Usage: %s ", argv[0]);
+    miniargv_arg_list(argdef_hello, 1);
+    printf("\n");
+    miniargv_arg_help(argdef_hello, 0, 0);
+    return 0;
+  }
+  printf("Hello %s!\n", name_hello);
+  return 0;
+}
+
+//applet that counts
+int showhelp_count = 0;
+int from_count = 1;
+int to_count = 10;
+const miniargv_definition argdef_count[] = {
+  {'h', "help", NULL, miniargv_cb_increment_int, &showhelp_count, "show command line help", NULL},
+  {'f', "from", "N", miniargv_cb_set_int, &from_count, "start counting at N (default: 1)", NULL},
+  {'t', "to", "N", miniargv_cb_set_int, &to_count, "stop counting at N (default: 10)", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+int main_count (int argc, char* argv[], char* env[])
+{
+  int i;
+  if (miniargv_process_arg(argv, argdef_count, NULL, NULL) != 0)
+    return 1;
+  if (showhelp_count) {
+    printf("Usage: %s ", argv[0]);
+    miniargv_arg_list(argdef_count, 1);
+    printf("\n");
+    miniargv_arg_help(argdef_count, 0, 0);
+    return 0;
+  }
+  for (i = from_count; i <= to_count; i++)
+    printf("%i\n", i);
+  return 0;
+}
+
+const miniargv_applet applets[] = {
+  {"hello", main_hello, argdef_hello, NULL, "print a greeting"},
+  {"count", main_count, argdef_count, NULL, "count from one number to another"},
+  MINIARGV_APPLET_END
+};
+
+int main (int argc, char *argv[], char *envp[])
+{
+  int result;
+  int prognamelen;
+  const char* progname;
+  //check if we are being called for bash completion (configured via: "complete -C<path> <command>" for the binary and each applet)
+  if (miniargv_applet_completion(argv, envp, applets, NULL, NULL))
+    return 0;
+  //write bash commands to configure completion
+  if (argc == 2 && strcmp(argv[1], "--bash-complete-script") == 0) {
+    miniargv_applet_completion_script(stdout, argv[0], NULL, applets);
+    return 0;
+  }
+  //run applet
+  if ((result = miniargv_applet_main(argc, argv, envp, applets)) != MINIARGV_APPLET_NOT_FOUND)
+    return result;
+  //show help
+  progname = miniargv_getprogramname(argv[0], &prognamelen);
+  printf("%.*s v%s\nUsage: %.*s APPLET [ARGS...]\n", prognamelen, progname, miniargv_get_version_string(), prognamelen, progname);
+  printf("Program to demonstrate miniargv library multi-call binaries\n");
+  printf("Applets:\n");
+  miniargv_applet_help(applets, 0, 0);
+  return (argc > 1 ? 1 : 0);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file miniargv-example-overlay.c
+ * @brief miniargv example using overlays
+ * @author Brecht Sanders
+ *
+ * This an example of how to use overlays to let individual requests override some of the global options, without copying or modifying them.
+ * Each request is specified as a standalone value argument in the form name=value[,name=value...].
+ */
+
+#include <miniargv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//global options
+int showhelp = 0;
+int benchmark = 0;
+int timeout = 30;
+long batchsize = 1000;
+const char* compression = "none";
+
+//requests specified on the command line
+int requestcount = 0;
+const char** requests = NULL;
+
+//callback function to add a request
+int process_arg_request (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  requests = (const char**)realloc(requests, (requestcount + 1) * sizeof(const char*));
+  requests[requestcount++] = value;
+  return 0;
+}
+
+//definition of command line arguments (the options that can be overridden by requests are at the top)
+#define ARGDEF_TIMEOUT 0
+#define ARGDEF_BATCHSIZE 1
+#define ARGDEF_COMPRESSION 2
+const miniargv_definition argdef[] = {
+  {'t', "timeout", "SECONDS", miniargv_cb_set_int, &timeout, "default request timeout (default: 30)", NULL},
+  {'s', "batch-size", "N", miniargv_cb_set_long, &batchsize, "default batch size (default: 1000)", NULL},
+  {'c', "compression", "METHOD", miniargv_cb_set_const_str, &compression, "default compression method (default: none)", NULL},
+  {'h', "help", NULL, miniargv_cb_increment_int, &showhelp, "show command line help", NULL},
+  {'b', "benchmark", "N", miniargv_cb_set_int, &benchmark, "measure time needed to handle N requests", NULL},
+  {0, NULL, "REQUEST", process_arg_request, NULL, "request overriding options (e.g.: timeout=5,compression=gzip)", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+//apply overrides in the form name=value[,name=value...] to overlay (modifies request), returns 0 on success
+int apply_request (miniargv_overlay* overlay, char* request)
+{
+  char* name;
+  char* value;
+  char* next;
+  for (name = request; name && *name; name = next) {
+    if ((next = strchr(name, ',')) != NULL)
+      *next++ = 0;
+    if ((value = strchr(name, '=')) == NULL) {
+      fprintf(stderr, "Missing value for option: %s\n", name);
+      return -1;
+    }
+    *value++ = 0;
+    if (miniargv_overlay_set_longarg(overlay, name, value) != 0) {
+      fprintf(stderr, "Invalid option or value: %s=%s\n", name, value);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int main (int argc, char *argv[])
+{
+  int i;
+  char* request;
+  //parse command line arguments
+  if (miniargv_process_arg(argv, argdef, NULL, NULL) != 0)
+    return 1;
+  //show help if requested or if no command line arguments were given
+  if (showhelp || argc <= 1) {
+    int prognamelen;
+    const char* progname = miniargv_getprogramname(argv[0], &prognamelen);
+    printf("%.*s v%s\nUsage: %.*s ", prognamelen, progname, miniargv_get_version_string(), prognamelen, progname);
+    miniargv_arg_list(argdef, 1);
+    printf("\n");
+    miniargv_arg_help(argdef, 0, 0);
+    return 0;
+  }
+  //handle each request with its own overlay on top of the global options
+  for (i = 0; i < requestcount; i++) {
+    miniargv_overlay overlay = MINIARGV_OVERLAY(argdef);
+    request = strdup(requests[i]);
+    if (apply_request(&overlay, request) == 0)
+      printf("request %i: timeout = %i, batch-size = %li, compression = %s\n", i + 1, MINIARGV_OVERLAY_INT(&overlay, &argdef[ARGDEF_TIMEOUT]), MINIARGV_OVERLAY_LONG(&overlay, &argdef[ARGDEF_BATCHSIZE]), MINIARGV_OVERLAY_STR(&overlay, &argdef[ARGDEF_COMPRESSION]));
+    free(request);
+  }
+  printf("global: timeout = %i, batch-size = %li, compression = %s\n", timeout, batchsize, compression);
+  //measure time needed to create an overlay, override 2 options and read all 3 options per request
+  if (benchmark > 0) {
+    clock_t start;
+    double elapsed;
+    long total = 0;
+    start = clock();
+    for (i = 0; i < benchmark; i++) {
+      miniargv_overlay overlay = MINIARGV_OVERLAY(argdef);
+      miniargv_overlay_set(&overlay, &argdef[ARGDEF_TIMEOUT], (i & 1 ? "5" : "10"));
+      miniargv_overlay_set(&overlay, &argdef[ARGDEF_COMPRESSION], "gzip");
+      total += MINIARGV_OVERLAY_INT(&overlay, &argdef[ARGDEF_TIMEOUT]) + MINIARGV_OVERLAY_LONG(&overlay, &argdef[ARGDEF_BATCHSIZE]) + strlen(MINIARGV_OVERLAY_STR(&overlay, &argdef[ARGDEF_COMPRESSION]));
+    }
+    elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%i requests handled in %.3f seconds (%.0f requests per second, checksum %li)\n", benchmark, elapsed, (elapsed > 0 ? benchmark / elapsed : 0), total);
+  }
+  free(requests);
+  return 0;
+}
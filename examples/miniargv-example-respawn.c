@@ -0,0 +1,115 @@
+/**
+ * @file miniargv-example-respawn.c
+ * @brief miniargv example starting a child process with the same options
+ * @author Brecht Sanders
+ *
+ * This an example of how to render the options set from a configuration file, environment variables and command line arguments
+ * into a minimal canonical set of command line arguments and environment variables, which can be used to start a child process
+ * with exactly the same options without it having to read the configuration file again.
+ */
+
+#include <miniargv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+//all options in one structure, so precomputed defaults know their initial values
+struct options_struct {
+  int showhelp;
+  int respawn;
+  int verbose;
+  int workers;
+  long timeout;
+  int color;
+  char* name;
+  char* logfile;
+  const char* cfgfile;
+};
+
+static struct options_struct options = {
+  .showhelp = 0,
+  .respawn = 0,
+  .verbose = 0,
+  .workers = 4,
+  .timeout = 0,
+  .color = 1,
+  .name = NULL,
+  .logfile = NULL,
+  .cfgfile = NULL
+};
+
+//definition of command line arguments (also used for configuration file variables)
+const miniargv_definition argdef[] = {
+  {'h', "help", NULL, miniargv_cb_increment_int, &options.showhelp, "show command line help", NULL},
+  {'r', "respawn", NULL, miniargv_cb_set_int_to_one, &options.respawn, "start a new process with the same options", NULL},
+  {'v', "verbose", NULL, miniargv_cb_increment_int, &options.verbose, "increase verbose mode\n(may be specified multiple times)", NULL},
+  {'q', "quiet", NULL, miniargv_cb_set_int_to_zero, &options.verbose, "disable verbose mode", NULL},
+  {'w', "workers", "N", miniargv_cb_set_int, &options.workers, "number of worker processes (default: 4)", NULL},
+  {'t', "timeout", "SECONDS", miniargv_cb_set_long, &options.timeout, "timeout in seconds (default: 30)", NULL, NULL, 0, "30"},
+  {0,   "no-color", NULL, miniargv_cb_set_int_to_zero, &options.color, "disable colors", NULL},
+  {'n', "name", "NAME", miniargv_cb_strdup, &options.name, "name of the service", NULL},
+  {'l', "log", "FILE", miniargv_cb_strdup, &options.logfile, "log file", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+//definition of environment variables
+const miniargv_definition envdef[] = {
+  {0, "SERVICE_CONFIG", "FILE", miniargv_cb_set_const_str, &options.cfgfile, "read options from configuration file", NULL},
+  {0, "SERVICE_NAME", "NAME", miniargv_cb_strdup, &options.name, "name of the service", NULL},
+  {0, "SERVICE_WORKERS", "N", miniargv_cb_set_int, &options.workers, "number of worker processes", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+int main (int argc, char *argv[], char *envp[])
+{
+  miniargv_defaults* defaults;
+  char** childargv;
+  char** childenv;
+  char** p;
+  int respawn;
+  //remember initial values before processing
+  if ((defaults = miniargv_defaults_create(argdef, &options, sizeof(options))) == NULL || miniargv_defaults_apply(defaults, NULL) != 0)
+    return 1;
+  //process environment, configuration file (if specified) and command line arguments in that order
+  if (miniargv_process_env(envp, envdef, NULL) != 0)
+    return 1;
+  if (options.cfgfile && miniargv_process_cfgfile(options.cfgfile, argdef, NULL) != 0)
+    return 1;
+  if (miniargv_process_arg(argv, argdef, NULL, NULL) != 0)
+    return 1;
+  //show help if requested
+  if (options.showhelp) {
+    int prognamelen;
+    const char* progname = miniargv_getprogramname(argv[0], &prognamelen);
+    printf("%.*s v%s\nUsage: %.*s ", prognamelen, progname, miniargv_get_version_string(), prognamelen, progname);
+    miniargv_arg_list(argdef, 1);
+    printf("\n");
+    miniargv_help(argdef, envdef, 0, 0);
+    return 0;
+  }
+  //show values
+  printf("[%lu] verbose = %i, workers = %i, timeout = %li, color = %i, name = %s, log = %s\n", (unsigned long)getpid(), options.verbose, options.workers, options.timeout, options.color, (options.name ? options.name : "NULL"), (options.logfile ? options.logfile : "NULL"));
+  //render canonical options (without respawning again or reading the configuration file)
+  respawn = options.respawn;
+  options.respawn = 0;
+  options.cfgfile = NULL;
+  if ((childargv = miniargv_emit(argv[0], argdef, envp, envdef, defaults, &childenv)) == NULL)
+    return 1;
+  printf("[%lu] canonical command line:", (unsigned long)getpid());
+  for (p = childargv; *p; p++)
+    printf(" %s", *p);
+  printf("\n");
+  if (respawn) {
+    fflush(stdout);
+#ifndef _WIN32
+    execve(childargv[0], childargv, childenv);
+    perror("Error starting child process");
+#endif
+  }
+  free(childargv);
+  miniargv_defaults_free(defaults);
+  miniargv_cleanup(argdef);
+  return 0;
+}
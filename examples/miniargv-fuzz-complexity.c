@@ -0,0 +1,525 @@
+/**
+ * @file miniargv-fuzz-complexity.c
+ * @brief miniargv complexity fuzzer
+ * @author Brecht Sanders
+ *
+ * This program generates random input of increasing size for the miniargv entry points and measures the cost of processing it.
+ * The cost is measured as the number of instructions executed (Linux perf events) or as CPU time if that is not available.
+ * Any entry point for which the cost grows faster than linear with the input size is reported.
+ * The cases to run (entry point, random seed and range of input sizes) are read from a corpus file, so results are reproducible.
+ * Corpus file format (one case per line, lines starting with # are comments):
+ *   <case> <seed> <minsize> <maxsize>
+ */
+
+#include <miniargv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+//random number generator with reproducible results (xorshift)
+static unsigned long long random_state = 1;
+
+static void random_seed (unsigned long long seed)
+{
+  random_state = (seed ? seed : 1) * 0x9E3779B97F4A7C15ull;
+}
+
+static unsigned int random_next (unsigned int limit)
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+  return (unsigned int)(random_state >> 32) % limit;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//cost measurement (instructions executed or CPU time in nanoseconds)
+#ifdef __linux__
+static int perf_fd = -1;
+#endif
+
+static const char* cost_init ()
+{
+#ifdef __linux__
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  if ((perf_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0)) >= 0)
+    return "instructions";
+#endif
+  return "CPU time (ns)";
+}
+
+static void cost_start ()
+{
+#ifdef __linux__
+  if (perf_fd >= 0) {
+    ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+}
+
+static double cost_stop (double starttime)
+{
+#ifdef __linux__
+  long long count;
+  if (perf_fd >= 0) {
+    ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(perf_fd, &count, sizeof(count)) == sizeof(count))
+      return (double)count;
+  }
+#endif
+  return (double)clock() * 1e9 / CLOCKS_PER_SEC - starttime;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//definitions used for processing generated input
+static int counter = 0;
+static const char* value = NULL;
+
+static int cb_count (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  counter++;
+  return 0;
+}
+
+static int cb_bulk (const miniargv_definition* argdef, int argc, char* argv[], void* callbackdata)
+{
+  counter += argc;
+  return 0;
+}
+
+static int cb_bad (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  return 0;
+}
+
+static const miniargv_definition subdef[] = {
+  {'x', "extra", "X", miniargv_cb_set_const_str, &value, "extra value", NULL},
+  {'y', "yes", NULL, miniargv_cb_increment_int, &counter, "flag", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static const miniargv_definition argdef[] = {
+  {'v', "verbose", NULL, miniargv_cb_increment_int, &counter, "flag", NULL},
+  {'n', "number", "N", miniargv_cb_set_const_str, &value, "value", NULL},
+  {'s', "string", "S", miniargv_cb_set_const_str, &value, "value", NULL},
+  MINIARGV_DEFINITION_INCLUDE(subdef),
+  {0, "long-option-without-short-option", NULL, miniargv_cb_increment_int, &counter, "flag", NULL},
+  {0, "long-option-with-value", "V", miniargv_cb_set_const_str, &value, "value", NULL},
+  {0, NULL, "PARAM", cb_count, NULL, "standalone value", NULL, cb_bulk},
+  MINIARGV_DEFINITION_END
+};
+
+static const miniargv_definition envdef[] = {
+  {0, "MINIARGV_NUMBER", "N", miniargv_cb_set_const_str, &value, "value", NULL},
+  {0, "MINIARGV_STRING", "S", miniargv_cb_set_const_str, &value, "value", NULL},
+  {0, "MINIARGV_VERBOSE", NULL, miniargv_cb_increment_int, &counter, "flag", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static const miniargv_definition cfgdef[] = {
+  {0, "number", "N", cb_count, NULL, "value", NULL},
+  {0, "string", "S", cb_count, NULL, "value", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+////////////////////////////////////////////////////////////////////////
+
+//generated input
+static char** args = NULL;
+static char* argsdata = NULL;
+static char tmpdir[1024];
+static char cfgpath[1100];
+
+static const char* argument_samples[] = {"-v", "--verbose", "-n1", "--number=2", "-s", "text", "--string", "text", "-x", "--extra=abc", "-y", "--yes", "--long-option-without-short-option", "--long-option-with-value=v", "value", "-", NULL};
+
+static void free_input ()
+{
+  free(args);
+  free(argsdata);
+  args = NULL;
+  argsdata = NULL;
+}
+
+//generate n random arguments, with "--" in the middle if terminator is set
+static int generate_argv (size_t n, int terminator)
+{
+  size_t i;
+  size_t samples = 0;
+  if ((args = (char**)malloc((n + 2) * sizeof(char*))) == NULL)
+    return -1;
+  while (argument_samples[samples])
+    samples++;
+  args[0] = (char*)"fuzz";
+  for (i = 1; i <= n; i++)
+    args[i] = (char*)argument_samples[random_next(samples)];
+  //make sure the last argument is not an option without its value
+  args[n] = (char*)"value";
+  if (terminator)
+    args[n / 2] = (char*)"--";
+  args[n + 1] = NULL;
+  return 0;
+}
+
+//generate environment with n variables
+static int generate_env (size_t n)
+{
+  size_t i;
+  char* p;
+  if ((args = (char**)malloc((n + 1) * sizeof(char*))) == NULL || (argsdata = (char*)malloc(n * 32)) == NULL)
+    return -1;
+  p = argsdata;
+  for (i = 0; i < n; i++) {
+    args[i] = p;
+    switch (random_next(8)) {
+      case 0 :
+        p += sprintf(p, "MINIARGV_NUMBER=%u", random_next(1000)) + 1;
+        break;
+      case 1 :
+        p += sprintf(p, "MINIARGV_VERBOSE=") + 1;
+        break;
+      default :
+        p += sprintf(p, "VARIABLE_%lu=%u", (unsigned long)i, random_next(1000)) + 1;
+        break;
+    }
+  }
+  args[n] = NULL;
+  return 0;
+}
+
+//write configuration file with n lines, or one line of length n if longline is set
+static int generate_cfgfile (const char* path, size_t n, int longline, const char* include)
+{
+  size_t i;
+  FILE* dst;
+  if ((dst = fopen(path, "wb")) == NULL)
+    return -1;
+  if (longline) {
+    fprintf(dst, "string = ");
+    for (i = 0; i < n; i++)
+      fputc('a' + random_next(26), dst);
+    fprintf(dst, "\n");
+  } else {
+    for (i = 0; i < n; i++) {
+      switch (random_next(4)) {
+        case 0 :
+          fprintf(dst, "number = %u\n", random_next(1000));
+          break;
+        case 1 :
+          fprintf(dst, "  string : value %u  \n", random_next(1000));
+          break;
+        case 2 :
+          fprintf(dst, "# comment %u\n", random_next(1000));
+          break;
+        default :
+          fprintf(dst, "unknown=%u\n", random_next(1000));
+          break;
+      }
+    }
+  }
+  if (include)
+    fprintf(dst, "@%s\n", include);
+  fclose(dst);
+  return 0;
+}
+
+//write chain of n configuration files including each other
+static int generate_cfgfile_chain (size_t n)
+{
+  size_t i;
+  char path[1100];
+  char includepath[1100];
+  for (i = n; i-- > 0; ) {
+    snprintf(path, sizeof(path), "%s/miniargv-fuzz-%lu.cfg", tmpdir, (unsigned long)i);
+    snprintf(includepath, sizeof(includepath), "%s/miniargv-fuzz-%lu.cfg", tmpdir, (unsigned long)i + 1);
+    if (generate_cfgfile(path, 1, 0, (i + 1 < n ? includepath : NULL)) != 0)
+      return -1;
+  }
+  snprintf(cfgpath, sizeof(cfgpath), "%s/miniargv-fuzz-0.cfg", tmpdir);
+  return 0;
+}
+
+//write configuration file loading the value of a variable from a file of n bytes
+static int generate_cfgfile_loaded_value (size_t n)
+{
+  size_t i;
+  FILE* dst;
+  char valuepath[1100];
+  snprintf(valuepath, sizeof(valuepath), "%s/miniargv-fuzz-value.txt", tmpdir);
+  if ((dst = fopen(valuepath, "wb")) == NULL)
+    return -1;
+  for (i = 0; i < n; i++)
+    fputc('a' + random_next(26), dst);
+  fclose(dst);
+  snprintf(cfgpath, sizeof(cfgpath), "%s/miniargv-fuzz.cfg", tmpdir);
+  if ((dst = fopen(cfgpath, "wb")) == NULL)
+    return -1;
+  fprintf(dst, "string @ %s\n", valuepath);
+  fclose(dst);
+  return 0;
+}
+
+static void remove_cfgfile_chain (size_t n)
+{
+  size_t i;
+  char path[1100];
+  for (i = 0; i < n; i++) {
+    snprintf(path, sizeof(path), "%s/miniargv-fuzz-%lu.cfg", tmpdir, (unsigned long)i);
+    remove(path);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//cases
+#define CASE_PROCESS_ARG                1
+#define CASE_PROCESS_ARG_TERMINATOR     2
+#define CASE_PROCESS                    3
+#define CASE_GET_NEXT_ARG_PARAM         4
+#define CASE_GET_NEXT_ARG_PARAM_TERM    5
+#define CASE_PROCESS_ENV                6
+#define CASE_CFGFILE_LINES              7
+#define CASE_CFGFILE_LINE_LENGTH        8
+#define CASE_CFGFILE_INCLUDE_DEPTH      9
+#define CASE_CFGFILE_READ_LENGTH        10
+#define CASE_CFG_LOOKUP_INCLUDE_DEPTH   11
+
+static const struct {
+  const char* name;
+  int id;
+} cases[] = {
+  {"process_arg", CASE_PROCESS_ARG},
+  {"process_arg_terminator", CASE_PROCESS_ARG_TERMINATOR},
+  {"process", CASE_PROCESS},
+  {"get_next_arg_param", CASE_GET_NEXT_ARG_PARAM},
+  {"get_next_arg_param_terminator", CASE_GET_NEXT_ARG_PARAM_TERM},
+  {"process_env", CASE_PROCESS_ENV},
+  {"cfgfile_lines", CASE_CFGFILE_LINES},
+  {"cfgfile_line_length", CASE_CFGFILE_LINE_LENGTH},
+  {"cfgfile_include_depth", CASE_CFGFILE_INCLUDE_DEPTH},
+  {"cfgfile_read_length", CASE_CFGFILE_READ_LENGTH},
+  {"cfg_lookup_include_depth", CASE_CFG_LOOKUP_INCLUDE_DEPTH},
+  {NULL, 0}
+};
+
+//generate input of size n, process it and return the cost (or a negative value on error)
+static double run_case (int id, unsigned long long seed, size_t n)
+{
+  int i;
+  double result;
+  double starttime;
+  random_seed(seed + n);
+  counter = 0;
+  //generate input
+  switch (id) {
+    case CASE_PROCESS_ARG :
+    case CASE_PROCESS :
+    case CASE_GET_NEXT_ARG_PARAM :
+      if (generate_argv(n, 0) != 0)
+        return -1;
+      break;
+    case CASE_PROCESS_ARG_TERMINATOR :
+    case CASE_GET_NEXT_ARG_PARAM_TERM :
+      if (generate_argv(n, 1) != 0)
+        return -1;
+      break;
+    case CASE_PROCESS_ENV :
+      if (generate_env(n) != 0)
+        return -1;
+      break;
+    case CASE_CFGFILE_LINES :
+    case CASE_CFGFILE_LINE_LENGTH :
+      snprintf(cfgpath, sizeof(cfgpath), "%s/miniargv-fuzz.cfg", tmpdir);
+      if (generate_cfgfile(cfgpath, n, id == CASE_CFGFILE_LINE_LENGTH, NULL) != 0)
+        return -1;
+      break;
+    case CASE_CFGFILE_INCLUDE_DEPTH :
+    case CASE_CFG_LOOKUP_INCLUDE_DEPTH :
+      if (generate_cfgfile_chain(n) != 0)
+        return -1;
+      break;
+    case CASE_CFGFILE_READ_LENGTH :
+      if (generate_cfgfile_loaded_value(n) != 0)
+        return -1;
+      break;
+  }
+  //process input
+  starttime = (double)clock() * 1e9 / CLOCKS_PER_SEC;
+  cost_start();
+  switch (id) {
+    case CASE_PROCESS_ARG :
+    case CASE_PROCESS_ARG_TERMINATOR :
+      miniargv_process_arg(args, argdef, cb_bad, NULL);
+      break;
+    case CASE_PROCESS :
+      miniargv_process(args, NULL, argdef, envdef, cb_bad, NULL);
+      break;
+    case CASE_GET_NEXT_ARG_PARAM :
+    case CASE_GET_NEXT_ARG_PARAM_TERM :
+      i = 0;
+      while ((i = miniargv_get_next_arg_param(i, args, argdef, cb_bad)) > 0)
+        counter++;
+      break;
+    case CASE_PROCESS_ENV :
+      miniargv_process_env(args, envdef, NULL);
+      break;
+    case CASE_CFGFILE_LINES :
+    case CASE_CFGFILE_LINE_LENGTH :
+    case CASE_CFGFILE_INCLUDE_DEPTH :
+    case CASE_CFGFILE_READ_LENGTH :
+      miniargv_process_cfgfile(cfgpath, cfgdef, NULL);
+      break;
+    case CASE_CFG_LOOKUP_INCLUDE_DEPTH :
+      //a variable that is not set is looked up in every included file
+      free(miniargv_cfg_lookup(cfgpath, "missing"));
+      break;
+  }
+  result = cost_stop(starttime);
+  //clean up
+  free_input();
+  if (id == CASE_CFGFILE_INCLUDE_DEPTH || id == CASE_CFG_LOOKUP_INCLUDE_DEPTH) {
+    remove_cfgfile_chain(n);
+  } else if (id == CASE_CFGFILE_READ_LENGTH) {
+    remove(cfgpath);
+    snprintf(cfgpath, sizeof(cfgpath), "%s/miniargv-fuzz-value.txt", tmpdir);
+    remove(cfgpath);
+  } else if (id == CASE_CFGFILE_LINES || id == CASE_CFGFILE_LINE_LENGTH) {
+    remove(cfgpath);
+  }
+  return result;
+}
+
+//number of measurements per input size (the lowest cost is used)
+#define REPEAT 3
+
+//run case for increasing input sizes and return the growth exponent of the cost (1 = linear)
+static double run_case_scaled (int id, unsigned long long seed, size_t minsize, size_t maxsize, int verbose)
+{
+  int i;
+  size_t n;
+  double cost;
+  double measured;
+  double firstcost = 0;
+  size_t firstsize = 0;
+  double exponent = 0;
+  for (n = minsize; n <= maxsize; n *= 2) {
+    cost = -1;
+    for (i = 0; i < REPEAT; i++) {
+      if ((measured = run_case(id, seed, n)) < 0)
+        return -1;
+      if (cost < 0 || measured < cost)
+        cost = measured;
+    }
+    if (cost <= 0)
+      cost = 1;
+    if (!firstsize) {
+      firstsize = n;
+      firstcost = cost;
+    } else {
+      exponent = log(cost / firstcost) / log((double)n / firstsize);
+    }
+    if (verbose)
+      printf("  n=%-10lu cost=%-14.0f cost/n=%.1f\n", (unsigned long)n, cost, cost / n);
+  }
+  return exponent;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int main (int argc, char *argv[])
+{
+  FILE* src;
+  char line[256];
+  char casename[64];
+  unsigned long long seed;
+  unsigned long minsize;
+  unsigned long maxsize;
+  double exponent;
+  int i;
+  int showhelp = 0;
+  int verbose = 0;
+  int flagged = 0;
+  const char* corpus = "examples/miniargv-fuzz-complexity.corpus";
+  const char* threshold = "1.3";
+  const char* only = NULL;
+  const char* costunit;
+  const char* p;
+  const miniargv_definition fuzzargdef[] = {
+    {'h', "help", NULL, miniargv_cb_increment_int, &showhelp, "show command line help", NULL},
+    {'v', "verbose", NULL, miniargv_cb_increment_int, &verbose, "show cost for each input size", NULL},
+    {'c', "corpus", "FILE", miniargv_cb_set_const_str, &corpus, "corpus file with cases to run", miniargv_complete_cb_file},
+    {'t', "threshold", "X", miniargv_cb_set_const_str, &threshold, "growth exponent above which a case is reported as super-linear (default: 1.3)", NULL},
+    {0, NULL, "CASE", miniargv_cb_set_const_str, &only, "only run this case", NULL},
+    MINIARGV_DEFINITION_END
+  };
+  if (miniargv_process_arg(argv, fuzzargdef, NULL, NULL) != 0)
+    return 1;
+  if (showhelp) {
+    int prognamelen;
+    const char* progname = miniargv_getprogramname(argv[0], &prognamelen);
+    printf("%.*s v%s\nUsage: %.*s ", prognamelen, progname, miniargv_get_version_string(), prognamelen, progname);
+    miniargv_arg_list(fuzzargdef, 1);
+    printf("\n");
+    miniargv_help(fuzzargdef, NULL, 0, 0);
+    return 0;
+  }
+  //folder for temporary files
+  if ((p = getenv("TMPDIR")) == NULL && (p = getenv("TEMP")) == NULL)
+    p = ".";
+  snprintf(tmpdir, sizeof(tmpdir), "%s", p);
+  //run cases from corpus
+  if ((src = fopen(corpus, "rb")) == NULL) {
+    fprintf(stderr, "Error opening corpus file: %s\n", corpus);
+    return 1;
+  }
+  costunit = cost_init();
+  printf("cost measured as: %s\n", costunit);
+  while (fgets(line, sizeof(line), src)) {
+    if (line[0] == '#' || sscanf(line, "%63s %llu %lu %lu", casename, &seed, &minsize, &maxsize) != 4)
+      continue;
+    if (only && strcmp(only, casename) != 0)
+      continue;
+    for (i = 0; cases[i].name; i++) {
+      if (strcmp(cases[i].name, casename) == 0)
+        break;
+    }
+    if (!cases[i].name || minsize == 0 || maxsize < minsize * 2) {
+      fprintf(stderr, "Invalid case in corpus: %s", line);
+      continue;
+    }
+    if (verbose)
+      printf("%s (seed %llu):\n", casename, seed);
+    if ((exponent = run_case_scaled(cases[i].id, seed, minsize, maxsize, verbose)) < 0) {
+      fprintf(stderr, "Error running case: %s\n", casename);
+      flagged++;
+      continue;
+    }
+    if (exponent > atof(threshold)) {
+      printf("%-32s seed %-6llu n=%lu..%lu  growth exponent %.2f  SUPER-LINEAR\n", casename, seed, minsize, maxsize, exponent);
+      flagged++;
+    } else {
+      printf("%-32s seed %-6llu n=%lu..%lu  growth exponent %.2f  ok\n", casename, seed, minsize, maxsize, exponent);
+    }
+  }
+  fclose(src);
+  return (flagged ? 2 : 0);
+}
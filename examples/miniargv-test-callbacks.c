@@ -0,0 +1,849 @@
+/**
+ * @file miniargv-test-callbacks.c
+ * @brief miniargv callback function test
+ * @author Brecht Sanders
+ *
+ * This program checks the behavior of the predefined callback functions and of the features that change when callback functions are called.
+ * It returns 0 if all checks pass, otherwise the failed checks are reported.
+ */
+
+#include <miniargv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+static int failures = 0;
+
+#define CHECK(condition) if (!(condition)) { fprintf(stderr, "%s:%i: check failed: %s\n", __FILE__, __LINE__, #condition); failures++; }
+
+//run a function in a number of threads at the same time (the first thread can run a different function) and wait for all of them to finish
+#define MAX_THREADS 8
+
+typedef void (*thread_fn)(void* data);
+
+struct thread_struct {
+  thread_fn fn;
+  void* data;
+#ifdef _WIN32
+  HANDLE handle;
+#else
+  pthread_t handle;
+#endif
+};
+
+#ifdef _WIN32
+static DWORD WINAPI thread_start (LPVOID data)
+{
+  ((struct thread_struct*)data)->fn(((struct thread_struct*)data)->data);
+  return 0;
+}
+#else
+static void* thread_start (void* data)
+{
+  ((struct thread_struct*)data)->fn(((struct thread_struct*)data)->data);
+  return NULL;
+}
+#endif
+
+static void run_threads (int count, thread_fn firstfn, thread_fn fn, void* data)
+{
+  int i;
+  struct thread_struct threads[MAX_THREADS];
+  for (i = 0; i < count && i < MAX_THREADS; i++) {
+    threads[i].fn = (i == 0 && firstfn ? firstfn : fn);
+    threads[i].data = data;
+#ifdef _WIN32
+    threads[i].handle = CreateThread(NULL, 0, thread_start, &threads[i], 0, NULL);
+#else
+    pthread_create(&threads[i].handle, NULL, thread_start, &threads[i]);
+#endif
+  }
+  while (i-- > 0) {
+#ifdef _WIN32
+    WaitForSingleObject(threads[i].handle, INFINITE);
+    CloseHandle(threads[i].handle);
+#else
+    pthread_join(threads[i].handle, NULL);
+#endif
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//lazily evaluated values
+
+static int lazy_calls = 0;
+
+static int count_set_int (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  lazy_calls++;
+  return miniargv_cb_set_int(argdef, value, callbackdata);
+}
+
+static int count_default_int (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  lazy_calls++;
+  *(int*)argdef->userdata = 42;
+  return 0;
+}
+
+static int lazy_number = 0;
+static miniargv_lazy lazy = MINIARGV_LAZY(count_set_int, &lazy_number, count_default_int);
+
+static const miniargv_definition lazydef[] = {
+  {'n', "number", "N", miniargv_cb_lazy, &lazy, "number", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static void lazy_get_thread (void* data)
+{
+  int i;
+  for (i = 0; i < 1000; i++)
+    miniargv_lazy_get((miniargv_lazy*)data);
+}
+
+static void lazy_set_thread (void* data)
+{
+  int i;
+  char value[16];
+  for (i = 1; i <= 1000; i++) {
+    sprintf(value, "%i", i);
+    miniargv_cb_lazy(&lazydef[0], value, NULL);
+  }
+}
+
+static void test_lazy ()
+{
+  char* argv_value[] = {"test", "--number=7", NULL};
+  char* argv_none[] = {"test", NULL};
+  //the default is only evaluated when read, and only once
+  lazy_calls = 0;
+  CHECK(miniargv_process_arg(argv_none, lazydef, NULL, NULL) == 0);
+  CHECK(lazy_calls == 0);
+  CHECK(miniargv_lazy_get(&lazy) == 0);
+  CHECK(lazy_number == 42);
+  CHECK(miniargv_lazy_get(&lazy) == 0);
+  CHECK(lazy_calls == 1);
+  miniargv_cleanup(lazydef);
+  //a given value is only evaluated when read
+  lazy_calls = 0;
+  CHECK(miniargv_process_arg(argv_value, lazydef, NULL, NULL) == 0);
+  CHECK(lazy_calls == 0);
+  CHECK(miniargv_lazy_get(&lazy) == 0);
+  CHECK(lazy_number == 7);
+  CHECK(lazy_calls == 1);
+  //a value given after it was read is evaluated right away
+  CHECK(miniargv_cb_lazy(&lazydef[0], "8", NULL) == 0);
+  CHECK(lazy_number == 8);
+  CHECK(lazy_calls == 2);
+  miniargv_cleanup(lazydef);
+  //only one of the threads reading the value at the same time evaluates it
+  lazy_calls = 0;
+  CHECK(miniargv_process_arg(argv_value, lazydef, NULL, NULL) == 0);
+  run_threads(MAX_THREADS, NULL, lazy_get_thread, &lazy);
+  CHECK(lazy_calls == 1);
+  CHECK(lazy_number == 7);
+  miniargv_cleanup(lazydef);
+  //setting the value while other threads read it is safe and the last value wins
+  CHECK(miniargv_process_arg(argv_value, lazydef, NULL, NULL) == 0);
+  run_threads(4, lazy_set_thread, lazy_get_thread, &lazy);
+  CHECK(miniargv_lazy_get(&lazy) == 0);
+  CHECK(lazy_number == 1000);
+  miniargv_cleanup(lazydef);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//callbacks running in parallel
+
+static volatile int parallel_calls = 0;
+static int parallel_calls_seen = -1;
+static int parallel_bad_count = 0;
+static const char* parallel_bad_value = NULL;
+
+//callback that fails for values starting with "fail" (the higher the number after it, the sooner it fails)
+static int parallel_callback (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  volatile unsigned long i;
+  if (strncmp(value, "fail", 4) == 0) {
+    for (i = 0; i < 2000000UL / (unsigned long)atoi(value + 4); i++)
+      ;
+    return 5;
+  }
+#ifdef _WIN32
+  InterlockedIncrement((volatile LONG*)&parallel_calls);
+#else
+  __sync_fetch_and_add(&parallel_calls, 1);
+#endif
+  return 0;
+}
+
+//callback that is not run in parallel, so it is called before any of the parallel ones
+static int sequential_callback (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  parallel_calls_seen = parallel_calls;
+  return 0;
+}
+
+static int parallel_bad_arg (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  parallel_bad_count++;
+  parallel_bad_value = value;
+  return 1;
+}
+
+static const miniargv_definition paralleldef[] = {
+  {'p', "parallel", "VALUE", parallel_callback, NULL, "value checked in parallel", NULL, NULL, MINIARGV_FLAG_PARALLEL},
+  {'s', "sequential", NULL, sequential_callback, NULL, "flag processed in order", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static void test_parallel ()
+{
+  int i;
+  FILE* f;
+  char* argv_ok[] = {"test", "-p", "a", "--parallel=b", "-s", "-pc", "--parallel", "d", NULL};
+  char* argv_bad[] = {"test", "-p", "a", "--parallel=fail1", "-s", "--parallel=fail9", "-pfail2", NULL};
+  //all deferred callbacks run after processing
+  parallel_calls = 0;
+  CHECK(miniargv_process_arg(argv_ok, paralleldef, NULL, NULL) == 0);
+  CHECK(parallel_calls == 4);
+  CHECK(parallel_calls_seen == 0);
+  //the first failed argument in the order given is reported, even if a later one failed first
+  for (i = 0; i < 10; i++) {
+    parallel_bad_count = 0;
+    parallel_bad_value = NULL;
+    CHECK(miniargv_process_arg(argv_bad, paralleldef, parallel_bad_arg, NULL) == 3);
+    CHECK(parallel_bad_count == 1);
+    CHECK(parallel_bad_value && strcmp(parallel_bad_value, "--parallel=fail1") == 0);
+  }
+  //configuration files return the result of the first failed callback
+  if ((f = fopen("miniargv-test-callbacks.cfg", "wb")) != NULL) {
+    fprintf(f, "parallel=a\nparallel=fail1\nparallel=fail9\n");
+    fclose(f);
+    parallel_calls = 0;
+    CHECK(miniargv_process_cfgfile("miniargv-test-callbacks.cfg", paralleldef, NULL) == 5);
+    CHECK(parallel_calls == 1);
+    remove("miniargv-test-callbacks.cfg");
+  } else {
+    CHECK(!"temporary configuration file could not be created");
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//precomputed default values
+
+struct defaults_store_struct {
+  int number;
+  char* name;
+  miniargv_lazy lazy;
+  int count;
+  char* path;
+};
+
+static int defaults_lazy_value = 0;
+
+static struct defaults_store_struct defaults_store = {
+  0,
+  NULL,
+  MINIARGV_LAZY(miniargv_cb_set_int, &defaults_lazy_value, NULL),
+  0,
+  NULL
+};
+
+static const miniargv_definition defaultsdef[] = {
+  {'n', "number", "N", miniargv_cb_set_int, &defaults_store.number, "number", NULL, NULL, 0, "10"},
+  {'s', "name", "NAME", miniargv_cb_strdup, &defaults_store.name, "name without default", NULL},
+  {'l', "lazy", "N", miniargv_cb_lazy, &defaults_store.lazy, "lazy value without default", NULL},
+  {'c', "count", "N", miniargv_cb_set_int, &defaults_store.count, "count without default", NULL},
+  {'p', "path", "PATH", miniargv_cb_strdup, &defaults_store.path, "path", NULL, NULL, 0, "/tmp"},
+  MINIARGV_DEFINITION_END
+};
+
+static void test_defaults ()
+{
+  miniargv_defaults* defaults;
+  char* argv[] = {"test", "-n5", "--name=test", "--lazy=3", "-c", "7", "--path=/var", NULL};
+  CHECK((defaults = miniargv_defaults_create(defaultsdef, &defaults_store, sizeof(defaults_store))) != NULL);
+  if (!defaults)
+    return;
+  CHECK(miniargv_defaults_apply(defaults, NULL) == 0);
+  CHECK(defaults_store.number == 10);
+  CHECK(defaults_store.path && strcmp(defaults_store.path, "/tmp") == 0);
+  CHECK(miniargv_process_arg(argv, defaultsdef, NULL, NULL) == 0);
+  CHECK(defaults_store.number == 5 && defaults_store.count == 7);
+  //plain variables are reset, the ones with a default value set by a callback function get it again, the others are left alone
+  CHECK(miniargv_defaults_apply(defaults, NULL) == 0);
+  CHECK(defaults_store.number == 10);
+  CHECK(defaults_store.count == 0);
+  CHECK(defaults_store.path && strcmp(defaults_store.path, "/tmp") == 0);
+  CHECK(defaults_store.name && strcmp(defaults_store.name, "test") == 0);
+  CHECK(miniargv_lazy_get(&defaults_store.lazy) == 0);
+  CHECK(defaults_lazy_value == 3);
+  miniargv_defaults_free(defaults);
+  miniargv_cleanup(defaultsdef);
+  CHECK(defaults_store.name == NULL && defaults_store.path == NULL);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//standalone value arguments returned one by one
+
+static int terminator_flag = 0;
+
+static const miniargv_definition terminatordef[] = {
+  {'f', "flag", NULL, miniargv_cb_increment_int, &terminator_flag, "flag", NULL},
+  {0, NULL, "VALUE", miniargv_cb_noop, NULL, "value", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static void test_terminator ()
+{
+  int i;
+  int count;
+  char* argv[6];
+  //all arguments after "--" are values
+  argv[0] = "test"; argv[1] = "a"; argv[2] = "--"; argv[3] = "-f"; argv[4] = "b"; argv[5] = NULL;
+  for (i = 0, count = 0; (i = miniargv_get_next_arg_param(i, argv, terminatordef, NULL)) > 0; count++)
+    ;
+  CHECK(count == 3);
+  //the same list reused without "--" (e.g. on the stack in a later call) only has the values
+  argv[0] = "test"; argv[1] = "a"; argv[2] = "b"; argv[3] = "-f"; argv[4] = "c"; argv[5] = NULL;
+  for (i = 0, count = 0; (i = miniargv_get_next_arg_param(i, argv, terminatordef, NULL)) > 0; count++)
+    CHECK(strcmp(argv[i], "-f") != 0);
+  CHECK(count == 3);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//lookup indexes cached for definition tables
+
+static int cache_reject (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  return 1;
+}
+
+//process arguments with a table on the stack, which is at the same address on every call (so its index is discarded before returning)
+static int cache_process_local (char shortarg, char* argv[])
+{
+  int count = 0;
+  int result;
+  miniargv_definition argdef[] = {
+    {'x', NULL, NULL, miniargv_cb_noop, NULL, "same in every call", NULL},
+    {shortarg, NULL, NULL, miniargv_cb_increment_int, &count, "flag", NULL},
+    MINIARGV_DEFINITION_END
+  };
+  result = (miniargv_process_arg(argv, argdef, cache_reject, NULL) != 0 ? -1 : count);
+  miniargv_index_invalidate(argdef);
+  return result;
+}
+
+static int cache_count = 0;
+
+static miniargv_definition cachedef[] = {
+  {'v', "verbose", NULL, miniargv_cb_noop, NULL, "verbose", NULL},
+  {'c', "count", NULL, miniargv_cb_increment_int, &cache_count, "count", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static void cache_process_thread (void* data)
+{
+  int i;
+  char* argv[] = {"test", "--verbose", "-v", NULL};
+  for (i = 0; i < 2000; i++) {
+    if (miniargv_process_arg(argv, cachedef, cache_reject, NULL) != 0)
+      (*(volatile int*)data)++;
+  }
+}
+
+static void cache_invalidate_thread (void* data)
+{
+  int i;
+  for (i = 0; i < 2000; i++)
+    miniargv_index_invalidate(cachedef);
+}
+
+static void test_cache ()
+{
+  volatile int errors = 0;
+  char* argv1[] = {"test", "-a", "-a", NULL};
+  char* argv2[] = {"test", "-b", NULL};
+  char* argv3[] = {"test", "--total", NULL};
+  //a different table at the same address must not use the index of the previous one
+  CHECK(cache_process_local('a', argv1) == 2);
+  CHECK(cache_process_local('b', argv2) == 1);
+  CHECK(cache_process_local('a', argv2) == -1);
+  //a table changed in place uses a new index once the old one is discarded
+  cache_count = 0;
+  CHECK(miniargv_process_arg(argv3, cachedef, cache_reject, NULL) != 0);
+  CHECK(miniargv_find_arg("--count", cachedef) == &cachedef[1]);
+  cachedef[1].longarg = "total";
+  miniargv_index_invalidate(cachedef);
+  CHECK(miniargv_find_arg("--count", cachedef) == NULL);
+  CHECK(miniargv_find_arg("--total", cachedef) == &cachedef[1]);
+  CHECK(miniargv_process_arg(argv3, cachedef, cache_reject, NULL) == 0);
+  CHECK(cache_count == 1);
+  cachedef[1].longarg = "count";
+  miniargv_index_invalidate(cachedef);
+  //the find functions use the index too
+  CHECK(miniargv_find_shortarg('c', cachedef) == &cachedef[1]);
+  CHECK(miniargv_find_shortarg('z', cachedef) == NULL);
+  CHECK(miniargv_find_longarg("cou", 0, cachedef) == &cachedef[1]);
+  CHECK(miniargv_find_standalonearg(cachedef) == NULL);
+  //indexes discarded while other threads are using them are only freed when they are done
+  run_threads(4, cache_invalidate_thread, cache_process_thread, (void*)&errors);
+  CHECK(errors == 0);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//long argument names
+
+static int longarg_level = 0;
+static int longarg_verbose = 0;
+
+static const miniargv_definition longargdef[] = {
+  {0, "verbose-level", "N", miniargv_cb_set_int, &longarg_level, "verbosity level", NULL},
+  {0, "verbose", NULL, miniargv_cb_increment_int, &longarg_verbose, "more output", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static void test_longarg ()
+{
+  char* argv[] = {"test", "--verbose", "--verbose-l=3", NULL};
+  //an exact match is preferred over an earlier definition starting with the same text
+  CHECK(miniargv_find_longarg("verbose", 0, longargdef) == &longargdef[1]);
+  CHECK(miniargv_find_longarg("verbose=x", 7, longargdef) == &longargdef[1]);
+  CHECK(miniargv_find_longarg("verb", 0, longargdef) == &longargdef[0]);
+  CHECK(miniargv_find_longarg("", 0, longargdef) == NULL);
+  CHECK(miniargv_find_longarg("quiet", 0, longargdef) == NULL);
+  //processing matches the same way
+  CHECK(miniargv_process_arg(argv, longargdef, NULL, NULL) == 0);
+  CHECK(longarg_verbose == 1 && longarg_level == 3);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//arguments that were not found
+
+static int suggest_verbose = 0;
+
+static const miniargv_definition suggestdef[] = {
+  {'v', "verbose", NULL, miniargv_cb_increment_int, &suggest_verbose, "verbose", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static const miniargv_definition* suggest_bad_argdef = suggestdef;
+
+static int suggest_bad_arg (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  suggest_bad_argdef = argdef;
+  return 1;
+}
+
+static void test_suggest ()
+{
+  const miniargv_definition* suggestion = NULL;
+  char* argv[] = {"test", "--verbse", NULL};
+  //badfn gets NULL as definition, the closest one can be looked up with miniargv_suggest()
+  CHECK(miniargv_process_arg(argv, suggestdef, suggest_bad_arg, NULL) == 1);
+  CHECK(suggest_bad_argdef == NULL);
+  CHECK(miniargv_suggest(argv[1], suggestdef, &suggestion, 1) == 1);
+  CHECK(suggestion == &suggestdef[0]);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//overlays
+
+static int overlay_verbosity = 1;
+static long overlay_level = 10;
+
+static const miniargv_definition overlaydef[] = {
+  {'v', "verbose", NULL, miniargv_cb_increment_int, &overlay_verbosity, "more output", NULL},
+  {'q', "quiet", NULL, miniargv_cb_decrement_int, &overlay_verbosity, "less output", NULL},
+  {'u', "up", NULL, miniargv_cb_increment_long, &overlay_level, "raise level", NULL},
+  {'d', "down", NULL, miniargv_cb_decrement_long, &overlay_level, "lower level", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static void test_overlay ()
+{
+  miniargv_overlay overlay = MINIARGV_OVERLAY(overlaydef);
+  //definitions setting the same variable share the overridden value
+  CHECK(miniargv_overlay_set(&overlay, &overlaydef[0], NULL) == 0);
+  CHECK(miniargv_overlay_set(&overlay, &overlaydef[0], NULL) == 0);
+  CHECK(miniargv_overlay_set(&overlay, &overlaydef[1], NULL) == 0);
+  CHECK(MINIARGV_OVERLAY_INT(&overlay, &overlaydef[0]) == 2);
+  CHECK(MINIARGV_OVERLAY_INT(&overlay, &overlaydef[1]) == 2);
+  CHECK(overlay.count == 1);
+  CHECK(overlay_verbosity == 1);
+  //long variables are changed in the same direction as when processing
+  CHECK(miniargv_overlay_set(&overlay, &overlaydef[2], NULL) == 0);
+  CHECK(miniargv_overlay_set(&overlay, &overlaydef[2], NULL) == 0);
+  CHECK(MINIARGV_OVERLAY_LONG(&overlay, &overlaydef[2]) == 12);
+  CHECK(miniargv_overlay_set(&overlay, &overlaydef[3], NULL) == 0);
+  CHECK(MINIARGV_OVERLAY_LONG(&overlay, &overlaydef[3]) == 11);
+  CHECK(overlay_level == 10);
+  miniargv_cb_increment_long(&overlaydef[2], NULL, NULL);
+  CHECK(overlay_level == 11);
+  miniargv_cb_decrement_long(&overlaydef[3], NULL, NULL);
+  miniargv_cb_decrement_long(&overlaydef[3], NULL, NULL);
+  CHECK(overlay_level == 9);
+  overlay_level = 10;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//rendering values back into command line arguments
+
+static long emit_level = 0;
+
+static const miniargv_definition emitdef[] = {
+  {'u', "up", NULL, miniargv_cb_increment_long, &emit_level, "raise level", NULL},
+  {'d', "down", NULL, miniargv_cb_decrement_long, &emit_level, "lower level", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static void test_emit ()
+{
+  char** args;
+  char* argv1[] = {"test", "-u", "-u", "-d", "-u", NULL};
+  char* argv2[] = {"test", "-d", "-d", NULL};
+  //long counters are emitted as the flag that changes them in the same direction, and processing the result gives the same value
+  CHECK(miniargv_process_arg(argv1, emitdef, NULL, NULL) == 0);
+  CHECK(emit_level == 2);
+  CHECK((args = miniargv_emit("test", emitdef, NULL, NULL, NULL, NULL)) != NULL);
+  CHECK(args && args[1] && strcmp(args[1], "--up") == 0 && args[2] && strcmp(args[2], "--up") == 0 && !args[3]);
+  emit_level = 0;
+  CHECK(args && miniargv_process_arg(args, emitdef, NULL, NULL) == 0);
+  CHECK(emit_level == 2);
+  free(args);
+  emit_level = 0;
+  CHECK(miniargv_process_arg(argv2, emitdef, NULL, NULL) == 0);
+  CHECK(emit_level == -2);
+  CHECK((args = miniargv_emit("test", emitdef, NULL, NULL, NULL, NULL)) != NULL);
+  CHECK(args && args[1] && strcmp(args[1], "--down") == 0 && args[2] && strcmp(args[2], "--down") == 0 && !args[3]);
+  free(args);
+  emit_level = 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//command line arguments from an environment variable
+
+static const char* options_name = NULL;
+
+static const miniargv_definition optionsdef[] = {
+  {'n', "name", "NAME", miniargv_cb_set_const_str, &options_name, "name", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static int options_bulk_calls = 0;
+static int options_bulk_count = 0;
+
+static int options_bulk (const miniargv_definition* argdef, int argc, char* argv[], void* callbackdata)
+{
+  options_bulk_calls++;
+  options_bulk_count += argc;
+  return 0;
+}
+
+static const miniargv_definition optionsbulkdef[] = {
+  {'n', "name", "NAME", miniargv_cb_set_const_str, &options_name, "name", NULL},
+  {0, NULL, "FILE", miniargv_cb_noop, NULL, "file", NULL, options_bulk},
+  MINIARGV_DEFINITION_END
+};
+
+static void test_options ()
+{
+  int i;
+  char* argv[] = {"test", NULL};
+  char* env[] = {"TEST_OPTIONS=--name=\"first value\"", NULL};
+  char* badenv[] = {"TEST_OPTIONS=--name=x --bad", NULL};
+  char* argv_operands[] = {"test", "--name=c", "d", NULL};
+  char* termenv[] = {"TEST_OPTIONS=--name=x -- a b", NULL};
+  //the words of a previous call for the same definitions are replaced instead of kept until miniargv_cleanup()
+  for (i = 0; i < 100; i++)
+    CHECK(miniargv_process_arg_env_options(argv, env, "TEST_OPTIONS", optionsdef, NULL, NULL) == 0);
+  CHECK(options_name && strcmp(options_name, "first value") == 0);
+  //a bad word is reported as minus its position
+  CHECK(miniargv_process_arg_env_options(argv, badenv, "TEST_OPTIONS", optionsdef, cache_reject, NULL) == -2);
+  miniargv_cleanup(optionsdef);
+  //operands following "--" in the environment variable and on the command line are passed to bulkfn in separate calls
+  CHECK(miniargv_process_arg_env_options(argv_operands, termenv, "TEST_OPTIONS", optionsbulkdef, NULL, NULL) == 0);
+  CHECK(options_bulk_calls == 2);
+  CHECK(options_bulk_count == 4);
+  miniargv_cleanup(optionsbulkdef);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//multi-call binaries
+
+static int applet_fail_main (int argc, char* argv[], char* env[])
+{
+  return -1;
+}
+
+static const miniargv_applet applets[] = {
+  {"fail", applet_fail_main, NULL, NULL, "applet returning -1"},
+  MINIARGV_APPLET_END
+};
+
+static void test_applet ()
+{
+  char* argv[] = {"test", "fail", NULL};
+  char* unknownargv[] = {"test", "unknown", NULL};
+  //any exit code of an applet can be told apart from no applet found
+  CHECK(miniargv_applet_main(2, argv, NULL, applets) == -1);
+  CHECK(miniargv_applet_main(2, unknownargv, NULL, applets) == MINIARGV_APPLET_NOT_FOUND);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//binary data
+
+static miniargv_blob blob_hex = MINIARGV_BLOB(MINIARGV_BLOB_HEX, NULL);
+static miniargv_blob blob_base64 = MINIARGV_BLOB(MINIARGV_BLOB_BASE64, NULL);
+
+static const miniargv_definition blobdef[] = {
+  {'x', "hex", "HEX", miniargv_cb_set_blob, &blob_hex, "hexadecimal data", NULL},
+  {'b', "base64", "BASE64", miniargv_cb_set_blob, &blob_base64, "base64 data", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+static void test_blob ()
+{
+  int i;
+  char hex[2 * 256 + 1];
+  //hexadecimal with prefix and spaces, long enough to be decoded 16 bytes at a time with SSE2
+  CHECK(miniargv_cb_set_blob(&blobdef[0], " 0xDeadBEEF00ff\t", NULL) == 0);
+  CHECK(blob_hex.length == 6 && memcmp(blob_hex.data, "\xDE\xAD\xBE\xEF\x00\xFF", 6) == 0);
+  for (i = 0; i < 256; i++)
+    sprintf(hex + 2 * i, "%02x", 255 - i);
+  CHECK(miniargv_cb_set_blob(&blobdef[0], hex, NULL) == 0);
+  CHECK(blob_hex.length == 256 && blob_hex.data[0] == 255 && blob_hex.data[15] == 240 && blob_hex.data[16] == 239 && blob_hex.data[255] == 0 && blob_hex.data[256] == 0);
+  hex[2 * 200 + 1] = 'g';
+  CHECK(miniargv_cb_set_blob(&blobdef[0], hex, NULL) != 0 && blob_hex.length == 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[0], "abc", NULL) != 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[0], "\xA0" "00", NULL) != 0);
+  //base64 with and without padding, standard and URL-safe alphabet
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "TWFu", NULL) == 0 && blob_base64.length == 3 && memcmp(blob_base64.data, "Man", 3) == 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "TWE=", NULL) == 0 && blob_base64.length == 2 && memcmp(blob_base64.data, "Ma", 2) == 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "TQ==", NULL) == 0 && blob_base64.length == 1 && memcmp(blob_base64.data, "M", 1) == 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "TWE", NULL) == 0 && blob_base64.length == 2 && memcmp(blob_base64.data, "Ma", 2) == 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "++//--__++//--__+/-_", NULL) == 0 && blob_base64.length == 15 && blob_base64.data[0] == 0xFB && blob_base64.data[2] == 0xFF && blob_base64.data[14] == 0xBF);
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "", NULL) == 0 && blob_base64.length == 0);
+  //padding must complete the last group of 4 digits
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "abcd=", NULL) != 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "abc==", NULL) != 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "ab=", NULL) != 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "a===", NULL) != 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "abcde", NULL) != 0);
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "ab*d", NULL) != 0);
+  //non-ASCII characters are not mistaken for spaces
+  CHECK(miniargv_cb_set_blob(&blobdef[1], "\xA0TWFu", NULL) != 0);
+  miniargv_cleanup(blobdef);
+  CHECK(blob_hex.data == NULL && blob_base64.data == NULL);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//arrays of numbers
+
+static miniargv_array array_i32 = MINIARGV_ARRAY(MINIARGV_ARRAY_I32);
+static miniargv_array array_i64 = MINIARGV_ARRAY(MINIARGV_ARRAY_I64);
+static miniargv_array array_u64 = MINIARGV_ARRAY(MINIARGV_ARRAY_U64);
+static miniargv_array array_double = MINIARGV_ARRAY(MINIARGV_ARRAY_DOUBLE);
+
+static const miniargv_definition arraydef[] = {
+  {0, "i32", "LIST", miniargv_cb_set_array, &array_i32, "32-bit integers", NULL},
+  {0, "i64", "LIST", miniargv_cb_set_array, &array_i64, "64-bit integers", NULL},
+  {0, "u64", "LIST", miniargv_cb_set_array, &array_u64, "64-bit unsigned integers", NULL},
+  {0, "double", "LIST", miniargv_cb_set_array, &array_double, "floating point numbers", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+#define ARRAY_BENCHMARK_COUNT 1000000
+
+//measure how fast a long list of 10 digit numbers is parsed, compared to a strtoull() loop
+static void benchmark_array ()
+{
+  int i;
+  int pass;
+  char* list;
+  char* p;
+  size_t len;
+  clock_t start;
+  double seconds;
+  double strtoullseconds;
+  unsigned long long sum = 0;
+  unsigned long long arraysum = 0;
+  if ((list = (char*)malloc(ARRAY_BENCHMARK_COUNT * 11 + 1)) == NULL)
+    return;
+  for (i = 0; i < ARRAY_BENCHMARK_COUNT; i++)
+    sprintf(list + i * 11, "%010u,", (unsigned int)i * 2654435761u);
+  len = ARRAY_BENCHMARK_COUNT * 11 - 1;
+  list[len] = 0;
+  start = clock();
+  for (pass = 0; pass < 5; pass++)
+    CHECK(miniargv_cb_set_array(&arraydef[2], list, NULL) == 0 && array_u64.count == ARRAY_BENCHMARK_COUNT);
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  for (pass = 0; pass < 5; pass++) {
+    for (p = list; *p; p += (*p == ',' ? 1 : 0))
+      sum += strtoull(p, &p, 10);
+  }
+  strtoullseconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  //both loops found the same numbers
+  for (i = 0; i < ARRAY_BENCHMARK_COUNT; i++)
+    arraysum += ((uint64_t*)array_u64.data)[i];
+  CHECK(sum == 5 * arraysum);
+  if (seconds > 0 && strtoullseconds > 0)
+    printf("array parsing: %.2f GB/s (strtoull() loop: %.2f GB/s)\n", 5 * len / seconds / 1e9, 5 * len / strtoullseconds / 1e9);
+  free(list);
+}
+
+static void test_array ()
+{
+  char list[64];
+  //separators, signs and limits of each type
+  CHECK(miniargv_cb_set_array(&arraydef[0], " 1,-2 , +3  4,2147483647,-2147483648 ", NULL) == 0);
+  CHECK(array_i32.count == 6 && ((int32_t*)array_i32.data)[1] == -2 && ((int32_t*)array_i32.data)[3] == 4 && ((int32_t*)array_i32.data)[4] == INT32_MAX && ((int32_t*)array_i32.data)[5] == INT32_MIN);
+  CHECK(miniargv_cb_set_array(&arraydef[0], "2147483648", NULL) != 0 && array_i32.count == 0);
+  CHECK(miniargv_cb_set_array(&arraydef[0], "-2147483649", NULL) != 0);
+  CHECK(miniargv_cb_set_array(&arraydef[1], "9223372036854775807,-9223372036854775808", NULL) == 0);
+  CHECK(array_i64.count == 2 && ((int64_t*)array_i64.data)[0] == INT64_MAX && ((int64_t*)array_i64.data)[1] == INT64_MIN);
+  CHECK(miniargv_cb_set_array(&arraydef[1], "9223372036854775808", NULL) != 0);
+  //numbers longer than 8 digits are converted in several steps, overflow is detected beyond 19 digits
+  CHECK(miniargv_cb_set_array(&arraydef[2], "18446744073709551615,0000000000000000000000012,123456789", NULL) == 0);
+  CHECK(array_u64.count == 3 && ((uint64_t*)array_u64.data)[0] == UINT64_MAX && ((uint64_t*)array_u64.data)[1] == 12 && ((uint64_t*)array_u64.data)[2] == 123456789);
+  CHECK(miniargv_cb_set_array(&arraydef[2], "18446744073709551616", NULL) != 0);
+  CHECK(miniargv_cb_set_array(&arraydef[2], "99999999999999999999", NULL) != 0);
+  CHECK(miniargv_cb_set_array(&arraydef[2], "-1", NULL) != 0);
+  //floating point numbers
+  CHECK(miniargv_cb_set_array(&arraydef[3], "1.5,-2,1e3,12345678901234567890", NULL) == 0);
+  CHECK(array_double.count == 4 && ((double*)array_double.data)[0] == 1.5 && ((double*)array_double.data)[1] == -2 && ((double*)array_double.data)[2] == 1000 && ((double*)array_double.data)[3] == 12345678901234567890.0);
+  //malformed lists
+  CHECK(miniargv_cb_set_array(&arraydef[0], "1,,2", NULL) != 0);
+  CHECK(miniargv_cb_set_array(&arraydef[0], ",1", NULL) != 0);
+  CHECK(miniargv_cb_set_array(&arraydef[0], "1,", NULL) != 0);
+  CHECK(miniargv_cb_set_array(&arraydef[0], "1x", NULL) != 0);
+  CHECK(miniargv_cb_set_array(&arraydef[0], "-", NULL) != 0);
+  CHECK(miniargv_cb_set_array(&arraydef[0], "", NULL) == 0 && array_i32.count == 0);
+  //non-ASCII characters are not mistaken for spaces
+  snprintf(list, sizeof(list), "1%c2", 0xA0);
+  CHECK(miniargv_cb_set_array(&arraydef[0], list, NULL) != 0);
+  benchmark_array();
+  miniargv_cleanup(arraydef);
+  CHECK(array_u64.data == NULL && array_u64.count == 0);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//sets of CPUs
+
+static miniargv_cpuset cpuset = MINIARGV_CPUSET;
+
+static const miniargv_definition cpusetdef[] = {
+  {0, "cpus", "LIST", miniargv_cb_set_cpuset, &cpuset, "CPUs to use", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+//check if the set contains exactly the specified CPUs
+static int cpuset_is (int count, const int cpus[])
+{
+  return (cpuset.count == count && (count == 0 || memcmp(cpuset.cpus, cpus, count * sizeof(int)) == 0));
+}
+
+static void test_cpuset ()
+{
+  int i;
+  char* mask;
+  unsigned long smallmask[1];
+  static const int ranges[] = {0, 1, 2, 3, 8, 9, 10, 11};
+  static const int stride[] = {0, 2, 4, 6, 8, 10, 12, 14};
+  static const int groups[] = {0, 1, 4, 5, 8, 9, 12, 13};
+  static const int excluded[] = {0, 1, 2, 3, 4, 5, 6, 7, 11, 12, 13, 14, 15};
+  static const int groupmask[] = {32, 33, 34, 35, 36, 37, 38, 39};
+  static const int highmask[] = {0, 64};
+  //lists with ranges, strides, groups and exclusions
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], " 0-3, 8-11 ", NULL) == 0 && cpuset_is(8, ranges));
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0-15:2", NULL) == 0 && cpuset_is(8, stride));
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0-15:2/4", NULL) == 0 && cpuset_is(8, groups));
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "^8,0-15,!9-10", NULL) == 0 && cpuset_is(13, excluded));
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "^3", NULL) == 0 && cpuset.count == 0);
+  //hexadecimal masks (commas between groups of digits are ignored)
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0xff,00000000", NULL) == 0 && cpuset_is(8, groupmask));
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0X10000000000000001", NULL) == 0 && cpuset_is(2, highmask));
+  CHECK(cpuset.masksize >= 2 * sizeof(unsigned long) && (cpuset.mask[64 / (8 * sizeof(unsigned long))] & (1UL << (64 % (8 * sizeof(unsigned long))))) != 0);
+  CHECK(miniargv_cpuset_get_mask(&cpuset, smallmask, sizeof(smallmask)) != 0);
+  //highest CPU number
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0-65535", NULL) == 0 && cpuset.count == MINIARGV_CPUSET_MAX_CPU + 1 && cpuset.cpus[cpuset.count - 1] == MINIARGV_CPUSET_MAX_CPU);
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "65536", NULL) != 0 && cpuset.count == 0 && cpuset.mask == NULL);
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0-99999999999", NULL) != 0);
+  if ((mask = (char*)malloc(2 + 16 + (MINIARGV_CPUSET_MAX_CPU + 1) / 4 + 1)) != NULL) {
+    //leading zeros beyond the highest CPU are allowed, bits aren't
+    i = 2 + 16 + (MINIARGV_CPUSET_MAX_CPU + 1) / 4;
+    memset(mask, '0', i);
+    mask[1] = 'x';
+    mask[2 + 16] = '8';
+    mask[i] = 0;
+    CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], mask, NULL) == 0 && cpuset.count == 1 && cpuset.cpus[0] == MINIARGV_CPUSET_MAX_CPU);
+    mask[2] = '1';
+    CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], mask, NULL) != 0);
+    free(mask);
+  }
+  //malformed values
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "3-1", NULL) != 0);
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0-7:0", NULL) != 0);
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0-7:4/2", NULL) != 0);
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "1,", NULL) != 0);
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "1 2", NULL) != 0);
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "-1", NULL) != 0);
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0x", NULL) != 0);
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0x1g", NULL) != 0);
+  //threads spread across the set
+  CHECK(miniargv_cb_set_cpuset(&cpusetdef[0], "0-15", NULL) == 0);
+  CHECK(miniargv_cpuset_spread(&cpuset, 0, 4) == 0 && miniargv_cpuset_spread(&cpuset, 1, 4) == 4 && miniargv_cpuset_spread(&cpuset, 3, 4) == 12);
+  CHECK(miniargv_cpuset_spread(&cpuset, 17, 0) == 1 && miniargv_cpuset_spread(&cpuset, 17, 32) == 1);
+  miniargv_cleanup(cpusetdef);
+  CHECK(cpuset.mask == NULL && cpuset.count == 0 && miniargv_cpuset_spread(&cpuset, 0, 0) == -1);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int main (int argc, char *argv[])
+{
+  test_lazy();
+  test_parallel();
+  test_defaults();
+  test_terminator();
+  test_cache();
+  test_longarg();
+  test_suggest();
+  test_overlay();
+  test_emit();
+  test_options();
+  test_applet();
+  test_blob();
+  test_array();
+  test_cpuset();
+  if (failures) {
+    fprintf(stderr, "%i check(s) failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,431 @@
+/**
+ * @file miniargv-test-cfgparser.c
+ * @brief miniargv configuration file parser test
+ * @author Brecht Sanders
+ *
+ * This program checks that miniargv_process_cfgfile() produces identical output to the original line based parser for plain configuration files
+ * (randomly generated, without quotes or backslashes), and that quoted values, escapes and continuation lines are handled as expected
+ * (with a trailing backslash only continuing quoted values).
+ * It also checks that miniargv_cfg_lookup() returns the last value the reference parser finds for a variable.
+ */
+
+#include <miniargv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+////////////////////////////////////////////////////////////////////////
+
+//random number generator with reproducible results (xorshift)
+static unsigned long long random_state = 1;
+
+static void random_seed (unsigned long long seed)
+{
+  random_state = (seed ? seed : 1) * 0x9E3779B97F4A7C15ull;
+}
+
+static unsigned int random_next (unsigned int limit)
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+  return (unsigned int)(random_state >> 32) % limit;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//output of a parser: one line per callback
+struct output_struct {
+  char* data;
+  size_t len;
+  size_t size;
+};
+
+static void output_add (struct output_struct* output, const char* name, const char* value)
+{
+  size_t n = strlen(name) + strlen(value) + 4;
+  if (output->len + n + 1 > output->size) {
+    output->size = (output->len + n + 1) * 2;
+    output->data = (char*)realloc(output->data, output->size);
+  }
+  output->len += sprintf(output->data + output->len, "%s=[%s]\n", name, value);
+}
+
+static int record_value (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  output_add((struct output_struct*)callbackdata, argdef->longarg, value);
+  return 0;
+}
+
+static const miniargv_definition cfgdef[] = {
+  {0, "number", "N", record_value, NULL, "", NULL},
+  {0, "string", "S", record_value, NULL, "", NULL},
+  {0, "name", "S", record_value, NULL, "", NULL},
+  {0, "path", "S", record_value, NULL, "", NULL},
+  {0, "empty", "S", record_value, NULL, "", NULL},
+  {0, "a", "S", record_value, NULL, "", NULL},
+  MINIARGV_DEFINITION_END
+};
+
+//remember last value of a variable
+static int record_last_value (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  free(*(char**)callbackdata);
+  *(char**)callbackdata = strdup(value);
+  return 0;
+}
+
+//definitions with only one variable for comparing miniargv_cfg_lookup() results
+//(the parsers also accept abbreviated variable names, so only names that aren't the start of other names used in the random files are looked up)
+static const miniargv_definition lookupdef[][2] = {
+  {{0, "number", "N", record_last_value, NULL, "", NULL}, MINIARGV_DEFINITION_END},
+  {{0, "string", "S", record_last_value, NULL, "", NULL}, MINIARGV_DEFINITION_END},
+  {{0, "path", "S", record_last_value, NULL, "", NULL}, MINIARGV_DEFINITION_END},
+  {{0, "empty", "S", record_last_value, NULL, "", NULL}, MINIARGV_DEFINITION_END},
+  {{0, "a", "S", record_last_value, NULL, "", NULL}, MINIARGV_DEFINITION_END},
+  {{0, "unknown", "S", record_last_value, NULL, "", NULL}, MINIARGV_DEFINITION_END}
+};
+
+////////////////////////////////////////////////////////////////////////
+
+//original line based parser used as reference
+
+#define REFERENCE_READLINE_BLOCK_SIZE 128
+
+static char* reference_readline (FILE* src)
+{
+  int datalen;
+  char* p;
+  size_t resultsize = REFERENCE_READLINE_BLOCK_SIZE;
+  size_t resultlen = 0;
+  char* result;
+  if ((result = (char*)malloc(resultsize)) == NULL)
+    return NULL;
+  while (fgets(result + resultlen, resultsize - resultlen, src)) {
+    datalen = strlen(result + resultlen);
+    resultlen += datalen;
+    if (resultlen > 0 && result[resultlen - 1] == '\n') {
+      result[--resultlen] = 0;
+      if (resultlen > 0 && result[resultlen - 1] == '\r')
+        result[--resultlen] = 0;
+      return result;
+    }
+    if (resultlen + 1 >= resultsize) {
+      resultsize *= 2;
+      if ((p = (char*)realloc(result, resultsize)) == NULL)
+        break;
+      result = p;
+    }
+  }
+  if (resultlen == 0) {
+    free(result);
+    return NULL;
+  }
+  return result;
+}
+
+static int reference_process_cfgfile (const char* cfgfile, const miniargv_definition cfgdef[], void* callbackdata)
+{
+  FILE* src;
+  char* line;
+  char* p;
+  char* varname;
+  size_t varnamelen;
+  char separator;
+  char* value;
+  const miniargv_definition* current_cfgdef;
+  int status = 0;
+  if ((src = fopen(cfgfile, "rb")) != NULL) {
+    while (status == 0 && (line = reference_readline(src)) != NULL) {
+      varname = line;
+      while (*varname && isspace(*varname))
+        varname++;
+      if (*varname == '@') {
+        varname++;
+        while (*varname && isspace(*varname))
+          varname++;
+        if ((p = strchr(varname, 0)) != NULL) {
+          while (p != varname && isspace(*(p - 1)))
+            p--;
+          *p = 0;
+        }
+        if (*varname)
+          status = reference_process_cfgfile(varname, cfgdef, callbackdata);
+      } else if (*varname) {
+        p = varname;
+        while (*p && *p != '=' && *p != ':' && *p != '@' && *p != '#' && *p != ';')
+          p++;
+        separator = *p;
+        if (separator == '=' || separator == ':' || separator == '@') {
+          value = p + 1;
+          while (p != varname && isspace(*(p - 1)))
+            p--;
+          if (p != varname) {
+            varnamelen = p - varname;
+            while (*value && isspace(*value))
+              value++;
+            if ((p = strchr(value, 0)) != NULL) {
+              while (p != value && isspace(*(p - 1)))
+                p--;
+              *p = 0;
+            }
+            if ((current_cfgdef = miniargv_find_longarg(varname, varnamelen, cfgdef)) != NULL) {
+              if (separator == '@') {
+                FILE* valuesrc;
+                int datalen;
+                char data[REFERENCE_READLINE_BLOCK_SIZE];
+                int loadedvaluelen = 0;
+                char* loadedvalue = NULL;
+                if ((valuesrc = fopen(value, "rb")) != NULL) {
+                  while ((datalen = fread(data, 1, sizeof(data), valuesrc)) > 0) {
+                    if ((loadedvalue = (char*)realloc(loadedvalue, loadedvaluelen + datalen + 1)) == NULL)
+                      break;
+                    memcpy(loadedvalue + loadedvaluelen, data, datalen);
+                    loadedvaluelen += datalen;
+                  }
+                  fclose(valuesrc);
+                  if (loadedvalue) {
+                    loadedvalue[loadedvaluelen] = 0;
+                    status = (current_cfgdef->callbackfn)(current_cfgdef, loadedvalue, callbackdata);
+                    free(loadedvalue);
+                  }
+                }
+              } else {
+                status = (current_cfgdef->callbackfn)(current_cfgdef, value, callbackdata);
+              }
+            }
+          }
+        }
+      }
+      free(line);
+    }
+    fclose(src);
+  }
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+static char tmpdir[256];
+
+//write random plain configuration file (no quotes, backslashes or NUL characters)
+static void generate_plain_file (FILE* dst, int numlines, int fileindex, int numfiles)
+{
+  static const char* names[] = {"number", "string", "name", "path", "empty", "a", "unknown", "numbers", "nam", ""};
+  static const char* separators = "=:@#;";
+  static const char* spaces = " \t\r\v\f";
+  static const char* chars = "abcXYZ019 \t\r=:@#;-_.,/|~`'$%^&*()[]{}<>?!+\x80\xC3\xA9\xFF";
+  int i;
+  int j;
+  int n;
+  char separator;
+  int included = 0;
+  for (i = 0; i < numlines; i++) {
+    //leading spaces
+    n = random_next(4);
+    for (j = 0; j < n; j++)
+      fputc(spaces[random_next(5)], dst);
+    switch (random_next(10)) {
+      case 0 :
+        //empty line
+        break;
+      case 1 :
+        //include following file (only once to keep the output size linear)
+        if (!included && fileindex + 1 < numfiles) {
+          fprintf(dst, "@%s%s/miniargv-test-cfgparser-%i.cfg%s", (random_next(2) ? " " : ""), tmpdir, fileindex + 1, (random_next(2) ? " \t" : ""));
+          included = 1;
+        }
+        break;
+      case 2 :
+        //comment
+        fprintf(dst, "%c comment = %u", (random_next(2) ? '#' : ';'), random_next(1000));
+        break;
+      default :
+        fputs(names[random_next(sizeof(names) / sizeof(names[0]))], dst);
+        n = random_next(3);
+        for (j = 0; j < n; j++)
+          fputc(spaces[random_next(5)], dst);
+        separator = separators[random_next(random_next(4) ? 2 : 5)];
+        if (separator == '@' && random_next(2)) {
+          //value from file
+          fprintf(dst, "@ %s/miniargv-test-cfgparser-value.txt", tmpdir);
+        } else {
+          fputc(separator, dst);
+          n = random_next(random_next(8) ? 24 : 400);
+          for (j = 0; j < n; j++)
+            fputc(chars[random_next(strlen(chars))], dst);
+        }
+        break;
+    }
+    //line end (last line may not have one)
+    if (i + 1 < numlines || random_next(2))
+      fputs((random_next(4) ? "\n" : "\r\n"), dst);
+  }
+}
+
+//compare miniargv_cfg_lookup() with the last value found by the reference parser, returns number of differences
+static int test_lookup (const char* path, unsigned long long seed, int verbose)
+{
+  int i;
+  int pass;
+  char* reference;
+  char* value;
+  int result = 0;
+  for (i = 0; i < sizeof(lookupdef) / sizeof(lookupdef[0]); i++) {
+    reference = NULL;
+    reference_process_cfgfile(path, lookupdef[i], &reference);
+    //first pass builds the index in memory, second pass uses it, third pass uses the index file
+    for (pass = 0; pass < 3; pass++) {
+      if (pass == 2)
+        miniargv_cfg_index_update(path);
+      value = miniargv_cfg_lookup(path, lookupdef[i][0].longarg);
+      if ((value == NULL) != (reference == NULL) || (value && strcmp(value, reference) != 0)) {
+        result++;
+        if (verbose)
+          printf("seed %llu: lookup of %s (pass %i) returned %s%s%s instead of %s%s%s\n", seed, lookupdef[i][0].longarg, pass + 1, (value ? "[" : ""), (value ? value : "NULL"), (value ? "]" : ""), (reference ? "[" : ""), (reference ? reference : "NULL"), (reference ? "]" : ""));
+      }
+      free(value);
+    }
+    free(reference);
+  }
+  return result;
+}
+
+//run both parsers on random plain configuration files, returns number of differences
+static int test_plain (unsigned long long seed, int verbose)
+{
+  int i;
+  int numfiles;
+  char path[512];
+  FILE* dst;
+  struct output_struct reference = {NULL, 0, 0};
+  struct output_struct output = {NULL, 0, 0};
+  int result;
+  random_seed(seed);
+  //generate files
+  snprintf(path, sizeof(path), "%s/miniargv-test-cfgparser-value.txt", tmpdir);
+  if ((dst = fopen(path, "wb")) == NULL)
+    return 1;
+  fprintf(dst, "value\nfrom file %u\n", random_next(1000));
+  fclose(dst);
+  numfiles = 1 + random_next(3);
+  for (i = 0; i < numfiles; i++) {
+    snprintf(path, sizeof(path), "%s/miniargv-test-cfgparser-%i.cfg", tmpdir, i);
+    if ((dst = fopen(path, "wb")) == NULL)
+      return 1;
+    generate_plain_file(dst, 1 + random_next(random_next(4) ? 40 : 2000), i, numfiles);
+    fclose(dst);
+  }
+  //compare output
+  snprintf(path, sizeof(path), "%s/miniargv-test-cfgparser-0.cfg", tmpdir);
+  reference_process_cfgfile(path, cfgdef, &reference);
+  miniargv_process_cfgfile(path, cfgdef, &output);
+  result = (reference.len != output.len || (reference.len > 0 && memcmp(reference.data, output.data, reference.len) != 0));
+  if (result || verbose > 1)
+    printf("seed %llu: %lu bytes of output: %s\n", seed, (unsigned long)reference.len, (result ? "DIFFERENT" : "identical"));
+  if (result && verbose)
+    printf("reference:\n%.*s\noutput:\n%.*s\n", (int)reference.len, (reference.data ? reference.data : ""), (int)output.len, (output.data ? output.data : ""));
+  free(reference.data);
+  free(output.data);
+  return result + test_lookup(path, seed, verbose);
+}
+
+//check output for configuration file with quotes, escapes and continuation lines
+static int test_extended (int verbose)
+{
+  char path[512];
+  FILE* dst;
+  struct output_struct output = {NULL, 0, 0};
+  int result;
+  static const char* input =
+    "string = \"  quoted with spaces  \"  \n"
+    "string = \"escapes: \\\"q\\\" \\\\ \\t \\x\"\n"
+    "string = \"unterminated\n"
+    "string = \"text\" after quote\n"
+    "path = C:\\Windows\\System32\n"
+    "path = C:\\tmp\\\n"
+    "name = \"first \\\n"
+    "second \\\r\n"
+    "third\"\n"
+    "name = \"quoted \\\n"
+    "  continued\"\n"
+    "number = 1\n"
+    "a = \"\"\n";
+  static const char* expected =
+    "string=[  quoted with spaces  ]\n"
+    "string=[escapes: \"q\" \\ \t \\x]\n"
+    "string=[\"unterminated]\n"
+    "string=[\"text\" after quote]\n"
+    "path=[C:\\Windows\\System32]\n"
+    "path=[C:\\tmp\\]\n"
+    "name=[first second third]\n"
+    "name=[quoted   continued]\n"
+    "number=[1]\n"
+    "a=[]\n";
+  snprintf(path, sizeof(path), "%s/miniargv-test-cfgparser-extended.cfg", tmpdir);
+  if ((dst = fopen(path, "wb")) == NULL)
+    return 1;
+  fputs(input, dst);
+  fclose(dst);
+  miniargv_process_cfgfile(path, cfgdef, &output);
+  result = (output.len != strlen(expected) || memcmp(output.data, expected, output.len) != 0);
+  if (result || verbose > 1)
+    printf("quotes, escapes and continuation lines: %s\n", (result ? "DIFFERENT" : "as expected"));
+  if (result && verbose)
+    printf("expected:\n%s\noutput:\n%.*s\n", expected, (int)output.len, (output.data ? output.data : ""));
+  remove(path);
+  free(output.data);
+  return result;
+}
+
+int main (int argc, char *argv[])
+{
+  int i;
+  int failed = 0;
+  int showhelp = 0;
+  int verbose = 0;
+  int iterations = 500;
+  int seed = 1;
+  char path[512];
+  const char* p;
+  const miniargv_definition argdef[] = {
+    {'h', "help", NULL, miniargv_cb_increment_int, &showhelp, "show command line help", NULL},
+    {'v', "verbose", NULL, miniargv_cb_increment_int, &verbose, "show differences (specify twice to show all results)", NULL},
+    {'n', "iterations", "N", miniargv_cb_set_int, &iterations, "number of random files to test (default: 500)", NULL},
+    {'s', "seed", "N", miniargv_cb_set_int, &seed, "first random seed (default: 1)", NULL},
+    MINIARGV_DEFINITION_END
+  };
+  if (miniargv_process_arg(argv, argdef, NULL, NULL) != 0)
+    return 1;
+  if (showhelp) {
+    int prognamelen;
+    const char* progname = miniargv_getprogramname(argv[0], &prognamelen);
+    printf("%.*s v%s\nUsage: %.*s ", prognamelen, progname, miniargv_get_version_string(), prognamelen, progname);
+    miniargv_arg_list(argdef, 1);
+    printf("\n");
+    miniargv_help(argdef, NULL, 0, 0);
+    return 0;
+  }
+  //folder for temporary files
+  if ((p = getenv("TMPDIR")) == NULL && (p = getenv("TEMP")) == NULL)
+    p = ".";
+  snprintf(tmpdir, sizeof(tmpdir), "%s", p);
+  //run tests
+  for (i = 0; i < iterations; i++)
+    failed += test_plain(seed + i, verbose);
+  failed += test_extended(verbose);
+  printf("%i random plain files and 1 extended file tested, %i failed\n", iterations, failed);
+  //clean up
+  for (i = 0; i < 3; i++) {
+    snprintf(path, sizeof(path), "%s/miniargv-test-cfgparser-%i.cfg", tmpdir, i);
+    remove(path);
+    snprintf(path, sizeof(path), "%s/miniargv-test-cfgparser-%i.cfg.idx", tmpdir, i);
+    remove(path);
+  }
+  snprintf(path, sizeof(path), "%s/miniargv-test-cfgparser-value.txt", tmpdir);
+  remove(path);
+  snprintf(path, sizeof(path), "%s/miniargv-test-cfgparser-value.txt.idx", tmpdir);
+  remove(path);
+  return (failed ? 1 : 0);
+}
@@ -35,12 +35,31 @@ int process_arg_general_with_value (const miniargv_definition* argdef, const cha
   return 0;
 }
 
+int process_arg_file_value (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  size_t len;
+  if (miniargv_get_file_value(value, &len))
+    printf("Encountered -%c/--%s flag, value read from file (%lu bytes)\n", argdef->shortarg, argdef->longarg, (unsigned long)len);
+  else
+    printf("Encountered -%c/--%s flag, value=%s\n", argdef->shortarg, argdef->longarg, value);
+  return 0;
+}
+
 int process_arg (const miniargv_definition* argdef, const char* value, void* callbackdata)
 {
   printf("Encountered normal argument, value=%s\n", value);
   return 0;
 }
 
+int process_args_bulk (const miniargv_definition* argdef, int argc, char* argv[], void* callbackdata)
+{
+  int i;
+  printf("Encountered %i argument(s) after --\n", argc);
+  for (i = 0; i < argc; i++)
+    printf("  value=%s\n", argv[i]);
+  return 0;
+}
+
 int process_arg_error (const miniargv_definition* argdef, const char* value, void* callbackdata)
 {
   printf("Encountered standalone value argument, value=%s\n", value);
@@ -62,21 +81,23 @@ const miniargv_definition argdef[] = {
   {0,   "general-no-value", NULL, process_arg_general_without_value, NULL, "general parameter without value (long)", NULL},
   {'b', NULL, "VAL", process_arg_general_with_value, NULL, "general parameter with value (short)", NULL},
   {0,   "general-value", "VAL", process_arg_general_with_value, NULL, "general parameter with value (long)", NULL},
+  {'i', "input", "VAL", process_arg_file_value, NULL, "general parameter with value (use @FILE to read value from file)", NULL, NULL, MINIARGV_FLAG_FILE_VALUE},
   {0,   "very-long-command-line-option", NULL, process_arg_general_without_value, NULL, "very long command line option", NULL},
   {'l', "long", NULL, process_arg_verbose, NULL, "This is a very long description line in the command line help, so it should be wrapped across multiple lines. If all goes well this should take up 3 lines in the command line help. ====================================================================================================", NULL},
-  {0, NULL, "param", process_arg, NULL, "standalone value argument", NULL},
+  {0, NULL, "param", process_arg, NULL, "standalone value argument", NULL, process_args_bulk},
   MINIARGV_DEFINITION_END
 };
 
 ////////////////////////////////////////////////////////////////////////
 
-int main (int argc, char *argv[])
+int main (int argc, char *argv[], char *envp[])
 {
   struct parameters_struct params = {
     .verbose = 0,
     .number = 0,
   };
-  if (miniargv_process_arg(argv, argdef, process_arg_error, &params) != 0)
+  //process command line arguments (preceded by the ones in environment variable MINIARGV_TEST_OPTIONS)
+  if (miniargv_process_arg_env_options(argv, envp, "MINIARGV_TEST_OPTIONS", argdef, process_arg_error, &params) != 0)
     return 1;
   printf("verbose = %i\n", params.verbose);
   printf("number = %i\n", params.number);
@@ -87,5 +108,6 @@ int main (int argc, char *argv[])
   miniargv_arg_list(argdef, 1);
   printf("\n");
   miniargv_arg_help(argdef, 24, 79);
+  miniargv_cleanup(argdef);
   return 0;
 }
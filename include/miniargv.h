@@ -10,6 +10,7 @@
 #define INCLUDED_MINIARGV_H
 
 #include <stdio.h>
+#include <limits.h>
 
 /*! \cond PRIVATE */
 #if !defined(DLL_EXPORT_MINIARGV)
@@ -38,6 +39,10 @@ extern "C" {
 typedef struct miniargv_definition_struct miniargv_definition;
 
 /*! \brief callback function called by miniargv_process_arg() for each argument encountered
+ *
+ * When used as \a badfn for a command line argument that was not found, \a argdef is NULL (use miniargv_suggest() to find the argument that was most likely meant).
+ * Note that the \a badfn of miniargv_process_cfgfile_badfn() gets the closest definition instead (or NULL if there is none),
+ * so a function used for both can't tell from \a argdef alone which definition was matched.
  * \param  argdef        definition of command line argument, or NULL for standalone value argument
  * \param  value         value if specified, otherwise NULL (always specified for standalone value arguments or if \a argdef->argparam is not NULL)
  * \param  callbackdata  user data as passed to \a miniargv_process_arg()
@@ -50,6 +55,20 @@ typedef struct miniargv_definition_struct miniargv_definition;
  */
 typedef int (*miniargv_handler_fn)(const miniargv_definition* argdef, const char* value, void* callbackdata);
 
+/*! \brief callback function called once with all standalone value arguments following the "--" end of options marker
+ * \param  argdef        definition of standalone value argument
+ * \param  argc          number of arguments in \a argv
+ * \param  argv          arguments following "--" (\a argv[argc] is NULL)
+ *                       (called separately for the words in the environment variable and the command line arguments when using miniargv_process_arg_env_options())
+ * \param  callbackdata  user data as passed to \a miniargv_process_arg()
+ * \return 0 to continue processing or non-zero to abort
+ * \sa     miniargv_process_arg()
+ * \sa     miniargv_process_arg_params()
+ * \sa     miniargv_definition
+ * \sa     miniargv_definition_struct
+ */
+typedef int (*miniargv_bulk_handler_fn)(const miniargv_definition* argdef, int argc, char* argv[], void* callbackdata);
+
 /*! \brief callback function called by miniargv_completion() to list possible parameters during bash completion
  * \param  argv          NULL-terminated array of arguments (first one is undefined)
  * \param  env           NULL-terminated array of environment variables
@@ -84,6 +103,9 @@ typedef int (*miniargv_complete_fn)(char *argv[], char* env[], const miniargv_de
  * An entry with both \a shortarg and \a longarg set to NULL refers to standalone value arguments.
  * Standalone value arguments are arguments not starting with either "-" or "--" (except for "-" all by itself which is als considered a standalone value argument).
  *
+ * An argument consisting of only "--" marks the end of options: all arguments following it are standalone value arguments, even if they start with "-".
+ * These are not looked up, but are passed to \a bulkfn of the standalone value argument definition in a single call (or to \a callbackfn one by one if \a bulkfn is NULL).
+ *
  * \sa     miniargv_definition
  * \sa     miniargv_process_arg()
  * \sa     miniargv_process_arg_flags()
@@ -99,17 +121,76 @@ struct miniargv_definition_struct {
   const void* userdata;             /**< user data specific for this argument, can be used in callback functions */
   const char* help;                 /**< description of what this command line argument is for, used by \a miniargv_arg_help() */
   miniargv_complete_fn completefn;  /**< bash shell completion callback function, used by \a miniargv_completion() */
+  miniargv_bulk_handler_fn bulkfn;  /**< callback function called once with all standalone value arguments following "--" (only used for standalone value argument definition, NULL to call \a callbackfn for each of them) */
+  unsigned int flags;               /**< combination of MINIARGV_FLAG_* values, or 0 */
+  const char* defaultvalue;         /**< default value passed to \a callbackfn by miniargv_defaults_apply() and written by miniargv_cfgfile_generate(), or NULL */
 };
 
+/*! \brief flag for \a flags in \a miniargv_definition to indicate \a callbackfn is independent of other callbacks and may run in parallel
+ *
+ * Invocations of such callbacks are collected while processing and are run on a pool of threads afterwards.
+ * Callbacks without this flag are still called in order while processing.
+ * Any callback that fails is reported as a bad argument after all of them finished.
+ * \sa     miniargv_definition_struct
+ * \sa     miniargv_process_arg()
+ * \sa     miniargv_process_cfgfile()
+ */
+#define MINIARGV_FLAG_PARALLEL 0x01
+
+/*! \brief flag for \a flags in \a miniargv_definition to allow a command line argument value of the form \@path to be read from the specified file
+ *
+ * The file is mapped in memory read-only and \a callbackfn is passed its contents instead of the value (without copying and always followed by a NUL character).
+ * Use miniargv_get_file_value() to get the length of the contents (which may contain NUL characters).
+ * The contents remain available until miniargv_cleanup() is called for the definitions.
+ * Files that can't be mapped (like pipes) are read in memory instead.
+ * A value starting with \@\@ is passed without the first \@.
+ * This only applies to command line arguments, not to environment variables or configuration files (which have their own \@ syntax).
+ * \sa     miniargv_definition_struct
+ * \sa     miniargv_get_file_value()
+ * \sa     miniargv_cleanup()
+ */
+#define MINIARGV_FLAG_FILE_VALUE 0x02
+
+/*! \brief flag for \a flags in \a miniargv_definition to indicate the command line argument may be specified more than once
+ *
+ * Bash shell completion hides command line arguments that were already specified, unless they have this flag.
+ * Definitions using miniargv_cb_increment_int(), miniargv_cb_increment_long(), miniargv_cb_decrement_int() or miniargv_cb_decrement_long() don't need it.
+ * \sa     miniargv_definition_struct
+ * \sa     miniargv_complete_line()
+ */
+#define MINIARGV_FLAG_REPEATABLE 0x04
+
 /*! \cond PRIVATE */
 #define MINIARGV_DEFINITION_INCLUDE_SHORTARG -0x80
 /*! \endcond */
 
 /*! \brief include another argument definition block */
-#define MINIARGV_DEFINITION_INCLUDE(def) {MINIARGV_DEFINITION_INCLUDE_SHORTARG, NULL, NULL, (miniargv_handler_fn)(def), NULL, NULL, NULL}
+#define MINIARGV_DEFINITION_INCLUDE(def) {MINIARGV_DEFINITION_INCLUDE_SHORTARG, NULL, NULL, (miniargv_handler_fn)(def), NULL, NULL, NULL, NULL, 0, NULL}
 
 /*! \brief include another argument definition block */
-#define MINIARGV_DEFINITION_END {0, NULL, NULL, NULL, NULL, NULL, NULL}
+#define MINIARGV_DEFINITION_END {0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, NULL}
+
+/*! \brief help text of a definition indicating the actual help text is stored in compressed help texts registered with miniargv_set_compressed_help()
+ * \sa     MINIARGV_HELP()
+ */
+#define MINIARGV_HELP_COMPRESSED "\033"
+
+/*! \brief help text of a definition, which is left out of the binary when \a MINIARGV_COMPRESS_HELP or \a MINIARGV_NO_HELP is defined
+ *
+ * Build once without \a MINIARGV_COMPRESS_HELP to write the compressed help texts with miniargv_help_compress(),
+ * and build with \a MINIARGV_COMPRESS_HELP to only keep the much smaller compressed help texts, which are loaded when help is actually shown.
+ * When \a MINIARGV_NO_HELP is defined (library built without help functions) help texts are NULL.
+ * \param  text                  help text
+ * \sa     miniargv_help_compress()
+ * \sa     miniargv_set_compressed_help()
+ */
+#if defined(MINIARGV_NO_HELP)
+#define MINIARGV_HELP(text) NULL
+#elif defined(MINIARGV_COMPRESS_HELP)
+#define MINIARGV_HELP(text) MINIARGV_HELP_COMPRESSED
+#else
+#define MINIARGV_HELP(text) text
+#endif
 
 /*! \brief first process environment variables, then process command line argument flags and finally process command line arguments values, and call the appropriate callback function for each match
  * \param  argv          NULL-terminated array of arguments (first one is the application itself)
@@ -164,6 +245,36 @@ DLL_EXPORT_MINIARGV int miniargv_process_ltr (char* argv[], char* env[], const m
  */
 DLL_EXPORT_MINIARGV int miniargv_process_arg (char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata);
 
+/*! \brief returned by miniargv_process_arg_env_options() when memory could not be allocated (lower than minus the position of any word)
+ * \sa     miniargv_process_arg_env_options()
+ */
+#define MINIARGV_ERROR_NO_MEMORY INT_MIN
+
+/*! \brief process command line arguments found in an environment variable (like JAVA_TOOL_OPTIONS) followed by the command line arguments
+ *
+ * The value of the environment variable is split into words the way the shell does (using quotes and backslashes).
+ * These words are processed as if they were inserted in front of the command line arguments, without building a combined argument list.
+ * Each argument in the environment variable must be complete (an option expecting a value can't take its value from the command line).
+ * If the environment variable contains "--" all command line arguments are standalone value arguments.
+ * As the words and the command line arguments are not combined in one list, a \a bulkfn of the standalone value argument definition is then called twice:
+ * first with the words following "--" (if any) and then with the command line arguments following \a argv[0] (if any).
+ * The words remain available to callback functions until miniargv_cleanup() is called for \a argdef
+ * or this function is called again with the same \a argdef (which releases the words of the previous call).
+ * \param  argv          NULL-terminated array of arguments (first one is the application itself)
+ * \param  env           NULL-terminated array of environment variables (as passed via main() or the global variable environ)
+ * \param  varname       name of the environment variable containing additional command line arguments
+ * \param  argdef        definitions of possible command line arguments
+ * \param  badfn         callback function for bad arguments
+ * \param  callbackdata  user data passed to callback functions
+ * \return 0 on success, index of argument that caused processing to abort, minus the position of the word in the environment variable that caused processing to abort,
+ *         or MINIARGV_ERROR_NO_MEMORY if the words could not be allocated
+ * \sa     miniargv_definition
+ * \sa     miniargv_handler_fn
+ * \sa     miniargv_process_arg()
+ * \sa     miniargv_cleanup()
+ */
+DLL_EXPORT_MINIARGV int miniargv_process_arg_env_options (char* argv[], char* env[], const char* varname, const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata);
+
 /*! \brief process only flag command line arguments and call the appropriate callback function for each one (except the first one which is the application name)
  * \param  argv          NULL-terminated array of arguments (first one is the application itself)
  * \param  argdef        definitions of possible command line arguments
@@ -197,7 +308,7 @@ DLL_EXPORT_MINIARGV int miniargv_process_arg_flags (char* argv[], const miniargv
  */
 DLL_EXPORT_MINIARGV int miniargv_process_arg_params (char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata);
 
-/*! \brief get next value command line argument
+/*! \brief get next value command line argument (all arguments following "--" are value arguments)
  * \param  argindex      index of current argument or 0 for the first call
  * \param  argv          NULL-terminated array of arguments (first one is the application itself)
  * \param  argdef        definitions of possible command line arguments
@@ -238,6 +349,11 @@ DLL_EXPORT_MINIARGV int miniargv_process_env (char* env[], const miniargv_defini
  *         Configuration lines consist of a variable name, followed by an equals (=) sign or a colon (:), followed by a value.
  *         Whitespace before and after the equals (=) sign or a colon (:) is ignored.
  *         It is also possible to use an at-sign (@) instead of an equals (=) sign or a colon (:), but then the value specifies a file that will be loaded.
+ *         A value enclosed in double quotes (") keeps its leading and trailing whitespace and supports the escapes \\n, \\t, \\r, \\\\ and \\".
+ *         Within a value enclosed in double quotes (") a backslash (\\) at the end of a line continues the value on the next line.
+ *         Values not enclosed in double quotes are taken literally up to the end of the line (so e.g. C:\\tmp\\ keeps its trailing backslash).
+ *         Only ASCII whitespace is ignored, independent of the current locale.
+ *         The index passed to the callback function is the line number where the variable was found.
  * \sa     miniargv_definition
  * \sa     miniargv_handler_fn
  * \sa     miniargv_process()
@@ -250,9 +366,21 @@ DLL_EXPORT_MINIARGV int miniargv_process_env (char* env[], const miniargv_defini
  */
 DLL_EXPORT_MINIARGV int miniargv_process_cfgfile (const char* cfgfile, const miniargv_definition cfgdef[], void* callbackdata);
 
-/*! \brief generate configuration file template (\a argparam will be used as default value)
+/*! \brief process configuration file like miniargv_process_cfgfile() and call \a badfn for each unknown variable
+ * \param  cfgfile       path of configuration file to read
+ * \param  cfgdef        definitions of possible configuration file variables (shortarg is ignored)
+ * \param  badfn         callback function called with the definition with the closest name (see miniargv_suggest()) or NULL as \a argdef and the name of the unknown variable as \a value, or NULL to ignore unknown variables
+ *                       (unlike the \a badfn of miniargv_process_arg(), which always gets NULL as \a argdef)
+ * \param  callbackdata  user data passed to callback functions
+ * \return 0 on success or abort code returned by callback function
+ * \sa     miniargv_process_cfgfile()
+ * \sa     miniargv_suggest()
+ */
+DLL_EXPORT_MINIARGV int miniargv_process_cfgfile_badfn (const char* cfgfile, const miniargv_definition cfgdef[], miniargv_handler_fn badfn, void* callbackdata);
+
+/*! \brief generate configuration file template (\a defaultvalue will be used as default value, or \a argparam if not set)
  * \param  cfgfile       handle where configuration file template will be written to
- * \param  cfgdef        definitions of possible configuration file variables (shortarg is ignored, values are set to argparam)
+ * \param  cfgdef        definitions of possible configuration file variables (shortarg is ignored, values are set to defaultvalue or argparam)
  * \sa     miniargv_process_cfgfile()
  * \sa     miniargv_help()
  * \sa     miniargv_arg_help()
@@ -262,6 +390,82 @@ DLL_EXPORT_MINIARGV int miniargv_process_cfgfile (const char* cfgfile, const min
  */
 DLL_EXPORT_MINIARGV void miniargv_cfgfile_generate (FILE* cfgfile, const miniargv_definition cfgdef[]);
 
+/*! \brief get the value of a single configuration file variable without processing the entire file
+ * \param  cfgfile       path of configuration file to read
+ * \param  key           name of variable
+ * \return value of the variable (caller must free) or NULL if not found
+ *         The value is the same as the last one miniargv_process_cfgfile() would pass to the callback function for this variable, except that \a key must match the variable name exactly.
+ *         An index mapping variable names to line offsets is used to jump straight to the line where the variable was last set.
+ *         The index is read from the index file (path of the configuration file followed by .idx) written by miniargv_cfg_index_update() if it matches the size and last modification time of the configuration file.
+ *         Otherwise the index is built in memory and kept for the next lookups until the configuration file changes (no index file is written).
+ *         Files included after the line where the variable was last set are looked up first (each using their own index).
+ * \sa     miniargv_cfg_index_update()
+ * \sa     miniargv_process_cfgfile()
+ */
+DLL_EXPORT_MINIARGV char* miniargv_cfg_lookup (const char* cfgfile, const char* key);
+
+/*! \brief write the index file used by miniargv_cfg_lookup() if it is missing or out of date (e.g. after installing a new configuration file)
+ * \param  cfgfile       path of configuration file
+ * \return 0 on success or -1 if the index file could not be written
+ * \sa     miniargv_cfg_lookup()
+ */
+DLL_EXPORT_MINIARGV int miniargv_cfg_index_update (const char* cfgfile);
+
+/*! \brief process key-per-file configuration directory (like a Kubernetes ConfigMap or Secret volume) and call the appropriate callback function for each file
+ *
+ * Each file in the directory whose name exactly matches the long name of a definition is processed with its contents as value.
+ * Files starting with a dot (.) are skipped, and a single trailing line break is removed from the values.
+ * The values of all files are read in one buffer with a single read for each file and are processed in order of file name.
+ * If the directory contains a symbolic link named ..data (which is swapped atomically when the files are updated),
+ * the files are read from where it points to, so all values are from the same version.
+ * Use miniargv_keydir_watch_create() to detect updates.
+ * \param  path          path of the directory
+ * \param  cfgdef        definitions of possible configuration variables (shortarg is ignored)
+ * \param  callbackdata  user data passed to callback functions
+ * \return 0 on success, -1 if the directory or its files could not be read, or abort code returned by callback function
+ *         The index passed to the callback function is the position of the file in order of file name (starting at 1).
+ * \sa     miniargv_definition
+ * \sa     miniargv_handler_fn
+ * \sa     miniargv_process_cfgfile()
+ * \sa     miniargv_keydir_watch_create()
+ */
+DLL_EXPORT_MINIARGV int miniargv_process_keydir (const char* path, const miniargv_definition cfgdef[], void* callbackdata);
+
+/*! \brief data type for watching a key-per-file configuration directory for updates
+ * \sa     miniargv_keydir_watch_create()
+ * \sa     miniargv_keydir_watch_wait()
+ * \sa     miniargv_keydir_watch_free()
+ */
+typedef struct miniargv_keydir_watch_struct miniargv_keydir_watch;
+
+/*! \brief start watching a key-per-file configuration directory for atomic updates of its ..data symbolic link
+ *
+ * Create the watch before calling miniargv_process_keydir(), so no update is missed in between.
+ * \param  path          path of the directory
+ * \return watch (free with miniargv_keydir_watch_free()) or NULL on error
+ * \sa     miniargv_keydir_watch_wait()
+ * \sa     miniargv_keydir_watch_free()
+ * \sa     miniargv_process_keydir()
+ */
+DLL_EXPORT_MINIARGV miniargv_keydir_watch* miniargv_keydir_watch_create (const char* path);
+
+/*! \brief wait until the ..data symbolic link of a key-per-file configuration directory points to another version
+ *
+ * On Linux the directory is watched with inotify, otherwise the link is checked every second.
+ * \param  watch         watch as returned by miniargv_keydir_watch_create()
+ * \param  timeout       maximum time to wait in milliseconds (0 to only check, negative to wait indefinitely)
+ * \return 1 if the link changed since the watch was created or since the last change was reported, 0 on timeout, or -1 on error (or when not supported, like on Windows)
+ * \sa     miniargv_keydir_watch_create()
+ * \sa     miniargv_process_keydir()
+ */
+DLL_EXPORT_MINIARGV int miniargv_keydir_watch_wait (miniargv_keydir_watch* watch, int timeout);
+
+/*! \brief stop watching a key-per-file configuration directory
+ * \param  watch         watch as returned by miniargv_keydir_watch_create()
+ * \sa     miniargv_keydir_watch_create()
+ */
+DLL_EXPORT_MINIARGV void miniargv_keydir_watch_free (miniargv_keydir_watch* watch);
+
 /*! \brief get application name and length
  *
  * Gets the name of the current application from the first argv entry (argv[0]) as passed to main().
@@ -308,6 +512,49 @@ DLL_EXPORT_MINIARGV unsigned int miniargv_env_list (const miniargv_definition en
  */
 DLL_EXPORT_MINIARGV void miniargv_arg_help (const miniargv_definition argdef[], int descindent, int wrapwidth);
 
+/*! \brief display help text of command line arguments matching search terms, most relevant first
+ *
+ * Each word in \a terms is looked up in an index of the words in the long arguments, parameter names and help texts of all definitions
+ * (including the included ones), which is built on first use.
+ * Words starting with a search term match, except for single character search terms which must match a whole word (like a short argument).
+ * Definitions matching most search terms are shown first, followed by the ones matching them in long arguments rather than in help texts.
+ * To support \--help=TERM as well as \--help, add a definition with the same long argument and a parameter after the one without parameter.
+ * \param  argdef                array of command line argument definitions
+ * \param  terms                 search terms separated by spaces or punctuation (case insensitive)
+ * \param  descindent            indent where description starts, defaults to 25 if set to 0
+ * \param  wrapwidth             maximum line length, defaults to 79 if set to 0
+ * \return number of matching command line arguments shown, or -1 on error
+ * \sa     miniargv_arg_help()
+ */
+DLL_EXPORT_MINIARGV int miniargv_help_search (const miniargv_definition argdef[], const char* terms, int descindent, int wrapwidth);
+
+/*! \brief write help texts of definitions (including the included ones) as compressed help texts
+ *
+ * The help texts are compressed by replacing frequently used words with 2 byte codes from a dictionary, which is stored with them.
+ * The result can be embedded in or loaded by an application built with \a MINIARGV_COMPRESS_HELP, using the same definitions in the same order.
+ * Help texts that are already compressed are uncompressed first if compressed help texts were registered.
+ * \param  dst                   file to write compressed help texts to (must be opened in binary mode)
+ * \param  argdef                array of definitions
+ * \return zero on success or non-zero on error
+ * \sa     MINIARGV_HELP()
+ * \sa     miniargv_set_compressed_help()
+ */
+DLL_EXPORT_MINIARGV int miniargv_help_compress (FILE* dst, const miniargv_definition argdef[]);
+
+/*! \brief register compressed help texts for definitions with help text \a MINIARGV_HELP_COMPRESSED
+ *
+ * The data is only checked and uncompressed when a help text is needed (e.g. by miniargv_arg_help(), miniargv_env_help(),
+ * miniargv_help_search() or miniargv_cfgfile_generate()), one help text at a time, so it may be a memory mapped file.
+ * Help texts are shown as empty if no (valid) compressed help texts were registered.
+ * \param  argdef                array of definitions
+ * \param  blob                  compressed help texts written by miniargv_help_compress() (must remain valid while registered), or NULL to unregister
+ * \param  blobsize              size of \a blob in bytes
+ * \return zero on success or non-zero on error
+ * \sa     MINIARGV_HELP()
+ * \sa     miniargv_help_compress()
+ */
+DLL_EXPORT_MINIARGV int miniargv_set_compressed_help (const miniargv_definition argdef[], const void* blob, size_t blobsize);
+
 /*! \brief display help text explaining environment variables
  * \param  envdef                definitions of possible environment variables
  * \param  descindent            indent where description starts, defaults to 25 if set to 0
@@ -337,6 +584,24 @@ DLL_EXPORT_MINIARGV void miniargv_env_help (const miniargv_definition envdef[],
  */
 DLL_EXPORT_MINIARGV void miniargv_help (const miniargv_definition argdef[], const miniargv_definition envdef[], int descindent, int wrapwidth);
 
+/*! \brief list bash shell completion candidates for the word at the cursor position by replaying the entire command line up to the cursor
+ *
+ * The command line is split in words the way the shell does (including quotes and backslashes) and the words before the cursor are looked up in one pass,
+ * so values are completed for the option they belong to and options that were already specified are not listed again (unless they are repeatable).
+ * \param  argv                  NULL-terminated array of arguments as passed by bash shell completion
+ * \param  env                   NULL-terminated array of environment variables
+ * \param  index                 index in \a argv of the word being completed as split by bash (which also splits on = signs)
+ * \param  line                  command line being completed (value of COMP_LINE), starting with the command itself
+ * \param  point                 cursor position in \a line (value of COMP_POINT)
+ * \param  argdef                definitions of possible command line arguments
+ * \param  envdef                definitions of possible environment variables
+ * \param  callbackdata          user data to be passed to \a completefn
+ * \return definition for which a value was completed, or NULL if command line arguments were listed
+ * \sa     miniargv_completion()
+ * \sa     MINIARGV_FLAG_REPEATABLE
+ */
+DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_complete_line (char *argv[], char* env[], int index, const char* line, size_t point, const miniargv_definition argdef[], const miniargv_definition envdef[], void* callbackdata);
+
 /*! \brief perform bash shell completion (using tab key on the command line, configured via: complete -C"<path> <completionparam>" <programname>)
  * \param  argv                  NULL-terminated array of arguments (first one is the application itself)
  * \param  env                   NULL-terminated array of environment variables
@@ -348,9 +613,120 @@ DLL_EXPORT_MINIARGV void miniargv_help (const miniargv_definition argdef[], cons
  * \sa     miniargv_definition
  * \sa     miniargv_definition_struct
  * \sa     miniargv_complete_fn
+ * \sa     miniargv_complete_line()
  */
 DLL_EXPORT_MINIARGV int miniargv_completion (char *argv[], char* env[], const miniargv_definition argdef[], const miniargv_definition envdef[], const char* completionparam, void* callbackdata);
 
+/*! \brief main function of an applet in a multi-call binary
+ * \param  argc                  number of arguments in \a argv
+ * \param  argv                  NULL-terminated array of arguments (first one is the applet name)
+ * \param  env                   NULL-terminated array of environment variables
+ * \return exit code
+ * \sa     miniargv_applet
+ * \sa     miniargv_applet_main()
+ */
+typedef int (*miniargv_applet_main_fn)(int argc, char* argv[], char* env[]);
+
+/*! \brief structure for applet definition in a multi-call binary
+ *
+ * Use a \a miniargv_applet[] array to define all applets, the last entry must be \a MINIARGV_APPLET_END.
+ *
+ * An applet is selected by the name the binary was invoked with (e.g. via a symbolic link with the applet name)
+ * or by the first argument if the binary was invoked with its own name.
+ * \sa     miniargv_applet_main()
+ * \sa     miniargv_applet_get()
+ * \sa     miniargv_find_applet()
+ * \sa     miniargv_applet_help()
+ * \sa     miniargv_applet_completion()
+ */
+typedef struct miniargv_applet_struct {
+  const char* name;                     /**< name of the applet */
+  miniargv_applet_main_fn mainfn;       /**< main function of the applet */
+  const miniargv_definition* argdef;    /**< definitions of possible command line arguments of the applet (used for completion), or NULL */
+  const miniargv_definition* envdef;    /**< definitions of possible environment variables of the applet (used for completion), or NULL */
+  const char* help;                     /**< description of the applet, used by \a miniargv_applet_help() */
+} miniargv_applet;
+
+/*! \brief last entry in applet definition array */
+#define MINIARGV_APPLET_END {NULL, NULL, NULL, NULL, NULL}
+
+/*! \brief find applet by name (using a hash table built on first use)
+ *
+ * The hash table is kept until miniargv_index_invalidate() is called with NULL,
+ * which must be done after changing the applet names or before another applet table is placed at the same address.
+ * \param  name                  name of the applet (does not need to be NUL-terminated)
+ * \param  namelen               length of \a name
+ * \param  applets               applet definitions
+ * \return applet definition or NULL if not found
+ * \sa     miniargv_applet
+ * \sa     miniargv_applet_get()
+ */
+DLL_EXPORT_MINIARGV const miniargv_applet* miniargv_find_applet (const char* name, size_t namelen, const miniargv_applet applets[]);
+
+/*! \brief determine applet to run based on the program name or the first argument
+ * \param  argv                  NULL-terminated array of arguments (first one is the application itself)
+ * \param  applets               applet definitions
+ * \param  argindex              pointer that will receive the index in \a argv of the applet name (0 or 1), or NULL
+ * \return applet definition or NULL if not found
+ * \sa     miniargv_applet
+ * \sa     miniargv_applet_main()
+ * \sa     miniargv_getprogramname()
+ */
+DLL_EXPORT_MINIARGV const miniargv_applet* miniargv_applet_get (char* argv[], const miniargv_applet applets[], int* argindex);
+
+/*! \brief returned by miniargv_applet_main() if no applet was found (applets must not return this value)
+ * \sa     miniargv_applet_main()
+ */
+#define MINIARGV_APPLET_NOT_FOUND INT_MIN
+
+/*! \brief run applet based on the program name (binary invoked as: applet args...) or the first argument (binary invoked as: binary applet args...)
+ * \param  argc                  number of arguments in \a argv
+ * \param  argv                  NULL-terminated array of arguments (first one is the application itself)
+ * \param  env                   NULL-terminated array of environment variables
+ * \param  applets               applet definitions
+ * \return exit code of the applet or MINIARGV_APPLET_NOT_FOUND if no applet was found
+ * \sa     miniargv_applet
+ * \sa     miniargv_applet_get()
+ * \sa     miniargv_applet_help()
+ */
+DLL_EXPORT_MINIARGV int miniargv_applet_main (int argc, char* argv[], char* env[], const miniargv_applet applets[]);
+
+/*! \brief display help text listing applets
+ * \param  applets               applet definitions
+ * \param  descindent            indent where description starts, defaults to 25 if set to 0
+ * \param  wrapwidth             maximum line length, defaults to 79 if set to 0
+ * \sa     miniargv_applet
+ * \sa     miniargv_wrap_and_indent_text()
+ */
+DLL_EXPORT_MINIARGV void miniargv_applet_help (const miniargv_applet applets[], int descindent, int wrapwidth);
+
+/*! \brief perform bash shell completion for a multi-call binary and all of its applets
+ *
+ * When completing the first argument of the binary itself the applet names are listed,
+ * otherwise the arguments of the applet are completed (as determined from the COMP_LINE environment variable set by bash).
+ * If \a completionparam is NULL completion mode is only detected if COMP_LINE is set, so applets invoked with 3 arguments are not mistaken for completion.
+ * \param  argv                  NULL-terminated array of arguments (first one is the application itself)
+ * \param  env                   NULL-terminated array of environment variables
+ * \param  applets               applet definitions
+ * \param  completionparam       command line parameter used for bash shell completion mode as configured in bash using: complete -C"<path> <completionparam>" <programname>
+ * \param  callbackdata          user data to be passed to \a completefn
+ * \return non-zero if running in bash completion mode (program should exit after this), otherwise zero
+ * \sa     miniargv_applet
+ * \sa     miniargv_completion()
+ * \sa     miniargv_applet_completion_script()
+ */
+DLL_EXPORT_MINIARGV int miniargv_applet_completion (char* argv[], char* env[], const miniargv_applet applets[], const char* completionparam, void* callbackdata);
+
+/*! \brief write bash commands to configure completion for a multi-call binary and all of its applets
+ * \param  dst                   stream to write to
+ * \param  path                  path of the multi-call binary
+ * \param  completionparam       command line parameter used for bash shell completion mode, or NULL
+ * \param  applets               applet definitions
+ * \sa     miniargv_applet
+ * \sa     miniargv_applet_completion()
+ */
+DLL_EXPORT_MINIARGV void miniargv_applet_completion_script (FILE* dst, const char* path, const char* completionparam, const miniargv_applet applets[]);
+
 /*! \brief find short argument definition
  * \param  shortarg              short argument character
  * \param  argdef                array of command line argument definitions
@@ -362,7 +738,7 @@ DLL_EXPORT_MINIARGV int miniargv_completion (char *argv[], char* env[], const mi
  */
 DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_shortarg (char shortarg, const miniargv_definition argdef[]);
 
-/*! \brief find long argument definition or environment variable definition
+/*! \brief find long argument definition or environment variable definition (an exact match is preferred, otherwise the first definition starting with \a longarg is returned)
  * \param  longarg               long argument name (without leading hyphens) or environment variable name
  * \param  longarglen            length of \a longarg, 0 to autodetect
  * \param  argdef                array of command line argument definitions or environment variable definitions
@@ -384,6 +760,27 @@ DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_longarg (const char
  */
 DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_standalonearg (const miniargv_definition argdef[]);
 
+/*! \brief maximum edit distance between a misspelled name and the long argument names suggested by miniargv_suggest() (1 is used for names shorter than 4 characters)
+ * \sa     miniargv_suggest()
+ */
+#define MINIARGV_SUGGEST_DISTANCE 2
+
+/*! \brief find definitions with a long argument name close to a misspelled one (e.g. to show "did you mean" in an error message)
+ *
+ * The edit distance (number of characters inserted, removed or replaced) is looked up in a BK-tree of the long argument names,
+ * which is built on first use and kept until it is invalidated with miniargv_index_invalidate().
+ * \param  name                  misspelled name (leading hyphens and anything from an equals sign (=) onwards are ignored, so a command line argument can be passed as is)
+ * \param  argdef                array of command line argument definitions or configuration file variable definitions
+ * \param  suggestions           array that will receive the closest definitions (closest first, definitions at the same distance in the order they were defined)
+ * \param  maxsuggestions        maximum number of definitions to store in \a suggestions
+ * \return number of definitions stored in \a suggestions (0 if there are none within an edit distance of MINIARGV_SUGGEST_DISTANCE)
+ * \sa     MINIARGV_SUGGEST_DISTANCE
+ * \sa     miniargv_find_longarg
+ * \sa     miniargv_process_arg()
+ * \sa     miniargv_process_cfgfile_badfn()
+ */
+DLL_EXPORT_MINIARGV int miniargv_suggest (const char* name, const miniargv_definition argdef[], const miniargv_definition* suggestions[], int maxsuggestions);
+
 /*! \brief find argument definition for short ("-" followed by 1 character) long (starting with "--") argument
  * \param  arg                   argument to search for
  * \param  argdef                definitions of possible command line arguments
@@ -392,6 +789,22 @@ DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_standalonearg (cons
  */
 DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_arg (const char* arg, const miniargv_definition argdef[]);
 
+/*! \brief discard the lookup indexes built for a definition table
+ *
+ * On first use a lookup index is built for each definition table (including the definitions it includes)
+ * and kept in a cache, keyed by the address of the table.
+ * It is used while processing command line arguments and configuration files, by the miniargv_find_*() functions and by completion, help search and suggestions.
+ * The index records the number of definitions and their short and long argument names, callback functions and help texts,
+ * so this function must be called after changing any of these in a table that was already used,
+ * and before another table is placed at the same address (e.g. an array local to a function that is called again).
+ * Changes to other members are seen without calling this function.
+ * Indexes that are still being used by other threads are freed when those are done with them.
+ * \param  argdef                array of definitions, or NULL to discard all lookup indexes (including the hash tables built for applet tables)
+ * \sa     miniargv_process
+ * \sa     miniargv_suggest
+ */
+DLL_EXPORT_MINIARGV void miniargv_index_invalidate (const miniargv_definition argdef[]);
+
 /*! \brief display help text wile wrapping it at a maximum width and indenting new lines
  * \param  dst                   stream to write to (use stdout for console output)
  * \param  text                  text to display
@@ -409,20 +822,206 @@ DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_arg (const char* ar
  */
 DLL_EXPORT_MINIARGV void miniargv_wrap_and_indent_text (FILE* dst, const char* text, int currentpos, int indentpos, int wrapwidth, const char* newline);
 
-/*! \brief clean up dynamically allocated memory (currently only when using miniargv_cb_strdup)
+/*! \brief get the length of a value read from a file for a definition with MINIARGV_FLAG_FILE_VALUE
+ * \param  value                 value as passed to the callback function
+ * \param  length                pointer that will receive the length of the file contents in bytes (can be NULL)
+ * \return non-zero if \a value is the contents of a file or 0 if it isn't
+ * \sa     MINIARGV_FLAG_FILE_VALUE
+ */
+DLL_EXPORT_MINIARGV int miniargv_get_file_value (const char* value, size_t* length);
+
+/*! \brief clean up dynamically allocated memory (when using miniargv_cb_strdup, miniargv_cb_lazy, miniargv_cb_set_blob, miniargv_cb_set_array, miniargv_cb_set_cpuset or miniargv_process_arg_env_options()) and release files mapped for MINIARGV_FLAG_FILE_VALUE
  * \param  argdef                definitions of possible command line arguments or environment variables
  * \return 0 on success or index of argument that caused processing to abort
  * \sa     miniargv_definition
  * \sa     miniargv_cb_strdup()
+ * \sa     miniargv_cb_lazy()
+ * \sa     miniargv_cb_set_blob()
+ * \sa     miniargv_cb_set_array()
+ * \sa     miniargv_cb_set_cpuset()
  * \sa     miniargv_process_ltr()
  * \sa     miniargv_process_arg()
  * \sa     miniargv_process_arg_flags()
  * \sa     miniargv_process_arg_params()
  * \sa     miniargv_process_env()
  * \sa     miniargv_process_cfgfile()
+ * \sa     miniargv_process_arg_env_options()
  */
 DLL_EXPORT_MINIARGV int miniargv_cleanup (const miniargv_definition argdef[]);
 
+/*! \brief data type for precomputed default values
+ * \sa     miniargv_defaults_create()
+ * \sa     miniargv_defaults_apply()
+ * \sa     miniargv_defaults_free()
+ */
+typedef struct miniargv_defaults_struct miniargv_defaults;
+
+/*! \brief precompute default values so they can be reset quickly with miniargv_defaults_apply()
+ *
+ * The \a defaultvalue of all definitions using miniargv_cb_set_int(), miniargv_cb_set_long(), miniargv_cb_set_boolean() or miniargv_cb_set_const_str() is converted once.
+ * For other callback functions \a callbackfn is called with \a defaultvalue every time the defaults are applied.
+ *
+ * If \a store is specified (usually a structure containing all variables set by the callback functions) an image of it is taken,
+ * with the converted default values filled in for the variables inside it.
+ * Applying the defaults will then copy the image over \a store in one go
+ * (except for the variables set by miniargv_cb_strdup(), miniargv_cb_lazy(), miniargv_cb_set_blob(), miniargv_cb_set_array() or miniargv_cb_set_cpuset(), which are reset by calling the callback function instead, or left unchanged if they have no \a defaultvalue).
+ * \param  argdef                definitions of possible command line arguments, environment variables or configuration file variables
+ * \param  store                 memory containing the variables set by the callback functions in its initial state, or NULL
+ * \param  storesize             size of \a store in bytes
+ * \return precomputed default values (free with miniargv_defaults_free()) or NULL on error (e.g. if a default value is invalid)
+ * \sa     miniargv_defaults_apply()
+ * \sa     miniargv_defaults_free()
+ * \sa     miniargv_definition_struct
+ */
+DLL_EXPORT_MINIARGV miniargv_defaults* miniargv_defaults_create (const miniargv_definition argdef[], void* store, size_t storesize);
+
+/*! \brief reset all variables to their precomputed default values
+ * \param  defaults              precomputed default values as returned by miniargv_defaults_create()
+ * \param  callbackdata          user data passed to callback functions
+ * \return 0 on success or result of the first callback function that failed
+ * \sa     miniargv_defaults_create()
+ * \sa     miniargv_defaults_free()
+ */
+DLL_EXPORT_MINIARGV int miniargv_defaults_apply (const miniargv_defaults* defaults, void* callbackdata);
+
+/*! \brief free precomputed default values
+ * \param  defaults              precomputed default values as returned by miniargv_defaults_create()
+ * \sa     miniargv_defaults_create()
+ * \sa     miniargv_defaults_apply()
+ */
+DLL_EXPORT_MINIARGV void miniargv_defaults_free (miniargv_defaults* defaults);
+
+/*! \brief maximum number of variables that can be overridden in a miniargv_overlay */
+#define MINIARGV_OVERLAY_SIZE 8
+
+/*! \brief value of a definition overridden in a miniargv_overlay
+ * \sa     miniargv_overlay
+ */
+typedef union miniargv_overlay_value_union {
+  int intval;                       /**< value set by miniargv_cb_set_int(), miniargv_cb_set_boolean(), miniargv_cb_set_int_to_zero(), miniargv_cb_set_int_to_one(), miniargv_cb_set_int_to_minus_one(), miniargv_cb_increment_int() or miniargv_cb_decrement_int() */
+  long longval;                     /**< value set by miniargv_cb_set_long(), miniargv_cb_set_long_to_zero(), miniargv_cb_set_long_to_one(), miniargv_cb_set_long_to_minus_one(), miniargv_cb_increment_long() or miniargv_cb_decrement_long() */
+  const char* strval;               /**< value set by miniargv_cb_set_const_str() */
+} miniargv_overlay_value;
+
+/*! \brief values overriding some of the variables set by the callback functions of a definition table, without modifying these variables
+ *
+ * The variables pointed to by \a userdata of the definitions act as an immutable base that is shared by all overlays
+ * (so they must not be changed while overlays are in use).
+ * An overlay only records the variables that were overridden in a small table inside the structure (keyed by \a userdata,
+ * so definitions setting the same variable, like -v and -q incrementing and decrementing the same int, share the overridden value),
+ * so it can live on the stack and doesn't need to be freed.
+ * Read values with miniargv_overlay_get(), which returns the overridden value if there is one and the base variable otherwise.
+ *
+ * Initialize using \a MINIARGV_OVERLAY, for example:
+ * \code{.c}
+ * miniargv_overlay overlay = MINIARGV_OVERLAY(argdef);
+ * if (miniargv_overlay_set_longarg(&overlay, "timeout", request_timeout) == 0)
+ *   timeout = MINIARGV_OVERLAY_INT(&overlay, &argdef[TIMEOUT_INDEX]);
+ * \endcode
+ * \sa     miniargv_overlay_set()
+ * \sa     miniargv_overlay_set_longarg()
+ * \sa     miniargv_overlay_get()
+ * \sa     MINIARGV_OVERLAY
+ */
+typedef struct miniargv_overlay_struct {
+  const miniargv_definition* argdef;                /**< definitions of the variables in the base (used to look up names) */
+  unsigned int mask;                                /**< bit for each overridden variable to quickly detect variables that weren't overridden */
+  int count;                                        /**< number of overridden variables */
+  struct {
+    const void* userdata;                           /**< overridden variable (\a userdata of the definitions setting it) */
+    miniargv_overlay_value value;                   /**< overriding value */
+  } entries[MINIARGV_OVERLAY_SIZE];                 /**< overridden variables */
+} miniargv_overlay;
+
+/*! \brief initializer for overlay without overridden values
+ * \param  argdef                definitions of the variables in the base
+ * \sa     miniargv_overlay
+ * \hideinitializer
+ */
+#define MINIARGV_OVERLAY(argdef) {(argdef), 0, 0}
+
+/*! \brief remove all overridden values from overlay so it can be reused
+ * \param  overlay               overlay
+ * \sa     miniargv_overlay
+ * \hideinitializer
+ */
+#define MINIARGV_OVERLAY_RESET(overlay) ((overlay)->mask = 0, (overlay)->count = 0)
+
+/*! \brief override value in overlay by calling the callback function of the definition on a copy of its variable
+ *
+ * Only the predefined callback functions listed in miniargv_overlay_value are supported.
+ * Callback functions that modify the current value (e.g. miniargv_cb_increment_int()) start from the value already in the overlay, or from the base variable.
+ * The overridden value is shared by all definitions with the same \a userdata.
+ * \param  overlay               overlay
+ * \param  argdef                definition to override (must be part of the definitions of the overlay)
+ * \param  value                 value passed to the callback function (must remain valid while the overlay is used for miniargv_cb_set_const_str())
+ * \return 0 on success, -1 if the callback function is not supported or the overlay is full, or the non-zero value returned by the callback function
+ * \sa     miniargv_overlay
+ * \sa     miniargv_overlay_set_longarg()
+ * \sa     miniargv_overlay_get()
+ */
+DLL_EXPORT_MINIARGV int miniargv_overlay_set (miniargv_overlay* overlay, const miniargv_definition* argdef, const char* value);
+
+/*! \brief override value in overlay for definition with the specified long argument name
+ * \param  overlay               overlay
+ * \param  longarg               long argument name (looked up like miniargv_find_longarg() does)
+ * \param  value                 value passed to the callback function
+ * \return 0 on success, -1 if the name was not found, or the result of miniargv_overlay_set()
+ * \sa     miniargv_overlay
+ * \sa     miniargv_overlay_set()
+ */
+DLL_EXPORT_MINIARGV int miniargv_overlay_set_longarg (miniargv_overlay* overlay, const char* longarg, const char* value);
+
+/*! \brief get variable for definition, taking overridden values into account
+ * \param  overlay               overlay
+ * \param  argdef                definition
+ * \return pointer to overriding value if the variable of the definition was overridden in \a overlay, otherwise \a argdef->userdata
+ * \sa     miniargv_overlay
+ * \sa     MINIARGV_OVERLAY_INT
+ * \sa     MINIARGV_OVERLAY_LONG
+ * \sa     MINIARGV_OVERLAY_STR
+ */
+DLL_EXPORT_MINIARGV const void* miniargv_overlay_get (const miniargv_overlay* overlay, const miniargv_definition* argdef);
+
+/*! \brief get int value for definition, taking overridden values into account
+ * \sa     miniargv_overlay_get()
+ * \hideinitializer
+ */
+#define MINIARGV_OVERLAY_INT(overlay, argdef) (*(const int*)miniargv_overlay_get((overlay), (argdef)))
+
+/*! \brief get long value for definition, taking overridden values into account
+ * \sa     miniargv_overlay_get()
+ * \hideinitializer
+ */
+#define MINIARGV_OVERLAY_LONG(overlay, argdef) (*(const long*)miniargv_overlay_get((overlay), (argdef)))
+
+/*! \brief get string value for definition, taking overridden values into account
+ * \sa     miniargv_overlay_get()
+ * \hideinitializer
+ */
+#define MINIARGV_OVERLAY_STR(overlay, argdef) (*(const char* const*)miniargv_overlay_get((overlay), (argdef)))
+
+/*! \brief render the current values of the variables back into canonical command line arguments and environment (e.g. to start a child process with the same options)
+ *
+ * Only variables that differ from the value they had before processing are emitted, using the long argument name if available.
+ * Their initial values are taken from \a defaults if specified (which should be created before processing with the \a store containing the variables),
+ * otherwise the converted \a defaultvalue or zero/NULL is assumed.
+ * Only variables set by miniargv_cb_set_int(), miniargv_cb_set_long(), miniargv_cb_set_boolean(), miniargv_cb_set_const_str(), miniargv_cb_strdup(),
+ * and the predefined flag callback functions that set, increment or decrement int or long variables are emitted.
+ * Each variable is emitted only once, by the first definition that can represent its value (command line arguments take precedence over environment variables).
+ * Values starting with an at-sign (@) are escaped for definitions with MINIARGV_FLAG_FILE_VALUE.
+ * \param  argv0                 first command line argument (program path), or NULL to omit
+ * \param  argdef                definitions of possible command line arguments, or NULL
+ * \param  env                   environment to copy (except for variables defined in \a envdef), or NULL
+ * \param  envdef                definitions of possible environment variables, or NULL
+ * \param  defaults              precomputed default values as returned by miniargv_defaults_create(), or NULL
+ * \param  newenv                pointer that will receive the NULL-terminated environment, or NULL to only emit command line arguments
+ * \return NULL-terminated command line arguments (also containing the environment, free everything at once with free()), or NULL on error
+ * \sa     miniargv_process()
+ * \sa     miniargv_defaults_create()
+ */
+DLL_EXPORT_MINIARGV char** miniargv_emit (const char* argv0, const miniargv_definition argdef[], char* env[], const miniargv_definition envdef[], const miniargv_defaults* defaults, char*** newenv);
+
 
 
 /*! \brief predefined callback function to set constant string \b userdata to \b value
@@ -716,6 +1315,268 @@ DLL_EXPORT_MINIARGV int miniargv_cb_noop (const miniargv_definition* argdef, con
  */
 DLL_EXPORT_MINIARGV int miniargv_cb_error (const miniargv_definition* argdef, const char* value, void* callbackdata);
 
+/*! \brief structure for a lazily evaluated value, use a pointer to it as \b userdata for miniargv_cb_lazy()
+ *
+ * The callback function is not called during processing, but only the first time the value is read with miniargv_lazy_get().
+ * If no value was given the default callback function is called instead (with NULL as value).
+ * Initialize using \a MINIARGV_LAZY(), for example:
+ * \code{.c}
+ * int threads = 0;
+ * miniargv_lazy lazy_threads = MINIARGV_LAZY(miniargv_cb_set_int, &threads, compute_default_threads);
+ * const miniargv_definition argdef[] = {
+ *   {'j', "threads", "N", miniargv_cb_lazy, &lazy_threads, "number of threads", NULL},
+ *   MINIARGV_DEFINITION_END
+ * };
+ * \endcode
+ * \sa     miniargv_cb_lazy()
+ * \sa     miniargv_lazy_get()
+ * \sa     MINIARGV_LAZY()
+ */
+typedef struct miniargv_lazy_struct {
+  miniargv_handler_fn callbackfn;   /**< callback function called with the value the first time it is read (\a argdef->userdata will be set to \a userdata) */
+  const void* userdata;             /**< user data passed to \a callbackfn and \a defaultfn as \a argdef->userdata */
+  miniargv_handler_fn defaultfn;    /**< callback function called with NULL as value the first time it is read if no value was given (can be NULL) */
+  /*! \cond PRIVATE */
+  const miniargv_definition* argdef;
+  void* callbackdata;
+  char* value;
+  int result;
+  volatile int state;
+  /*! \endcond */
+} miniargv_lazy;
+
+/*! \brief initializer for lazily evaluated value
+ * \param  callbackfn            callback function called with the value the first time it is read
+ * \param  userdata              user data passed to \a callbackfn and \a defaultfn as \a argdef->userdata
+ * \param  defaultfn             callback function called to set the default value the first time it is read if no value was given (can be NULL)
+ * \sa     miniargv_lazy
+ * \hideinitializer
+ */
+#define MINIARGV_LAZY(callbackfn, userdata, defaultfn) {callbackfn, userdata, defaultfn, NULL, NULL, NULL, 0, 0}
+
+/*! \brief predefined callback function to store \b value for lazy evaluation by the miniargv_lazy structure pointed to by \b userdata
+ * \param  argdef                definition of command line argument, or NULL for standalone value argument
+ * \param  value                 value if specified, otherwise NULL (a copy is kept until miniargv_cleanup() is called)
+ * \param  callbackdata          user data passed to the deferred callback function
+ * \return 0 to continue processing or non-zero to abort (if the value was already read the callback function is called right away and its result is returned)
+ * \sa     miniargv_lazy
+ * \sa     miniargv_lazy_get()
+ * \sa     miniargv_handler_fn
+ * \sa     miniargv_definition
+ * \sa     miniargv_cleanup()
+ */
+DLL_EXPORT_MINIARGV int miniargv_cb_lazy (const miniargv_definition* argdef, const char* value, void* callbackdata);
+
+/*! \brief evaluate lazily evaluated value (only the first call runs the callback function, this is thread-safe and lock-free once evaluated)
+ * \param  lazy                  lazily evaluated value
+ * \return result of the callback function (0 on success)
+ * \sa     miniargv_lazy
+ * \sa     miniargv_cb_lazy()
+ */
+DLL_EXPORT_MINIARGV int miniargv_lazy_get (miniargv_lazy* lazy);
+
+/*! \brief callback function called by miniargv_cb_set_blob() with the decoded binary data
+ * \param  argdef        definition of command line argument, environment variable or configuration file variable
+ * \param  data          decoded data (followed by a NUL character that is not included in \a length), or NULL if no value was given
+ * \param  length        length of \a data in bytes
+ * \param  callbackdata  user data as passed to the processing function
+ * \return 0 to continue processing or non-zero to abort
+ * \sa     miniargv_blob
+ * \sa     miniargv_cb_set_blob()
+ */
+typedef int (*miniargv_blob_handler_fn)(const miniargv_definition* argdef, const unsigned char* data, size_t length, void* callbackdata);
+
+/*! \brief encoding for \a encoding in \a miniargv_blob for hexadecimal digits (optionally preceded by 0x) */
+#define MINIARGV_BLOB_HEX     0
+/*! \brief encoding for \a encoding in \a miniargv_blob for base64 (standard or URL-safe alphabet, padding is optional) */
+#define MINIARGV_BLOB_BASE64  1
+
+/*! \brief binary data decoded from a hexadecimal or base64 value by miniargv_cb_set_blob()
+ *
+ * Initialize using \a MINIARGV_BLOB(), for example:
+ * \code{.c}
+ * miniargv_blob key = MINIARGV_BLOB(MINIARGV_BLOB_HEX, NULL);
+ * const miniargv_definition argdef[] = {
+ *   {'k', "key", "HEX", miniargv_cb_set_blob, &key, "encryption key", NULL},
+ *   MINIARGV_DEFINITION_END
+ * };
+ * \endcode
+ * \sa     miniargv_cb_set_blob()
+ * \sa     MINIARGV_BLOB()
+ */
+typedef struct miniargv_blob_struct {
+  int encoding;                         /**< encoding of the value: MINIARGV_BLOB_HEX or MINIARGV_BLOB_BASE64 */
+  miniargv_blob_handler_fn callbackfn;  /**< callback function called with the decoded data, or NULL */
+  unsigned char* data;                  /**< decoded data (followed by a NUL character that is not included in \a length), or NULL if no value was given */
+  size_t length;                        /**< length of \a data in bytes */
+  /*! \cond PRIVATE */
+  size_t size;
+  /*! \endcond */
+} miniargv_blob;
+
+/*! \brief initializer for binary data decoded from a hexadecimal or base64 value
+ * \param  encoding              encoding of the value: MINIARGV_BLOB_HEX or MINIARGV_BLOB_BASE64
+ * \param  callbackfn            callback function called with the decoded data, or NULL
+ * \sa     miniargv_blob
+ * \hideinitializer
+ */
+#define MINIARGV_BLOB(encoding, callbackfn) {encoding, callbackfn, NULL, 0, 0}
+
+/*! \brief predefined callback function to decode \b value into the miniargv_blob structure pointed to by \b userdata
+ *
+ * The value is validated while it is decoded (using SSE2 if available), leading and trailing spaces are ignored.
+ * Base64 values can use the standard or URL-safe alphabet, padding (=) is optional but if present must complete the last group of 4 digits.
+ * The decoded data is kept until the next value is decoded or miniargv_cleanup() is called.
+ * \param  argdef                definition of command line argument, environment variable or configuration file variable
+ * \param  value                 value if specified, otherwise NULL to clear the data
+ * \param  callbackdata          user data passed to the \a callbackfn of the miniargv_blob structure
+ * \return 0 to continue processing or non-zero to abort (e.g. on invalid value, in which case the data is empty)
+ * \sa     miniargv_blob
+ * \sa     miniargv_handler_fn
+ * \sa     miniargv_definition
+ * \sa     miniargv_cleanup()
+ */
+DLL_EXPORT_MINIARGV int miniargv_cb_set_blob (const miniargv_definition* argdef, const char* value, void* callbackdata);
+
+/*! \brief element type for \a type in \a miniargv_array for 32-bit signed integers (int32_t) */
+#define MINIARGV_ARRAY_I32    0
+/*! \brief element type for \a type in \a miniargv_array for 64-bit signed integers (int64_t) */
+#define MINIARGV_ARRAY_I64    1
+/*! \brief element type for \a type in \a miniargv_array for 64-bit unsigned integers (uint64_t) */
+#define MINIARGV_ARRAY_U64    2
+/*! \brief element type for \a type in \a miniargv_array for double precision floating point numbers (double) */
+#define MINIARGV_ARRAY_DOUBLE 3
+
+/*! \brief array of numbers parsed from a list by miniargv_cb_set_array()
+ *
+ * Initialize using \a MINIARGV_ARRAY(), for example:
+ * \code{.c}
+ * miniargv_array ids = MINIARGV_ARRAY(MINIARGV_ARRAY_I64);
+ * const miniargv_definition argdef[] = {
+ *   {'i', "ids", "LIST", miniargv_cb_set_array, &ids, "comma separated list of identifiers", NULL},
+ *   MINIARGV_DEFINITION_END
+ * };
+ * \endcode
+ * \sa     miniargv_cb_set_array()
+ * \sa     MINIARGV_ARRAY()
+ */
+typedef struct miniargv_array_struct {
+  int type;                         /**< element type: MINIARGV_ARRAY_I32, MINIARGV_ARRAY_I64, MINIARGV_ARRAY_U64 or MINIARGV_ARRAY_DOUBLE */
+  void* data;                       /**< contiguous array of \a count elements of the type specified by \a type, or NULL if no value was given */
+  size_t count;                     /**< number of elements in \a data */
+  /*! \cond PRIVATE */
+  size_t size;
+  /*! \endcond */
+} miniargv_array;
+
+/*! \brief initializer for array of numbers
+ * \param  type                  element type: MINIARGV_ARRAY_I32, MINIARGV_ARRAY_I64, MINIARGV_ARRAY_U64 or MINIARGV_ARRAY_DOUBLE
+ * \sa     miniargv_array
+ * \hideinitializer
+ */
+#define MINIARGV_ARRAY(type) {type, NULL, 0, 0}
+
+/*! \brief predefined callback function to parse the list of numbers in \b value into the miniargv_array structure pointed to by \b userdata
+ *
+ * Numbers are separated by commas and/or spaces and are parsed 8 digits at a time where possible.
+ * Values that are out of range for the element type are rejected.
+ * Each value replaces the previous array, which is kept until the next value is parsed or miniargv_cleanup() is called.
+ * \param  argdef                definition of command line argument, environment variable or configuration file variable
+ * \param  value                 value if specified, otherwise NULL to clear the array
+ * \param  callbackdata          (unused)
+ * \return 0 to continue processing or non-zero to abort (e.g. on invalid value, in which case the array is empty)
+ * \sa     miniargv_array
+ * \sa     miniargv_handler_fn
+ * \sa     miniargv_definition
+ * \sa     miniargv_cleanup()
+ */
+DLL_EXPORT_MINIARGV int miniargv_cb_set_array (const miniargv_definition* argdef, const char* value, void* callbackdata);
+
+/*! \brief set of CPUs parsed from a CPU list or mask by miniargv_cb_set_cpuset()
+ *
+ * On Linux \a mask has the same layout as cpu_set_t, so it can be passed directly to sched_setaffinity() or pthread_setaffinity_np().
+ *
+ * Initialize using \a MINIARGV_CPUSET, for example:
+ * \code{.c}
+ * miniargv_cpuset workercpus = MINIARGV_CPUSET;
+ * const miniargv_definition argdef[] = {
+ *   {0, "cpus", "LIST", miniargv_cb_set_cpuset, &workercpus, "CPUs to run worker threads on (e.g. 0-3,8-11)", NULL},
+ *   MINIARGV_DEFINITION_END
+ * };
+ * \endcode
+ * \sa     miniargv_cb_set_cpuset()
+ * \sa     miniargv_cpuset_spread()
+ * \sa     miniargv_cpuset_pin()
+ * \sa     MINIARGV_CPUSET
+ */
+typedef struct miniargv_cpuset_struct {
+  unsigned long* mask;              /**< bitmap of CPUs in the set (CPU n is bit n % (8 * sizeof(unsigned long)) of mask[n / (8 * sizeof(unsigned long))]), or NULL if empty */
+  size_t masksize;                  /**< size of \a mask in bytes */
+  int* cpus;                        /**< numbers of the CPUs in the set in ascending order */
+  int count;                        /**< number of CPUs in the set */
+} miniargv_cpuset;
+
+/*! \brief initializer for empty set of CPUs
+ * \sa     miniargv_cpuset
+ * \hideinitializer
+ */
+#define MINIARGV_CPUSET {NULL, 0, NULL, 0}
+
+/*! \brief highest CPU number accepted by miniargv_cb_set_cpuset() */
+#define MINIARGV_CPUSET_MAX_CPU 65535
+
+/*! \brief predefined callback function to parse \b value into the miniargv_cpuset structure pointed to by \b userdata
+ *
+ * The value can be either a hexadecimal mask starting with 0x (commas between groups of digits are ignored, e.g. 0xff,00000000)
+ * or a comma separated list (as used by Linux in /sys/devices/system/cpu) of:
+ * - CPU numbers (e.g. 3)
+ * - ranges (e.g. 0-7)
+ * - ranges with a stride (e.g. 0-15:2 for every second CPU)
+ * - ranges with used CPUs per group (e.g. 0-15:2/4 for the first 2 of every 4 CPUs)
+ * - any of the above preceded by ^ or ! to exclude CPUs (regardless of where they appear in the list, e.g. 0-15,^8)
+ * \param  argdef                definition of command line argument, environment variable or configuration file variable
+ * \param  value                 value if specified, otherwise NULL to clear the set
+ * \param  callbackdata          (unused)
+ * \return 0 to continue processing or non-zero to abort (e.g. on invalid value, in which case the set is empty)
+ * \sa     miniargv_cpuset
+ * \sa     miniargv_handler_fn
+ * \sa     miniargv_definition
+ * \sa     miniargv_cleanup()
+ */
+DLL_EXPORT_MINIARGV int miniargv_cb_set_cpuset (const miniargv_definition* argdef, const char* value, void* callbackdata);
+
+/*! \brief copy set of CPUs to a cpu_set_t (or other bitmap of the same layout)
+ * \param  cpuset                set of CPUs
+ * \param  mask                  destination (e.g. pointer to cpu_set_t)
+ * \param  masksize              size of \a mask in bytes (e.g. sizeof(cpu_set_t))
+ * \return 0 on success or non-zero if the set contains CPUs that don't fit in \a mask
+ * \sa     miniargv_cpuset
+ */
+DLL_EXPORT_MINIARGV int miniargv_cpuset_get_mask (const miniargv_cpuset* cpuset, void* mask, size_t masksize);
+
+/*! \brief get CPU to run a thread of a thread pool on, spreading the threads evenly across the set
+ *
+ * If there are fewer threads than CPUs the CPUs used are spaced out (e.g. 4 threads on CPUs 0-15 use CPUs 0, 4, 8 and 12),
+ * otherwise the CPUs are assigned in a round-robin fashion.
+ * \param  cpuset                set of CPUs
+ * \param  thread                index of thread in thread pool (starting at 0)
+ * \param  numthreads            number of threads in thread pool (0 for round-robin assignment)
+ * \return CPU number or -1 if the set is empty
+ * \sa     miniargv_cpuset
+ * \sa     miniargv_cpuset_pin()
+ */
+DLL_EXPORT_MINIARGV int miniargv_cpuset_spread (const miniargv_cpuset* cpuset, int thread, int numthreads);
+
+/*! \brief pin the calling thread to the CPU returned by miniargv_cpuset_spread()
+ * \param  cpuset                set of CPUs
+ * \param  thread                index of thread in thread pool (starting at 0)
+ * \param  numthreads            number of threads in thread pool (0 for round-robin assignment)
+ * \return 0 on success or non-zero on error (e.g. if the set is empty or if not supported on this platform)
+ * \sa     miniargv_cpuset
+ * \sa     miniargv_cpuset_spread()
+ */
+DLL_EXPORT_MINIARGV int miniargv_cpuset_pin (const miniargv_cpuset* cpuset, int thread, int numthreads);
+
 
 
 /*! \brief predefined bash shell completion callback function that does nothing
@@ -770,6 +1631,41 @@ DLL_EXPORT_MINIARGV int miniargv_complete_cb_file (char *argv[], char* env[], co
  */
 DLL_EXPORT_MINIARGV int miniargv_complete_cb_folder (char *argv[], char* env[], const miniargv_definition* argdef, const miniargv_definition envdef[], const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata);
 
+/*! \cond PRIVATE */
+#ifdef MINIARGV_NO_COMPLETION
+//library built without completion functions, definitions referencing them still compile but have no completion function
+#define miniargv_complete_cb_noop NULL
+#define miniargv_complete_cb_env NULL
+#define miniargv_complete_cb_file NULL
+#define miniargv_complete_cb_folder NULL
+#endif
+/*! \endcond */
+
+/*! \brief build a sorted dictionary file for use with miniargv_complete_dict() from a text file with one entry per line
+ *
+ * Empty lines and duplicate entries are skipped. The dictionary is written via a temporary file, so it can be rebuilt while it is in use.
+ * \param  srcfile               path of text file with one entry per line (in any order)
+ * \param  dictfile              path of dictionary file to write
+ * \return 0 on success or non-zero on error
+ * \sa     miniargv_complete_dict()
+ */
+DLL_EXPORT_MINIARGV int miniargv_dict_build (const char* srcfile, const char* dictfile);
+
+/*! \brief list bash shell completion candidates from a sorted dictionary file built with miniargv_dict_build()
+ *
+ * The dictionary is mapped in memory and the range of entries starting with the parameter is found with a binary search,
+ * so completion time doesn't depend on the size of the dictionary and nothing is parsed.
+ * This is meant to be called from a \a completefn callback function.
+ * \param  dictfile              path of dictionary file
+ * \param  arg                   already available part of command line argument being completed
+ * \param  argparampos           position in \a arg where the parameter to be completed starts
+ * \param  maxresults            maximum number of candidates to list, or 0 for no limit
+ * \return number of candidates listed, or -1 if the dictionary file could not be read
+ * \sa     miniargv_dict_build()
+ * \sa     miniargv_complete_fn
+ */
+DLL_EXPORT_MINIARGV int miniargv_complete_dict (const char* dictfile, const char* arg, int argparampos, size_t maxresults);
+
 
 
 /*! \brief get miniargv library version string
@@ -810,11 +1706,11 @@ DLL_EXPORT_MINIARGV const char* miniargv_get_version_string ();
  * @{
  */
 /*! \brief major version number \hideinitializer */
-#define MINIARGV_VERSION_MAJOR 1
+#define MINIARGV_VERSION_MAJOR 2
 /*! \brief minor version number \hideinitializer */
 #define MINIARGV_VERSION_MINOR 0
 /*! \brief micro version number \hideinitializer */
-#define MINIARGV_VERSION_MICRO 1
+#define MINIARGV_VERSION_MICRO 0
 /** @} */
 
 /*! \brief packed version number (bits 24-31: major version, bits 16-23: minor version, bits 8-15: micro version)
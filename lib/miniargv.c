@@ -1,21 +1,13 @@
-#include "miniargv.h"
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
-#include <limits.h>
-#include <dirent.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <unistd.h>
-#ifdef _WIN32
-#include <io.h>
-#include <fcntl.h>
+#include "miniargv_internal.h"
+#if !defined(_WIN32) && !defined(MINIARGV_NO_THREADS)
+#include <pthread.h>
 #endif
-#if defined(_MSC_VER) || (defined(__MINGW32__) && !defined(__MINGW64__))
-#define strcasecmp _stricmp
+#ifdef MINIARGV_WEAK_REFERENCES
+//values of these callback functions only need to be handled if they are linked
+#pragma weak miniargv_cb_set_blob
+#pragma weak miniargv_cb_set_array
+#pragma weak miniargv_cb_set_cpuset
 #endif
-//extern char** environ;
 
 #define MINIARG_PROCESS_MASK_FLAGS      0x01
 #define MINIARG_PROCESS_MASK_VALUES     0x02
@@ -23,17 +15,468 @@
 #define MINIARG_PROCESS_MASK_FIND_ONLY  0x08
 #define MINIARG_PROCESS_MASK_FIND_VALUE (MINIARG_PROCESS_MASK_FIND_ONLY | MINIARG_PROCESS_MASK_VALUES)
 
+/* contents of file specified as value for argument definition with MINIARGV_FLAG_FILE_VALUE */
+struct miniargv_file_value_struct {
+  const miniargv_definition* argdef;
+  char* data;
+  size_t length;
+  size_t mappedsize;                //size of memory mapping or 0 if data was allocated
+  struct miniargv_file_value_struct* next;
+};
+
+//initial size of buffer used to read file values that can't be mapped in memory
+#define MINIARGV_FILE_VALUE_BLOCK_SIZE 4096
+
+/* list of file values that are kept until miniargv_cleanup() is called */
+static struct miniargv_file_value_struct* miniargv_file_values = NULL;
+static int miniargv_file_values_lock = 0;
+
+static void miniargv_file_values_acquire ()
+{
+  int expected = 0;
+  while (!MINIARGV_ATOMIC_CAS(&miniargv_file_values_lock, &expected, 1)) {
+    expected = 0;
+    MINIARGV_YIELD();
+  }
+}
+
+static void miniargv_file_values_release ()
+{
+  MINIARGV_ATOMIC_STORE(&miniargv_file_values_lock, 0);
+}
+
+/* read remaining data from file descriptor in memory, returns NULL on error */
+static char* miniargv_file_value_read (int fd, size_t* length)
+{
+  char* data = NULL;
+  char* newdata;
+  size_t datasize = 0;
+  int datalen;
+  (*length) = 0;
+  do {
+    //allocate more memory (always leave room for terminating NUL character)
+    if (*length + 1 >= datasize) {
+      datasize = (datasize ? datasize * 2 : MINIARGV_FILE_VALUE_BLOCK_SIZE);
+      if ((newdata = (char*)realloc(data, datasize)) == NULL) {
+        free(data);
+        return NULL;
+      }
+      data = newdata;
+    }
+    if ((datalen = read(fd, data + *length, datasize - *length - 1)) < 0) {
+      free(data);
+      return NULL;
+    }
+    (*length) += datalen;
+  } while (datalen > 0);
+  data[*length] = 0;
+  return data;
+}
+
+/* load file specified as value, returns NULL on error */
+static struct miniargv_file_value_struct* miniargv_file_value_load (const miniargv_definition* argdef, const char* path)
+{
+  int fd;
+  struct miniargv_file_value_struct* filevalue;
+#ifndef _WIN32
+  struct stat statbuf;
+  size_t pagesize;
+  void* base;
+#endif
+  if ((filevalue = (struct miniargv_file_value_struct*)malloc(sizeof(struct miniargv_file_value_struct))) == NULL)
+    return NULL;
+  filevalue->argdef = argdef;
+  filevalue->data = NULL;
+  filevalue->length = 0;
+  filevalue->mappedsize = 0;
+#ifdef _WIN32
+  if ((fd = open(path, O_RDONLY | O_BINARY)) == -1) {
+#else
+  if ((fd = open(path, O_RDONLY)) == -1) {
+#endif
+    free(filevalue);
+    return NULL;
+  }
+#ifndef _WIN32
+  if (fstat(fd, &statbuf) == 0 && S_ISREG(statbuf.st_mode)) {
+    //reserve zero-filled memory of at least 1 byte more than the file size and map the file over it, so the contents are always followed by a NUL character
+    pagesize = sysconf(_SC_PAGESIZE);
+    filevalue->length = statbuf.st_size;
+    filevalue->mappedsize = (filevalue->length + pagesize) / pagesize * pagesize;
+    if ((base = mmap(NULL, filevalue->mappedsize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) != MAP_FAILED) {
+      if (filevalue->length == 0 || mmap(base, filevalue->length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED)
+        filevalue->data = (char*)base;
+      else
+        munmap(base, filevalue->mappedsize);
+    }
+    if (!filevalue->data)
+      filevalue->mappedsize = 0;
+  }
+#endif
+  //read file in memory if it wasn't mapped
+  if (!filevalue->data && (filevalue->data = miniargv_file_value_read(fd, &filevalue->length)) == NULL) {
+    close(fd);
+    free(filevalue);
+    return NULL;
+  }
+  close(fd);
+  //add to list of file values
+  miniargv_file_values_acquire();
+  filevalue->next = miniargv_file_values;
+  miniargv_file_values = filevalue;
+  miniargv_file_values_release();
+  return filevalue;
+}
+
+/* release all file values for argument definition */
+static void miniargv_file_value_free (const miniargv_definition* argdef)
+{
+  struct miniargv_file_value_struct** p;
+  struct miniargv_file_value_struct* filevalue;
+  miniargv_file_values_acquire();
+  p = &miniargv_file_values;
+  while ((filevalue = *p) != NULL) {
+    if (filevalue->argdef == argdef) {
+      *p = filevalue->next;
+#ifndef _WIN32
+      if (filevalue->mappedsize)
+        munmap(filevalue->data, filevalue->mappedsize);
+      else
+#endif
+        free(filevalue->data);
+      free(filevalue);
+    } else {
+      p = &filevalue->next;
+    }
+  }
+  miniargv_file_values_release();
+}
+
+DLL_EXPORT_MINIARGV int miniargv_get_file_value (const char* value, size_t* length)
+{
+  struct miniargv_file_value_struct* filevalue;
+  miniargv_file_values_acquire();
+  filevalue = miniargv_file_values;
+  while (filevalue && filevalue->data != value)
+    filevalue = filevalue->next;
+  if (filevalue && length)
+    *length = filevalue->length;
+  miniargv_file_values_release();
+  return (filevalue ? 1 : 0);
+}
+
+/* call callback function for definition (built-in ones with an opcode are run directly, see miniargv_callback_opcode()), firing the callback entry and return probes around it */
+static int miniargv_invoke_callback (const miniargv_definition* argdef, unsigned char opcode, const char* value, void* callbackdata)
+{
+  int result = 0;
+  MINIARGV_PROBE2(callback__entry, argdef->longarg, value);
+  switch (opcode) {
+    case MINIARGV_OPCODE_SET_CONST_STR :
+      MINIARGV_CB_SET_CONST_STR(argdef, value);
+      break;
+    case MINIARGV_OPCODE_STRDUP :
+      result = miniargv_cb_strdup(argdef, value, callbackdata);
+      break;
+    case MINIARGV_OPCODE_SET_BOOLEAN :
+      result = miniargv_cb_set_boolean(argdef, value, callbackdata);
+      break;
+    case MINIARGV_OPCODE_SET_INT :
+      result = miniargv_cb_set_int(argdef, value, callbackdata);
+      break;
+    case MINIARGV_OPCODE_SET_INT_TO_ZERO :
+      MINIARGV_CB_SET_INT_TO(argdef, 0);
+      break;
+    case MINIARGV_OPCODE_SET_INT_TO_ONE :
+      MINIARGV_CB_SET_INT_TO(argdef, 1);
+      break;
+    case MINIARGV_OPCODE_SET_INT_TO_MINUS_ONE :
+      MINIARGV_CB_SET_INT_TO(argdef, -1);
+      break;
+    case MINIARGV_OPCODE_INCREMENT_INT :
+      MINIARGV_CB_INCREMENT_INT(argdef);
+      break;
+    case MINIARGV_OPCODE_DECREMENT_INT :
+      MINIARGV_CB_DECREMENT_INT(argdef);
+      break;
+    case MINIARGV_OPCODE_SET_LONG :
+      result = miniargv_cb_set_long(argdef, value, callbackdata);
+      break;
+    case MINIARGV_OPCODE_NOOP :
+      break;
+    default :
+      result = (argdef->callbackfn)(argdef, value, callbackdata);
+      break;
+  }
+  MINIARGV_PROBE2(callback__return, argdef->longarg, result);
+  return result;
+}
+
+/* call callback function for argument definition, or defer it if it is marked as safe to run in parallel */
+int miniargv_call_handler (struct miniargv_parse_state_struct* state, const miniargv_definition* argdef, unsigned char opcode, const char* value, void* callbackdata, int index)
+{
+  struct miniargv_deferred_list_struct* deferred;
+  struct miniargv_deferred_struct* item;
+  MINIARGV_PROBE4(match, (state ? state->source : NULL), index, argdef->longarg, argdef->shortarg);
+  if (!state || (argdef->flags & MINIARGV_FLAG_PARALLEL) == 0)
+    return miniargv_invoke_callback(argdef, opcode, value, callbackdata);
+  //add to list of deferred callback invocations
+  deferred = &state->deferred;
+  if (deferred->count >= deferred->size) {
+    if ((item = (struct miniargv_deferred_struct*)realloc(deferred->items, (deferred->size ? deferred->size * 2 : 8) * sizeof(struct miniargv_deferred_struct))) == NULL)
+      return 1;
+    deferred->items = item;
+    deferred->size = (deferred->size ? deferred->size * 2 : 8);
+  }
+  item = &deferred->items[deferred->count];
+  item->ownvalue = 0;
+  if (!value || ((argdef->flags & MINIARGV_FLAG_FILE_VALUE) != 0 && miniargv_get_file_value(value, NULL))) {
+    //file values are kept until miniargv_cleanup() is called, so no copy is needed
+    item->value = (char*)value;
+  } else {
+    if ((item->value = strdup(value)) == NULL)
+      return 1;
+    item->ownvalue = 1;
+  }
+  item->argdef = argdef;
+  item->opcode = opcode;
+  item->callbackdata = callbackdata;
+  item->index = index;
+  item->result = 0;
+  deferred->count++;
+  return 0;
+}
+
+/* call callback function for command line argument value, replacing @path with the contents of the file for definitions with MINIARGV_FLAG_FILE_VALUE */
+static int miniargv_call_arg_handler (struct miniargv_parse_state_struct* state, const miniargv_definition* argdef, unsigned char opcode, const char* value, void* callbackdata, int index)
+{
+  struct miniargv_file_value_struct* filevalue;
+  if (value && value[0] == '@' && (argdef->flags & MINIARGV_FLAG_FILE_VALUE) != 0) {
+    if (value[1] == '@')
+      value++;
+    else if ((filevalue = miniargv_file_value_load(argdef, value + 1)) != NULL)
+      value = filevalue->data;
+    else
+      return 1;
+  }
+  return miniargv_call_handler(state, argdef, opcode, value, callbackdata, index);
+}
+
+/* worker running deferred callback invocations until none are left */
+static void miniargv_deferred_worker (struct miniargv_deferred_list_struct* deferred)
+{
+  int i;
+  struct miniargv_deferred_struct* item;
+  while ((i = MINIARGV_ATOMIC_FETCH_ADD(&deferred->next, 1)) < deferred->count) {
+    item = &deferred->items[i];
+    item->result = miniargv_invoke_callback(item->argdef, item->opcode, item->value, item->callbackdata);
+  }
+}
+
+#ifndef MINIARGV_NO_THREADS
+#ifdef _WIN32
+static DWORD WINAPI miniargv_deferred_thread (LPVOID data)
+{
+  miniargv_deferred_worker((struct miniargv_deferred_list_struct*)data);
+  return 0;
+}
+#else
+static void* miniargv_deferred_thread (void* data)
+{
+  miniargv_deferred_worker((struct miniargv_deferred_list_struct*)data);
+  return NULL;
+}
+#endif
+#endif
+
+//minimum and maximum number of threads used to run deferred callback invocations (callbacks are often waiting for I/O, so use more threads than processors)
+#define MINIARGV_MIN_THREADS 4
+#define MINIARGV_MAX_THREADS 64
+
+/* run deferred callback invocations on a pool of threads and wait for all of them to finish */
+void miniargv_deferred_run (struct miniargv_deferred_list_struct* deferred)
+{
+#ifndef MINIARGV_NO_THREADS
+  int i;
+  int numthreads;
+#ifdef _WIN32
+  SYSTEM_INFO sysinfo;
+  HANDLE threads[MINIARGV_MAX_THREADS];
+  GetSystemInfo(&sysinfo);
+  numthreads = sysinfo.dwNumberOfProcessors;
+#else
+  pthread_t threads[MINIARGV_MAX_THREADS];
+  numthreads = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if (numthreads < MINIARGV_MIN_THREADS)
+    numthreads = MINIARGV_MIN_THREADS;
+  if (numthreads > deferred->count)
+    numthreads = deferred->count;
+  if (numthreads > MINIARGV_MAX_THREADS)
+    numthreads = MINIARGV_MAX_THREADS;
+  //start additional threads (the current thread is also used as a worker)
+  for (i = 0; i < numthreads - 1; i++) {
+#ifdef _WIN32
+    if ((threads[i] = CreateThread(NULL, 0, miniargv_deferred_thread, deferred, 0, NULL)) == NULL)
+      break;
+#else
+    if (pthread_create(&threads[i], NULL, miniargv_deferred_thread, deferred) != 0)
+      break;
+#endif
+  }
+  numthreads = i;
+  miniargv_deferred_worker(deferred);
+  //wait for all threads to finish
+  for (i = 0; i < numthreads; i++) {
+#ifdef _WIN32
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+#else
+    pthread_join(threads[i], NULL);
+#endif
+  }
+#else
+  miniargv_deferred_worker(deferred);
+#endif
+}
+
+/* free list of deferred callback invocations */
+void miniargv_deferred_free (struct miniargv_deferred_list_struct* deferred)
+{
+  int i;
+  for (i = 0; i < deferred->count; i++)
+    if (deferred->items[i].ownvalue)
+      free(deferred->items[i].value);
+  free(deferred->items);
+  deferred->items = NULL;
+  deferred->count = 0;
+  deferred->size = 0;
+}
+
+/* remember where "--" was found by miniargv_get_next_arg_param() so subsequent calls don't have to look for it again */
+static MINIARGV_THREAD_LOCAL char** miniargv_terminator_argv = NULL;
+static MINIARGV_THREAD_LOCAL int miniargv_terminator_index = 0;
+
+/* find definition with long argument that takes a value (for a long argument given with a value that has another definition without value first, like --help and --help=TERM), returns NULL if not found */
+static const miniargv_definition* miniargv_scan_longarg_with_value (const char* longarg, const miniargv_definition argdef[])
+{
+  const miniargv_definition* result;
+  const miniargv_definition* current_argdef = argdef;
+  while (current_argdef->callbackfn) {
+    if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+      if ((result = miniargv_scan_longarg_with_value(longarg, (struct miniargv_definition_struct*)(current_argdef->callbackfn))) != NULL)
+        return result;
+    } else if (current_argdef->longarg && current_argdef->argparam && strcmp(longarg, current_argdef->longarg) == 0) {
+      return current_argdef;
+    }
+    current_argdef++;
+  }
+  return NULL;
+}
+
+/* get opcode for callback function, so built-in callback functions can be run without an indirect call */
+static unsigned char miniargv_callback_opcode (miniargv_handler_fn callbackfn)
+{
+  if (callbackfn == miniargv_cb_set_const_str)
+    return MINIARGV_OPCODE_SET_CONST_STR;
+  if (callbackfn == miniargv_cb_strdup)
+    return MINIARGV_OPCODE_STRDUP;
+  if (callbackfn == miniargv_cb_set_boolean)
+    return MINIARGV_OPCODE_SET_BOOLEAN;
+  if (callbackfn == miniargv_cb_set_int)
+    return MINIARGV_OPCODE_SET_INT;
+  if (callbackfn == miniargv_cb_set_int_to_zero)
+    return MINIARGV_OPCODE_SET_INT_TO_ZERO;
+  if (callbackfn == miniargv_cb_set_int_to_one)
+    return MINIARGV_OPCODE_SET_INT_TO_ONE;
+  if (callbackfn == miniargv_cb_set_int_to_minus_one)
+    return MINIARGV_OPCODE_SET_INT_TO_MINUS_ONE;
+  if (callbackfn == miniargv_cb_increment_int)
+    return MINIARGV_OPCODE_INCREMENT_INT;
+  if (callbackfn == miniargv_cb_decrement_int)
+    return MINIARGV_OPCODE_DECREMENT_INT;
+  if (callbackfn == miniargv_cb_set_long)
+    return MINIARGV_OPCODE_SET_LONG;
+  if (callbackfn == miniargv_cb_noop)
+    return MINIARGV_OPCODE_NOOP;
+  return MINIARGV_OPCODE_CALL;
+}
+
+static const miniargv_definition* miniargv_scan_shortarg (char shortarg, const miniargv_definition argdef[]);
+static const miniargv_definition* miniargv_scan_longarg (const char* longarg, size_t longarglen, const miniargv_definition argdef[], int exact);
+static const miniargv_definition* miniargv_scan_standalonearg (const miniargv_definition argdef[]);
+
+/* find short argument and the opcode of its callback function (taken from the lookup index if there is one) */
+static const miniargv_definition* miniargv_lookup_shortarg (char shortarg, const miniargv_definition argdef[], const struct miniargv_index_struct* index, unsigned char* opcode)
+{
+  int i;
+  const miniargv_definition* result;
+  *opcode = MINIARGV_OPCODE_CALL;
+  if (!index || shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+    if ((result = miniargv_scan_shortarg(shortarg, argdef)) != NULL)
+      *opcode = miniargv_callback_opcode(result->callbackfn);
+    return result;
+  }
+  if ((i = index->shortargs[(unsigned char)shortarg]) == 0)
+    return NULL;
+  *opcode = index->entries[i - 1].opcode;
+  return index->entries[i - 1].argdef;
+}
+
+/* find long argument and the opcode of its callback function (matching like miniargv_find_longarg(), with exact matches taken from the lookup index if there is one) */
+const miniargv_definition* miniargv_lookup_longarg (const char* longarg, size_t longarglen, const miniargv_definition argdef[], const struct miniargv_index_struct* index, unsigned char* opcode)
+{
+  int i;
+  const miniargv_definition* result;
+  if (longarglen > 0 && index) {
+    if ((i = miniargv_index_find_longarg_position(index, longarg, longarglen)) > 0) {
+      *opcode = index->entries[i - 1].opcode;
+      return index->entries[i - 1].argdef;
+    }
+    //no exact match, so look for an abbreviation
+    result = miniargv_scan_longarg(longarg, longarglen, argdef, 0);
+  } else if (longarglen <= 0 && (longarglen = strlen(longarg)) == 0) {
+    return NULL;
+  } else if ((result = miniargv_scan_longarg(longarg, longarglen, argdef, 1)) == NULL) {
+    result = miniargv_scan_longarg(longarg, longarglen, argdef, 0);
+  }
+  if (result)
+    *opcode = miniargv_callback_opcode(result->callbackfn);
+  return result;
+}
+
+/* find standalone value argument and the opcode of its callback function (taken from the lookup index if there is one) */
+static const miniargv_definition* miniargv_lookup_standalonearg (const miniargv_definition argdef[], const struct miniargv_index_struct* index, unsigned char* opcode)
+{
+  const miniargv_definition* result;
+  if (index) {
+    if (!index->standalonearg)
+      return NULL;
+    *opcode = index->entries[index->standalonearg - 1].opcode;
+    return index->entries[index->standalonearg - 1].argdef;
+  }
+  if ((result = miniargv_scan_standalonearg(argdef)) != NULL)
+    *opcode = miniargv_callback_opcode(result->callbackfn);
+  return result;
+}
+
 /* process single command line argument, returns non-zero if argument was processed */
-int miniargv_process_partial_single_arg (int* index, int* success, unsigned int flags, char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata)
+int miniargv_process_partial_single_arg (int* index, int* success, unsigned int flags, char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata, struct miniargv_parse_state_struct* state)
 {
   size_t l;
   const char* arg;
   const miniargv_definition* current_argdef;
+  const miniargv_definition* valuedef;
+  unsigned char opcode = MINIARGV_OPCODE_CALL;
   (*success) = 0;
-  if (argv[*index][0] == '-' && argv[*index][1]) {
+  if (argv[*index][0] == '-' && argv[*index][1] == '-' && argv[*index][2] == 0) {
+    //end of options marker
+    state->terminator = *index;
+    (*success)++;
+    return 4;
+  } else if (argv[*index][0] == '-' && argv[*index][1]) {
     if (argv[*index][1] != '-') {
       //find short argument in argument definitions
-      if ((current_argdef = miniargv_find_shortarg(argv[*index][1], argdef)) != NULL) {
+      if ((current_argdef = miniargv_lookup_shortarg(argv[*index][1], argdef, state->index, &opcode)) != NULL) {
         if (!current_argdef->argparam) {
           //without value
           if (argv[*index][2] == 0) {
@@ -51,7 +494,7 @@ int miniargv_process_partial_single_arg (int* index, int* success, unsigned int
             } else
             //process flag by calling callback function
             if ((flags & MINIARG_PROCESS_MASK_FLAGS) != 0) {
-              if ((current_argdef->callbackfn)(current_argdef, NULL, callbackdata) == 0)
+              if (miniargv_call_handler(state, current_argdef, opcode, NULL, callbackdata, *index) == 0)
                 (*success)++;
             } else {
               (*success)++;
@@ -73,7 +516,7 @@ int miniargv_process_partial_single_arg (int* index, int* success, unsigned int
           } else
           //process flag by calling callback function
           if ((flags & MINIARG_PROCESS_MASK_FLAGS) != 0) {
-            if ((current_argdef->callbackfn)(current_argdef, argv[*index] + 2, callbackdata) == 0)
+            if (miniargv_call_arg_handler(state, current_argdef, opcode, argv[*index] + 2, callbackdata, *index) == 0)
               (*success)++;
           } else {
             (*success)++;
@@ -95,7 +538,7 @@ int miniargv_process_partial_single_arg (int* index, int* success, unsigned int
           } else
           //process flag by calling callback function
           if ((flags & MINIARG_PROCESS_MASK_FLAGS) != 0) {
-            if ((current_argdef->callbackfn)(current_argdef, argv[*index], callbackdata) == 0)
+            if (miniargv_call_arg_handler(state, current_argdef, opcode, argv[*index], callbackdata, *index) == 0)
               (*success)++;
           } else {
             (*success)++;
@@ -109,7 +552,12 @@ int miniargv_process_partial_single_arg (int* index, int* success, unsigned int
       arg = argv[*index] + 2;
       while (arg[l] && arg[l] != '=')
         l++;
-      if ((current_argdef = miniargv_find_longarg(arg, l, argdef)) != NULL) {
+      if ((current_argdef = miniargv_lookup_longarg(arg, l, argdef, state->index, &opcode)) != NULL) {
+        //use a later definition with the same name if a value was given for one without value
+        if (!current_argdef->argparam && arg[l] == '=' && (valuedef = miniargv_scan_longarg_with_value(current_argdef->longarg, argdef)) != NULL) {
+          current_argdef = valuedef;
+          opcode = miniargv_callback_opcode(current_argdef->callbackfn);
+        }
         if (!current_argdef->argparam) {
           //without value
           if (arg[l] == 0) {
@@ -127,7 +575,7 @@ int miniargv_process_partial_single_arg (int* index, int* success, unsigned int
             } else
             //process flag by calling callback function
             if ((flags & MINIARG_PROCESS_MASK_FLAGS) != 0) {
-              if ((current_argdef->callbackfn)(current_argdef, NULL, callbackdata) == 0)
+              if (miniargv_call_handler(state, current_argdef, opcode, NULL, callbackdata, *index) == 0)
                 (*success)++;
             } else {
               (*success)++;
@@ -149,7 +597,7 @@ int miniargv_process_partial_single_arg (int* index, int* success, unsigned int
           } else
           //process flag by calling callback function
           if ((flags & MINIARG_PROCESS_MASK_FLAGS) != 0) {
-            if ((current_argdef->callbackfn)(current_argdef, argv[*index] + 3 + l, callbackdata) == 0)
+            if (miniargv_call_arg_handler(state, current_argdef, opcode, argv[*index] + 3 + l, callbackdata, *index) == 0)
               (*success)++;
           } else {
             (*success)++;
@@ -171,7 +619,7 @@ int miniargv_process_partial_single_arg (int* index, int* success, unsigned int
           } else
           //process flag by calling callback function
           if ((flags & MINIARG_PROCESS_MASK_FLAGS) != 0) {
-            if ((current_argdef->callbackfn)(current_argdef, argv[*index], callbackdata) == 0)
+            if (miniargv_call_arg_handler(state, current_argdef, opcode, argv[*index], callbackdata, *index) == 0)
               (*success)++;
           } else {
             (*success)++;
@@ -182,7 +630,7 @@ int miniargv_process_partial_single_arg (int* index, int* success, unsigned int
     }
   } else {
     //standalone value argument
-    if ((current_argdef = miniargv_find_standalonearg(argdef)) != NULL) {
+    if ((current_argdef = miniargv_lookup_standalonearg(argdef, state->index, &opcode)) != NULL) {
       //standalone value argument definition found
       (*success)++;
       if (current_argdef->callbackfn) {
@@ -200,7 +648,7 @@ int miniargv_process_partial_single_arg (int* index, int* success, unsigned int
         } else
         //process standalone value argument by calling callback function
         if ((flags & MINIARG_PROCESS_MASK_VALUES) != 0) {
-          if ((current_argdef->callbackfn)(current_argdef, argv[*index], callbackdata) == 0)
+          if (miniargv_call_arg_handler(state, current_argdef, opcode, argv[*index], callbackdata, *index) == 0)
             (*success)++;
         } else {
           (*success)++;
@@ -212,19 +660,103 @@ int miniargv_process_partial_single_arg (int* index, int* success, unsigned int
   return 0;
 }
 
-/* partially process argv */
-int miniargv_process_partial (unsigned int flags, char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata)
+/* report bad argument, returns 0 to continue or index of argument that caused processing to abort */
+static int miniargv_process_bad_arg (int index, char* argv[], miniargv_handler_fn badfn, void* callbackdata)
+{
+  if (badfn)
+    return ((badfn)(NULL, argv[index], callbackdata) == 0 ? 0 : index);
+  fprintf(stderr, "Invalid command line argument: %s\n", argv[index]);
+  return index;
+}
+
+/* copy next word of command line (removing quotes and backslashes the way the shell does), returns end of word or NULL if the word is not followed by a space before end */
+const char* miniargv_next_word (const char* p, const char* end, char* word)
+{
+  char quote = 0;
+  for (; p < end; p++) {
+    if (quote) {
+      if (*p == quote)
+        quote = 0;
+      else if (*p == '\\' && quote == '"' && p + 1 < end && (p[1] == '"' || p[1] == '\\' || p[1] == '$' || p[1] == '`'))
+        *word++ = *++p;
+      else
+        *word++ = *p;
+    } else if (*p == '\'' || *p == '"') {
+      quote = *p;
+    } else if (*p == '\\' && p + 1 < end) {
+      *word++ = *++p;
+    } else if (isspace((unsigned char)*p)) {
+      *word = 0;
+      return p;
+    } else {
+      *word++ = *p;
+    }
+  }
+  *word = 0;
+  return NULL;
+}
+
+/* process all standalone value arguments following "--" without looking them up */
+static int miniargv_process_partial_operands (unsigned int flags, int index, char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata, struct miniargv_parse_state_struct* state)
+{
+  int count;
+  int result;
+  const miniargv_definition* current_argdef;
+  unsigned char opcode = MINIARGV_OPCODE_CALL;
+  if ((flags & MINIARG_PROCESS_MASK_VALUES) == 0 || !argv[index])
+    return 0;
+  current_argdef = miniargv_lookup_standalonearg(argdef, state->index, &opcode);
+  //if only looking for standalone value argument return index
+  if ((flags & MINIARG_PROCESS_MASK_FIND_ONLY) != 0) {
+    if (!current_argdef)
+      return 0;
+    miniargv_terminator_argv = argv;
+    miniargv_terminator_index = index - 1;
+    return index;
+  }
+  //report all arguments as bad if there is no standalone value argument definition
+  if (!current_argdef) {
+    for (; argv[index]; index++) {
+      if ((result = miniargv_process_bad_arg(index, argv, badfn, callbackdata)) != 0)
+        return result;
+    }
+    return 0;
+  }
+  //pass all remaining arguments in one call
+  if (current_argdef->bulkfn) {
+    count = 0;
+    while (argv[index + count])
+      count++;
+    return ((current_argdef->bulkfn)(current_argdef, count, argv + index, callbackdata) == 0 ? 0 : index);
+  }
+  //pass remaining arguments one by one
+  for (; argv[index]; index++) {
+    if (miniargv_call_handler(state, current_argdef, opcode, argv[index], callbackdata, index) != 0) {
+      if ((result = miniargv_process_bad_arg(index, argv, badfn, callbackdata)) != 0)
+        return result;
+    }
+  }
+  return 0;
+}
+
+/* partially process argv using existing state */
+static int miniargv_process_partial_state (unsigned int flags, char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata, struct miniargv_parse_state_struct* state)
 {
   int i;
   int success;
+  const miniargv_definition* suggestion;
   for (i = ((flags & MINIARG_PROCESS_MASK_FIND_ONLY) == 0 ? 1 : *(int*)callbackdata + 1); argv[i]; i++) {
-    miniargv_process_partial_single_arg(&i, &success, flags, argv, argdef, badfn, callbackdata);
+    miniargv_process_partial_single_arg(&i, &success, flags, argv, argdef, badfn, callbackdata, state);
+    if (state->terminator) {
+      //no more options after "--"
+      return miniargv_process_partial_operands(flags, i + 1, argv, argdef, badfn, callbackdata, state);
+    }
     if (success && (flags & MINIARG_PROCESS_MASK_FIND_ONLY) != 0) {
       return i;
     }
     if (!success && badfn) {
-      //bad argument
-      if (badfn && (badfn)(NULL, argv[i], callbackdata) == 0)
+      //bad argument (badfn can use miniargv_suggest() to find the argument that was most likely meant)
+      if ((badfn)(NULL, argv[i], callbackdata) == 0)
         success++;
       else if ((flags & MINIARG_PROCESS_MASK_FIND_ONLY) != 0)
         return -1;
@@ -234,23 +766,161 @@ int miniargv_process_partial (unsigned int flags, char* argv[], const miniargv_d
     if (!success) {
       if ((flags & MINIARG_PROCESS_MASK_FIND_ONLY) != 0)
         continue;
-      fprintf(stderr, "Invalid command line argument: %s\n", argv[i]);
+      //look for the long argument that was most likely meant
+      suggestion = NULL;
+      if (argv[i][0] == '-')
+        miniargv_suggest(argv[i], argdef, &suggestion, 1);
+      if (suggestion)
+        fprintf(stderr, "Invalid command line argument: %s (did you mean --%s?)\n", argv[i], suggestion->longarg);
+      else
+        fprintf(stderr, "Invalid command line argument: %s\n", argv[i]);
       return i;
     }
   }
   return 0;
 }
 
+/* partially process arguments from options environment variable (if not NULL) followed by argv, returns minus the index of a bad argument in options */
+static int miniargv_process_partial_options (unsigned int flags, char* options[], char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata)
+{
+  int i;
+  int result = 0;
+  int optionsdeferred = 0;
+  struct miniargv_parse_state_struct state = {0};
+  //look up the definitions in the same index for all arguments
+  miniargv_cache_enter();
+  state.index = miniargv_index_get(argdef);
+  //process options as if they were at the start of argv (sharing the same state, so "--" in options makes all of argv standalone values)
+  if (options) {
+    state.source = "options";
+    result = -miniargv_process_partial_state(flags, options, argdef, badfn, callbackdata, &state);
+    optionsdeferred = state.deferred.count;
+  }
+  state.source = "arg";
+  if (result == 0)
+    result = (state.terminator ? miniargv_process_partial_operands(flags, 1, argv, argdef, badfn, callbackdata, &state) : miniargv_process_partial_state(flags, argv, argdef, badfn, callbackdata, &state));
+  if (state.deferred.count > 0) {
+    //run deferred callback invocations and report the ones that failed (in the order they were encountered)
+    if (result == 0) {
+      miniargv_deferred_run(&state.deferred);
+      for (i = 0; i < state.deferred.count && result == 0; i++) {
+        if (state.deferred.items[i].result != 0)
+          result = (i < optionsdeferred ? -miniargv_process_bad_arg(state.deferred.items[i].index, options, badfn, callbackdata) : miniargv_process_bad_arg(state.deferred.items[i].index, argv, badfn, callbackdata));
+      }
+    }
+    miniargv_deferred_free(&state.deferred);
+  }
+  miniargv_cache_leave();
+  return result;
+}
+
+/* partially process argv */
+int miniargv_process_partial (unsigned int flags, char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata)
+{
+  return miniargv_process_partial_options(flags, NULL, argv, argdef, badfn, callbackdata);
+}
+
+/* words split from an options environment variable, kept until miniargv_cleanup() is called for the definitions or words are split for them again */
+struct miniargv_options_words_struct {
+  const miniargv_definition* argdef;
+  char** words;                     //NULL-terminated list followed by the words themselves (allocated in one block)
+  struct miniargv_options_words_struct* next;
+};
+
+/* list of words split for each definition table (protected by the same lock as the file values) */
+static struct miniargv_options_words_struct* miniargv_options_words = NULL;
+
+/* keep words for definitions in place of the ones split for them before, returns non-zero on error */
+static int miniargv_options_words_keep (const miniargv_definition argdef[], char** words)
+{
+  struct miniargv_options_words_struct* entry;
+  char** oldwords = NULL;
+  miniargv_file_values_acquire();
+  for (entry = miniargv_options_words; entry && entry->argdef != argdef; entry = entry->next)
+    ;
+  if (entry) {
+    oldwords = entry->words;
+    entry->words = words;
+  } else if ((entry = (struct miniargv_options_words_struct*)malloc(sizeof(struct miniargv_options_words_struct))) != NULL) {
+    entry->argdef = argdef;
+    entry->words = words;
+    entry->next = miniargv_options_words;
+    miniargv_options_words = entry;
+  }
+  miniargv_file_values_release();
+  free(oldwords);
+  return (entry ? 0 : -1);
+}
+
+/* free words split for definitions */
+static void miniargv_options_words_free (const miniargv_definition argdef[])
+{
+  struct miniargv_options_words_struct** p;
+  struct miniargv_options_words_struct* entry = NULL;
+  miniargv_file_values_acquire();
+  for (p = &miniargv_options_words; *p && (*p)->argdef != argdef; p = &(*p)->next)
+    ;
+  if ((entry = *p) != NULL)
+    *p = entry->next;
+  miniargv_file_values_release();
+  if (entry) {
+    free(entry->words);
+    free(entry);
+  }
+}
+
+/* split value of options environment variable into words the way the shell does, returns NULL-terminated list starting with argv0 (kept until miniargv_cleanup() is called or words are split again for the same definitions) or NULL on error */
+static char** miniargv_options_split (const char* value, char* argv0, const miniargv_definition argdef[])
+{
+  char** words;
+  char* word;
+  const char* p;
+  const char* end;
+  size_t len;
+  size_t maxwords;
+  int count = 0;
+  //allocate the list and the words in one block (words are separated by at least one space and are never longer than in value)
+  len = strlen(value);
+  maxwords = len / 2 + 3;
+  if ((words = (char**)malloc(maxwords * sizeof(char*) + len + 1)) == NULL)
+    return NULL;
+  word = (char*)(words + maxwords);
+  words[count++] = argv0;
+  //split into words using the same tokenizer as completion
+  p = value;
+  end = value + len;
+  for (;;) {
+    while (p < end && isspace((unsigned char)*p))
+      p++;
+    if (p >= end)
+      break;
+    words[count++] = word;
+    p = miniargv_next_word(p, end, word);
+    word += strlen(word) + 1;
+    if (!p)
+      break;
+  }
+  words[count] = NULL;
+  //keep the words available to callbacks
+  if (miniargv_options_words_keep(argdef, words) != 0) {
+    free(words);
+    return NULL;
+  }
+  return words;
+}
+
 DLL_EXPORT_MINIARGV int miniargv_process (char* argv[], char* env[], const miniargv_definition argdef[], const miniargv_definition envdef[], miniargv_handler_fn badfn, void* callbackdata)
 {
   int result = 0;
   if (env)
     result = miniargv_process_env(env, envdef, callbackdata);
-  if (argv) {
-    if (result == 0)
-      result = miniargv_process_partial(MINIARG_PROCESS_MASK_FLAGS, argv, argdef, badfn, callbackdata);
+  if (argv && result == 0) {
+    //both passes are reported as one
+    MINIARGV_PROBE2(parse__start, "arg", MINIARG_PROCESS_MASK_BOTH);
+    result = miniargv_process_partial(MINIARG_PROCESS_MASK_FLAGS, argv, argdef, badfn, callbackdata);
     if (result == 0)
       result = miniargv_process_partial(MINIARG_PROCESS_MASK_VALUES, argv, argdef, badfn, callbackdata);
+    MINIARGV_PROBE2(parse__end, "arg", result);
   }
   return result;
 }
@@ -265,27 +935,64 @@ DLL_EXPORT_MINIARGV int miniargv_process_ltr (char* argv[], char* env[], const m
   return result;
 }
 
+/* process argv for a public function, firing the parse start and end probes */
+static int miniargv_process_partial_probed (unsigned int flags, char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata)
+{
+  int result;
+  MINIARGV_PROBE2(parse__start, "arg", flags);
+  result = miniargv_process_partial(flags, argv, argdef, badfn, callbackdata);
+  MINIARGV_PROBE2(parse__end, "arg", result);
+  return result;
+}
+
 DLL_EXPORT_MINIARGV int miniargv_process_arg (char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata)
 {
-  return miniargv_process_partial(MINIARG_PROCESS_MASK_BOTH, argv, argdef, badfn, callbackdata);
+  return miniargv_process_partial_probed(MINIARG_PROCESS_MASK_BOTH, argv, argdef, badfn, callbackdata);
+}
+
+DLL_EXPORT_MINIARGV int miniargv_process_arg_env_options (char* argv[], char* env[], const char* varname, const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata)
+{
+  int result;
+  char** current_env;
+  char** options = NULL;
+  size_t varnamelen = strlen(varname);
+  //find options environment variable
+  for (current_env = env; current_env && *current_env; current_env++) {
+    if (strncmp(*current_env, varname, varnamelen) == 0 && (*current_env)[varnamelen] == '=') {
+      if ((options = miniargv_options_split(*current_env + varnamelen + 1, argv[0], argdef)) == NULL)
+        return MINIARGV_ERROR_NO_MEMORY;
+      break;
+    }
+  }
+  MINIARGV_PROBE2(parse__start, "arg", MINIARG_PROCESS_MASK_BOTH);
+  result = miniargv_process_partial_options(MINIARG_PROCESS_MASK_BOTH, options, argv, argdef, badfn, callbackdata);
+  MINIARGV_PROBE2(parse__end, "arg", result);
+  return result;
 }
 
 DLL_EXPORT_MINIARGV int miniargv_process_arg_flags (char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata)
 {
-  return miniargv_process_partial(MINIARG_PROCESS_MASK_FLAGS, argv, argdef, badfn, callbackdata);
+  return miniargv_process_partial_probed(MINIARG_PROCESS_MASK_FLAGS, argv, argdef, badfn, callbackdata);
 }
 
 DLL_EXPORT_MINIARGV int miniargv_process_arg_params (char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn, void* callbackdata)
 {
-  return miniargv_process_partial(MINIARG_PROCESS_MASK_VALUES, argv, argdef, badfn, callbackdata);
+  return miniargv_process_partial_probed(MINIARG_PROCESS_MASK_VALUES, argv, argdef, badfn, callbackdata);
 }
 
 DLL_EXPORT_MINIARGV int miniargv_get_next_arg_param (int argindex, char* argv[], const miniargv_definition argdef[], miniargv_handler_fn badfn)
 {
+  //a scan starts at index 0, so forget where "--" was found by a previous scan
+  if (argindex <= 0)
+    miniargv_terminator_argv = NULL;
+  //every argument after "--" is a value argument (unless the list was changed since)
+  if (miniargv_terminator_argv && argv == miniargv_terminator_argv && argindex >= miniargv_terminator_index && strcmp(argv[miniargv_terminator_index], "--") == 0)
+    return (argv[argindex + 1] ? argindex + 1 : 0);
   return miniargv_process_partial(MINIARG_PROCESS_MASK_FIND_VALUE, argv, argdef, badfn, &argindex);
 }
 
-DLL_EXPORT_MINIARGV int miniargv_process_env (char* env[], const miniargv_definition envdef[], void* callbackdata)
+/* process environment variables for definitions (including the ones in included definitions) */
+static int miniargv_process_env_definitions (char* env[], const miniargv_definition envdef[], void* callbackdata)
 {
   char* s;
   char** current_env;
@@ -293,14 +1000,15 @@ DLL_EXPORT_MINIARGV int miniargv_process_env (char* env[], const miniargv_defini
   int result;
   while (current_envdef->callbackfn) {
     if (current_envdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-      if ((result = miniargv_process_env(env, (struct miniargv_definition_struct*)(current_envdef->callbackfn), callbackdata)) != 0)
+      if ((result = miniargv_process_env_definitions(env, (struct miniargv_definition_struct*)(current_envdef->callbackfn), callbackdata)) != 0)
         return result;
     } else if (current_envdef->longarg) {
       current_env = env;
       while (*current_env) {
         if ((s = strchr(*current_env, '=')) != NULL) {
           if (strncmp(*current_env, current_envdef->longarg, s - *current_env) == 0) {
-            if ((result = (current_envdef->callbackfn)(current_envdef, s + 1, callbackdata)) != 0)
+            MINIARGV_PROBE4(match, "env", (int)(current_env - env), current_envdef->longarg, current_envdef->shortarg);
+            if ((result = miniargv_invoke_callback(current_envdef, MINIARGV_OPCODE_CALL, s + 1, callbackdata)) != 0)
               return result;
           }
         }
@@ -312,148 +1020,15 @@ DLL_EXPORT_MINIARGV int miniargv_process_env (char* env[], const miniargv_defini
   return 0;
 }
 
-//initial block size and increment steps for reading/allocating line data
-#define MINIARGV_READLINE_BLOCK_SIZE 128
-
-//read line from file, NULL when no more lines, caller must call free()
-char* miniargv_readline (FILE* src)
+DLL_EXPORT_MINIARGV int miniargv_process_env (char* env[], const miniargv_definition envdef[], void* callbackdata)
 {
-  int datalen;
-  char data[MINIARGV_READLINE_BLOCK_SIZE];
-  int resultlen = 0;
-  char* result = NULL;
-  //read next data
-  while (fgets(data, sizeof(data), src)) {
-    datalen = strlen(data);
-    //allocate memory and store the result
-    result = (char*)realloc(result, resultlen + datalen + 1);
-    memcpy(result + resultlen, data, datalen + 1);
-    resultlen += datalen;
-    //check for line end, if found remove it and return result
-    if (resultlen > 0 && result[resultlen - 1] == '\n') {
-      result[--resultlen] = 0;
-      if (resultlen > 0 && result[resultlen - 1] == '\r')
-        result[--resultlen] = 0;
-      break;
-    }
-  }
+  int result;
+  MINIARGV_PROBE2(parse__start, "env", 0);
+  result = miniargv_process_env_definitions(env, envdef, callbackdata);
+  MINIARGV_PROBE2(parse__end, "env", result);
   return result;
 }
 
-DLL_EXPORT_MINIARGV int miniargv_process_cfgfile (const char* cfgfile, const miniargv_definition cfgdef[], void* callbackdata)
-{
-  FILE* src;
-  char* line;
-  char* p;
-  char* varname;
-  size_t varnamelen;
-  char separator;
-  char* value;
-  const miniargv_definition* current_cfgdef;
-  int status = 0;
-  //open file for reading
-  if ((src = fopen(cfgfile, "rb")) != NULL) {
-    //read lines
-    while (status == 0 && (line = miniargv_readline(src)) != NULL) {
-      varname = line;
-      //skip spaces preceding varname
-      while (*varname && isspace(*varname))
-        varname++;
-      //include specified file if line starts with @
-      if (*varname == '@') {
-        //skip spaces preceding include file
-        varname++;
-        while (*varname && isspace(*varname))
-          varname++;
-        //skip spaces following include file
-        if ((p = strchr(varname, 0)) != NULL) {
-          while (p != varname && isspace(*(p - 1)))
-            p--;
-          *p = 0;
-        }
-        if (*varname)
-          status = miniargv_process_cfgfile(varname, cfgdef, callbackdata);
-      } else if (*varname) {
-        //find starting position of value
-        p = varname;
-        while (*p && *p != '=' && *p != ':' && *p != '@' && *p != '#' && *p != ';')
-          p++;
-        separator = *p;
-        if (separator == '=' || separator == ':' || separator == '@') {
-          value = p + 1;
-          //skip spaces following varname
-          while (p != varname && isspace(*(p - 1)))
-            p--;
-          if (p != varname) {
-            varnamelen = p - varname;
-            //skip spaces preceding value
-            while (*value && isspace(*value))
-              value++;
-            //skip spaces following value
-            if ((p = strchr(value, 0)) != NULL) {
-              while (p != value && isspace(*(p - 1)))
-                p--;
-              *p = 0;
-            }
-            //process variable
-            if ((current_cfgdef = miniargv_find_longarg(varname, varnamelen, cfgdef)) != NULL) {
-              if (separator == '@') {
-                //process contents of another file
-                FILE* valuesrc;
-                int datalen;
-                char data[MINIARGV_READLINE_BLOCK_SIZE];
-                int loadedvaluelen = 0;
-                char* loadedvalue = NULL;
-                if ((valuesrc = fopen(value, "rb")) != NULL) {
-                  //read next data
-                  while ((datalen = fread(data, 1, sizeof(data), valuesrc)) > 0) {
-                    //allocate memory and store the result
-                    if ((loadedvalue = (char*)realloc(loadedvalue, loadedvaluelen + datalen + 1)) == NULL)
-                      break;
-                    memcpy(loadedvalue + loadedvaluelen, data, datalen + 1);
-                    loadedvaluelen += datalen;
-                  }
-                  fclose(valuesrc);
-                  if (loadedvalue) {
-                    loadedvalue[loadedvaluelen] = 0;
-                    status = (current_cfgdef->callbackfn)(current_cfgdef, loadedvalue, callbackdata);
-                    free(loadedvalue);
-                  }
-                }
-              } else {
-                //process variable value
-                status = (current_cfgdef->callbackfn)(current_cfgdef, value, callbackdata);
-              }
-            } else {
-              //variable name not found
-              //printf("Error: unknown variable: %.*s\n", (int)varnamelen, varname);/////
-            }
-          }
-        }
-      }
-      free(line);
-    }
-    fclose(src);
-  }
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV void miniargv_cfgfile_generate (FILE* cfgfile, const miniargv_definition cfgdef[])
-{
-  const miniargv_definition* current_cfgdef = cfgdef;
-  static const char* help_indent = "\n;   ";
-  while (current_cfgdef->callbackfn) {
-    if (current_cfgdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-      miniargv_cfgfile_generate(cfgfile, (struct miniargv_definition_struct*)(current_cfgdef->callbackfn));
-    } else if (current_cfgdef->longarg) {
-      fprintf(cfgfile, "; %s:%s", current_cfgdef->longarg, help_indent);
-      miniargv_wrap_and_indent_text(cfgfile, current_cfgdef->help, 0, 0, 79 - 4, help_indent);
-      fprintf(cfgfile, "\n%s = %s\n\n", current_cfgdef->longarg, (current_cfgdef->argparam ? current_cfgdef->argparam : ""));
-    }
-    current_cfgdef++;
-  }
-}
-
 DLL_EXPORT_MINIARGV const char* miniargv_getprogramname (const char* argv0, int* length)
 {
   int pos;
@@ -487,334 +1062,280 @@ DLL_EXPORT_MINIARGV const char* miniargv_getprogramname (const char* argv0, int*
   return argv0 + pos;
 }
 
-DLL_EXPORT_MINIARGV unsigned int miniargv_arg_list (const miniargv_definition argdef[], int shortonly)
+/* lock-free cache of objects built for definition tables, keyed by table pointer and a hash of the table contents */
+
+//number of slots in the cache (must be a power of 2)
+#define MINIARGV_CACHE_SIZE 64
+
+static struct miniargv_cache_object_struct* volatile miniargv_cache[MINIARGV_CACHE_SIZE];
+
+//placeholder for removed objects so lookups continue probing past them
+static struct miniargv_cache_object_struct miniargv_cache_removed;
+
+//number of threads using cached objects (objects removed from the cache are only freed when there are none)
+static volatile int miniargv_cache_users = 0;
+
+//objects removed from the cache that are waiting to be freed
+static struct miniargv_cache_object_struct* volatile miniargv_cache_retired = NULL;
+
+static unsigned int miniargv_cache_slot (const void* key, int kind)
+{
+  size_t h = (size_t)key;
+  h ^= h >> 17;
+  h *= 0x9E3779B1u;
+  h ^= h >> 13;
+  return (unsigned int)(h + kind) & (MINIARGV_CACHE_SIZE - 1);
+}
+
+/* free objects removed from the cache if no thread can be using them anymore */
+static void miniargv_cache_reclaim ()
 {
-  unsigned int count = 0;
-  const miniargv_definition* current_argdef = argdef;
-  while (current_argdef->callbackfn) {
-    if (count > 0)
-      printf(" ");
-    if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-      //note: if the next command prints nothing and it's the last entry there will be an extra space at the end
-      count += miniargv_arg_list((struct miniargv_definition_struct*)(current_argdef->callbackfn), shortonly);
-    } else {
-      if (current_argdef->shortarg  || current_argdef->longarg) {
-        printf("[");
-        if (current_argdef->shortarg) {
-          printf("-%c", current_argdef->shortarg);
-          if (current_argdef->argparam)
-            printf(" %s", current_argdef->argparam);
-        }
-        if (current_argdef->longarg && !(shortonly && current_argdef->shortarg)) {
-          if (current_argdef->shortarg)
-            printf("|");
-          printf("--%s", current_argdef->longarg);
-          if (current_argdef->argparam)
-            printf("=%s", current_argdef->argparam);
-        }
-        printf("]");
-      } else {
-        printf("%s", (current_argdef->argparam ? current_argdef->argparam : "param"));
-      }
-      count++;
+  struct miniargv_cache_object_struct* object;
+  struct miniargv_cache_object_struct* next;
+  struct miniargv_cache_object_struct* last;
+  //take the list before checking for users, so objects retired later are left for the next check
+  if ((object = (struct miniargv_cache_object_struct*)MINIARGV_ATOMIC_EXCHANGE_PTR(&miniargv_cache_retired, NULL)) == NULL)
+    return;
+  //read-modify-write instead of load, so it is ordered with miniargv_cache_enter() in other threads
+  if (MINIARGV_ATOMIC_FETCH_ADD(&miniargv_cache_users, 0) == 0) {
+    while (object) {
+      next = object->nextretired;
+      (object->freefn)(object);
+      object = next;
     }
-    current_argdef++;
+    return;
   }
-  return count;
+  //still in use, put them back
+  for (last = object; last->nextretired; last = last->nextretired)
+    ;
+  last->nextretired = (struct miniargv_cache_object_struct*)MINIARGV_ATOMIC_LOAD_PTR(&miniargv_cache_retired);
+  while (!MINIARGV_ATOMIC_CAS_PTR(&miniargv_cache_retired, &last->nextretired, object))
+    ;
 }
 
-DLL_EXPORT_MINIARGV unsigned int miniargv_env_list (const miniargv_definition envdef[], int noparam)
+/* free object removed from the cache once no thread can be using it anymore */
+static void miniargv_cache_retire (struct miniargv_cache_object_struct* object)
 {
-  unsigned int count = 0;
-  const miniargv_definition* current_envdef = envdef;
-  while (current_envdef->callbackfn) {
-    if (count > 0)
-      printf(" ");
-    if (current_envdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-      //note: if the next command prints nothing and it's the last entry there will be an extra space at the end
-      count += miniargv_env_list((struct miniargv_definition_struct*)(current_envdef->callbackfn), noparam);
-    } else {
-      if (current_envdef->longarg) {
-        printf("%s", current_envdef->longarg);
-        if (!noparam && current_envdef->argparam)
-          printf("=%s", current_envdef->argparam);
-        count++;
-      }
-    }
-    current_envdef++;
+  object->nextretired = (struct miniargv_cache_object_struct*)MINIARGV_ATOMIC_LOAD_PTR(&miniargv_cache_retired);
+  while (!MINIARGV_ATOMIC_CAS_PTR(&miniargv_cache_retired, &object->nextretired, object))
+    ;
+  miniargv_cache_reclaim();
+}
+
+/* start using cached objects (objects obtained from the cache stay valid until miniargv_cache_leave() is called) */
+void miniargv_cache_enter ()
+{
+  MINIARGV_ATOMIC_FETCH_ADD(&miniargv_cache_users, 1);
+}
+
+/* stop using cached objects */
+void miniargv_cache_leave ()
+{
+  if (MINIARGV_ATOMIC_FETCH_ADD(&miniargv_cache_users, -1) == 1 && MINIARGV_ATOMIC_LOAD_PTR(&miniargv_cache_retired))
+    miniargv_cache_reclaim();
+}
+
+/* find cached object built for a table with the specified hash, returns NULL if not found */
+struct miniargv_cache_object_struct* miniargv_cache_get (const void* key, int kind, uint64_t hash)
+{
+  int i;
+  unsigned int slot;
+  struct miniargv_cache_object_struct* object;
+  slot = miniargv_cache_slot(key, kind);
+  for (i = 0; i < MINIARGV_CACHE_SIZE; i++) {
+    if ((object = (struct miniargv_cache_object_struct*)MINIARGV_ATOMIC_LOAD_PTR(&miniargv_cache[(slot + i) & (MINIARGV_CACHE_SIZE - 1)])) == NULL)
+      break;
+    if (object->key == key && object->kind == kind && object->hash == hash)
+      return object;
   }
-  return count;
+  return NULL;
 }
 
-DLL_EXPORT_MINIARGV void miniargv_arg_help (const miniargv_definition argdef[], int descindent, int wrapwidth)
+/* add object to cache, returns the cached object (which may have been added by another thread) or NULL if it could not be added */
+struct miniargv_cache_object_struct* miniargv_cache_add (struct miniargv_cache_object_struct* object)
 {
-  int pos;
-  const miniargv_definition* current_argdef = argdef;
-  if (!descindent)
-    descindent = 25;
-  while (current_argdef->callbackfn) {
-    if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-      //note: if the next command prints nothing and it's the last entry there will be an extra space at the end
-      miniargv_arg_help((struct miniargv_definition_struct*)(current_argdef->callbackfn), descindent, wrapwidth);
-    } else {
-      pos = printf("  ");
-      if (!current_argdef->shortarg && !current_argdef->longarg) {
-        pos += printf("%s", (current_argdef->argparam ? current_argdef->argparam : "param"));
-      } else {
-        if (current_argdef->shortarg) {
-          pos += printf("-%c", current_argdef->shortarg);
-          if (current_argdef->argparam && !current_argdef->longarg)
-            pos += printf(" %s", current_argdef->argparam);
-        }
-        if (current_argdef->longarg) {
-          if (current_argdef->shortarg)
-            pos += printf(", ");
-          pos += printf("--%s", current_argdef->longarg);
-          if (current_argdef->argparam)
-            pos += printf("=%s", current_argdef->argparam);
-        }
+  int i;
+  unsigned int slot;
+  struct miniargv_cache_object_struct* volatile* current_slot;
+  struct miniargv_cache_object_struct* current;
+  slot = miniargv_cache_slot(object->key, object->kind);
+  for (i = 0; i < MINIARGV_CACHE_SIZE; i++) {
+    current_slot = &miniargv_cache[(slot + i) & (MINIARGV_CACHE_SIZE - 1)];
+    current = (struct miniargv_cache_object_struct*)MINIARGV_ATOMIC_LOAD_PTR(current_slot);
+    for (;;) {
+      if (current && current != &miniargv_cache_removed && (current->key != object->key || current->kind != object->kind)) {
+        //slot used for another table
+        break;
+      } else if (current && current != &miniargv_cache_removed && current->hash == object->hash) {
+        //another thread was first
+        (object->freefn)(object);
+        return current;
+      } else if (MINIARGV_ATOMIC_CAS_PTR(current_slot, &current, object)) {
+        //empty slot, or object built for a table that has changed since or was at the same address before
+        if (current && current != &miniargv_cache_removed)
+          miniargv_cache_retire(current);
+        return object;
       }
-      if (pos > descindent - 2)
-        printf("\n%*s", descindent, "");
-      else
-        printf("%*s", (pos < descindent ? descindent - pos : 2), "");
-      miniargv_wrap_and_indent_text(stdout, current_argdef->help, descindent, descindent, wrapwidth, NULL);
-      printf("\n");
     }
-    current_argdef++;
   }
+  //cache is full, replace the object in the first slot
+  current_slot = &miniargv_cache[slot];
+  current = (struct miniargv_cache_object_struct*)MINIARGV_ATOMIC_LOAD_PTR(current_slot);
+  if (!MINIARGV_ATOMIC_CAS_PTR(current_slot, &current, object)) {
+    (object->freefn)(object);
+    return NULL;
+  }
+  if (current && current != &miniargv_cache_removed)
+    miniargv_cache_retire(current);
+  return object;
 }
 
-DLL_EXPORT_MINIARGV void miniargv_env_help (const miniargv_definition envdef[], int descindent, int wrapwidth)
+/* remove cached objects for key (or all if key is NULL), they are freed once no thread is using them anymore */
+void miniargv_cache_remove (const void* key)
 {
-  int pos;
-  const miniargv_definition* current_envdef = envdef;
-  if (!descindent)
-    descindent = 25;
-  while (current_envdef->callbackfn) {
-    if (current_envdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-      //note: if the next command prints nothing and it's the last entry there will be an extra space at the end
-      miniargv_env_help((struct miniargv_definition_struct*)(current_envdef->callbackfn), descindent, wrapwidth);
-    } else {
-      pos = printf("  ");
-      if (!current_envdef->shortarg && !current_envdef->longarg) {
-        pos += printf(" %s", (current_envdef->argparam ? current_envdef->argparam : "param"));
-      } else {
-        if (current_envdef->longarg) {
-          if (current_envdef->shortarg)
-            pos += printf(", ");
-          pos += printf("%s", current_envdef->longarg);
-          if (current_envdef->argparam)
-            pos += printf("=%s", current_envdef->argparam);
-        }
-      }
-      if (pos > descindent - 2)
-        printf("\n%*s", descindent, "");
-      else
-        printf("%*s", (pos < descindent ? descindent - pos : 2), "");
-      miniargv_wrap_and_indent_text(stdout, current_envdef->help, descindent, descindent, wrapwidth, NULL);
-      printf("\n");
+  int i;
+  struct miniargv_cache_object_struct* current;
+  for (i = 0; i < MINIARGV_CACHE_SIZE; i++) {
+    current = (struct miniargv_cache_object_struct*)MINIARGV_ATOMIC_LOAD_PTR(&miniargv_cache[i]);
+    if (current && current != &miniargv_cache_removed && (!key || current->key == key)) {
+      if (MINIARGV_ATOMIC_CAS_PTR(&miniargv_cache[i], &current, &miniargv_cache_removed))
+        miniargv_cache_retire(current);
     }
-    current_envdef++;
   }
 }
 
-DLL_EXPORT_MINIARGV void miniargv_help (const miniargv_definition argdef[], const miniargv_definition envdef[], int descindent, int wrapwidth)
+/* add data to 64-bit FNV-1a hash */
+uint64_t miniargv_cache_hash (uint64_t hash, const void* data, size_t len)
 {
-  if (argdef) {
-    printf("Command line arguments:\n");
-    miniargv_arg_help(argdef, descindent, wrapwidth);
-  }
-  if (envdef) {
-    printf("Environment variables:\n");
-    miniargv_env_help(envdef, descindent, wrapwidth);
-  }
+  const unsigned char* p = (const unsigned char*)data;
+  while (len-- > 0)
+    hash = (hash ^ *p++) * 0x100000001B3ull;
+  return hash;
 }
 
-/* define COMPLETE_ADD_SPACE if bash completion is configured via "complete -o nospace -C<path> <command>" */
-//#define COMPLETE_ADD_SPACE
+/* hash function for long argument names (FNV-1a) */
+unsigned int miniargv_hash (const char* s, size_t len)
+{
+  unsigned int h = 2166136261u;
+  while (len-- > 0)
+    h = (h ^ (unsigned char)*s++) * 16777619u;
+  return h;
+}
 
-const miniargv_definition* miniargv_complete_arg (char *argv[], char* env[], int index, const miniargv_definition argdef[], const miniargv_definition envdef[], void* callbackdata)
+static void miniargv_index_free (struct miniargv_cache_object_struct* object)
 {
-  char* partialargend;
-  size_t partialarglen;
-  const miniargv_definition* current_argdef;
-  const miniargv_definition* result;
-  const char* partialarg;
-  const char* previousarg;
-  const miniargv_definition* last_argdef = NULL;
-  int multipleresults = 0;
-  if ((partialarg = argv[index]) == NULL || (previousarg = argv[index + 1]) == NULL)
-    return NULL;
-  //on Windows set console output to binary mode (to avoid showing ^M in bash completion output)
-#ifdef _WIN32
-  setmode(fileno(stdout), O_BINARY);
-#endif
-/*
-  //check if previous argument is reported as just the equals sign
-  const char* commandline;
-  if (previousarg[0] == '=' && !previousarg[1]) {
-    //search for argument preceding the the equals sign
-    const char* commandlinepos;
-    int commandlineposval;
-    commandlinepos = getenv("COMP_POINT");
-    commandlineposval = atoi(commandlinepos ? commandlinepos : NULL) - strlen(partialarg);
-    commandline = getenv("COMP_LINE");
-    while (commandlineposval > 0 && (commandline[commandlineposval - 1] == '=' || isspace(commandline[commandlineposval - 1]))) {
-      commandlineposval--;
-    }
-    while (commandlineposval > 0 && !isspace(commandline[commandlineposval - 1])) {
-      commandlineposval--;
-    }
-    previousarg = commandline + commandlineposval;
-  }
-*/
-  //check previous argument
-  if (previousarg && previousarg[0] == '-' && (
-       (previousarg[1] && previousarg[1] != '-' && !previousarg[2] && (current_argdef = miniargv_find_arg(previousarg, argdef)) != NULL) ||
-       (previousarg[1] == '-' && (current_argdef = miniargv_find_arg(previousarg, argdef)) != NULL)
-      )) {
-    if (current_argdef->argparam) {
-      if (current_argdef->completefn) {
-        (current_argdef->completefn)(argv + 1, env, argdef, envdef, current_argdef, partialarg, 0, callbackdata);
+  struct miniargv_index_struct* index = (struct miniargv_index_struct*)object;
+  free(index->entries);
+  free(index->longargs);
+  free(index);
+}
+
+/* add definitions to index entries */
+static int miniargv_index_add_entries (struct miniargv_index_struct* index, const miniargv_definition argdef[], int* size)
+{
+  struct miniargv_index_entry_struct* entries;
+  const miniargv_definition* current_argdef = argdef;
+  while (current_argdef->callbackfn) {
+    if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+      if (miniargv_index_add_entries(index, (struct miniargv_definition_struct*)(current_argdef->callbackfn), size) != 0)
+        return -1;
+    } else {
+      if (index->count >= *size) {
+        *size = (*size ? *size * 2 : 16);
+        if ((entries = (struct miniargv_index_entry_struct*)realloc(index->entries, *size * sizeof(struct miniargv_index_entry_struct))) == NULL)
+          return -1;
+        index->entries = entries;
       }
-      return current_argdef;
+      index->entries[index->count].argdef = current_argdef;
+      index->entries[index->count].longarglen = (current_argdef->longarg ? strlen(current_argdef->longarg) : 0);
+      index->entries[index->count].opcode = miniargv_callback_opcode(current_argdef->callbackfn);
+      index->count++;
     }
+    current_argdef++;
   }
-  //find standalone value argument definition
-  if (!partialarg[0] || partialarg[0] != '-') {
-    if ((current_argdef = miniargv_find_standalonearg(argdef)) != NULL) {
-      if (current_argdef->completefn) {
-        if ((current_argdef->completefn)(argv + 1, env, argdef, envdef, current_argdef, partialarg, 0, callbackdata) != 0)
-          return current_argdef;
-      }
-    }
+  return 0;
+}
+
+/* build lookup index for definition table */
+static struct miniargv_index_struct* miniargv_index_build (const miniargv_definition argdef[])
+{
+  int i;
+  int size = 0;
+  unsigned int slot;
+  struct miniargv_index_struct* index;
+  if ((index = (struct miniargv_index_struct*)calloc(1, sizeof(struct miniargv_index_struct))) == NULL)
+    return NULL;
+  index->header.key = argdef;
+  index->header.kind = MINIARGV_CACHE_KIND_INDEX;
+  index->header.freefn = miniargv_index_free;
+  if (miniargv_index_add_entries(index, argdef, &size) != 0) {
+    miniargv_index_free(&index->header);
+    return NULL;
   }
-  //loop through short argument definitions
-  if (!partialarg[0] || (partialarg[0] == '-' && partialarg[1] != '-')) {
-    current_argdef = argdef;
-    while (current_argdef->callbackfn) {
-      if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-        if ((result = miniargv_complete_arg(argv, env, index, (struct miniargv_definition_struct*)(current_argdef->callbackfn), envdef, callbackdata)) != NULL)
-          return result;
-      } else if (current_argdef->shortarg && (!partialarg[0] || !partialarg[1] || partialarg[1] == current_argdef->shortarg)) {
-        if (current_argdef->argparam && partialarg[0] == '-' && partialarg[1] == current_argdef->shortarg) {
-          if (current_argdef->completefn) {
-            (current_argdef->completefn)(argv + 1, env, argdef, envdef, current_argdef, partialarg, 2, callbackdata);
-          }
-          return current_argdef;
-        }
-#ifdef COMPLETE_ADD_SPACE
-        printf("-%c%s\n", current_argdef->shortarg, (current_argdef->argparam ? "" : " "));
-#else
-        printf("-%c\n", current_argdef->shortarg);
-#endif
-        multipleresults++;
-      }
-      current_argdef++;
-    }
+  //hash table for long arguments, at most half full
+  index->longargmask = 15;
+  while (index->longargmask < (unsigned int)index->count * 2)
+    index->longargmask = index->longargmask * 2 + 1;
+  if ((index->longargs = (int*)calloc(index->longargmask + 1, sizeof(int))) == NULL) {
+    miniargv_index_free(&index->header);
+    return NULL;
   }
-  //loop through long argument definitions
-  if (!partialarg[0] || (partialarg[0] == '-' && (!partialarg[1] || partialarg[1] == '-'))) {
-    //determine length of long argument without value
-#if 0
-    partialargend = strchrnul(partialarg, '=');
-    partialarglen = (partialargend - partialarg);
-#else
-    if ((partialargend = strchr(partialarg, '=')) == NULL)
-      partialarglen = strlen(partialarg);
-    else
-      partialarglen = (partialargend - partialarg);
-#endif
-    //loop through long argument definitions
-    current_argdef = argdef;
-    while (current_argdef->callbackfn) {
-      if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-        if ((result = miniargv_complete_arg(argv, env, index, (struct miniargv_definition_struct*)(current_argdef->callbackfn), envdef, callbackdata)) != NULL)
-          return result;
-      } else if (current_argdef->longarg && (partialarglen < 2 || (strncmp(partialarg + 2, current_argdef->longarg, partialarglen - 2) == 0 && (!partialarg[partialarglen] || partialarg[partialarglen] == '=')))) {
-        if (current_argdef->argparam && partialarg[partialarglen] == '=') {
-          if (current_argdef->completefn) {
-            (current_argdef->completefn)(argv + 1, env, argdef, envdef, current_argdef, partialarg, partialarglen + 1, callbackdata);
-          }
-          return current_argdef;
-        }
-#ifdef COMPLETE_ADD_SPACE
-        printf("--%s%s\n", current_argdef->longarg, (current_argdef->argparam ? "=" : " "));
-#else
-        if (!current_argdef->argparam) {
-          printf("--%s\n", current_argdef->longarg);
-        } else {
-          printf("--%s=\n", current_argdef->longarg);
-        }
-        last_argdef = current_argdef;
-        multipleresults++;
-#endif
-      }
-      current_argdef++;
-    }
-    //if only long argument found display a seperate entry for it so no space is appended on completion
-    if (multipleresults == 1 && last_argdef->argparam) {
-      printf("--%s=%s\n", last_argdef->longarg, last_argdef->argparam);
+  //the first definition wins if there are duplicates
+  for (i = 0; i < index->count; i++) {
+    const miniargv_definition* current_argdef = index->entries[i].argdef;
+    if (current_argdef->shortarg && !index->shortargs[(unsigned char)current_argdef->shortarg])
+      index->shortargs[(unsigned char)current_argdef->shortarg] = i + 1;
+    if (!current_argdef->shortarg && !current_argdef->longarg && !index->standalonearg)
+      index->standalonearg = i + 1;
+    if (current_argdef->longarg) {
+      slot = miniargv_hash(current_argdef->longarg, index->entries[i].longarglen) & index->longargmask;
+      while (index->longargs[slot] && (index->entries[index->longargs[slot] - 1].longarglen != index->entries[i].longarglen || memcmp(index->entries[index->longargs[slot] - 1].argdef->longarg, current_argdef->longarg, index->entries[i].longarglen) != 0))
+        slot = (slot + 1) & index->longargmask;
+      if (!index->longargs[slot])
+        index->longargs[slot] = i + 1;
     }
   }
-  return NULL;
+  return index;
 }
 
-/* when bash completion occurs the program specified via "complete -o nospace -C" is called as follows
-     3 arguments are passed to this application:
-      - the command whose arguments are being completed
-      - the prefix of the word where the cursor is, up to the cursor
-      - the word before the cursor
-     environment variables passed to the application:
-      - COMP_LINE contains the complete line in which completion is performed.
-      - COMP_POINT contains the cursor position inside COMP_LINE (counting from 0).
-      - COMP_TYPE is 9 for normal completion, 33 when listing alternatives on ambiguous completions, 37 for menu completion, 63 when tabbing between ambiguous completions, 64 to list completions after a partial completion.
-      - COMP_KEY contains the key that triggered completion (e.g. a tab character if the user pressed Tab).
-*/
+/* get lookup index for definition table (built on first use and kept until invalidated), returns NULL if it could not be built (only use between miniargv_cache_enter() and miniargv_cache_leave()) */
+const struct miniargv_index_struct* miniargv_index_get (const miniargv_definition argdef[])
+{
+  struct miniargv_index_struct* index;
+  if ((index = (struct miniargv_index_struct*)miniargv_cache_get(argdef, MINIARGV_CACHE_KIND_INDEX, 0)) != NULL)
+    return index;
+  if ((index = miniargv_index_build(argdef)) == NULL)
+    return NULL;
+  return (const struct miniargv_index_struct*)miniargv_cache_add(&index->header);
+}
 
-DLL_EXPORT_MINIARGV int miniargv_completion (char *argv[], char* env[], const miniargv_definition argdef[], const miniargv_definition envdef[], const char* completionparam, void* callbackdata)
+/* find position of long argument in lookup index (exact match), returns position in entries + 1 or 0 if not found */
+int miniargv_index_find_longarg_position (const struct miniargv_index_struct* index, const char* longarg, size_t longarglen)
 {
-  int index = 0;
-  //check if called from bash completion
-  if (completionparam) {
-    //abort if a special parameter was provided and the first argument does not match it or if not enough paremeters
-    if (!argv[0] || !argv[1] || !argv[2] || !argv[3] || !argv[4] || strcmp(argv[1], completionparam) != 0)
-      return 0;
-    index = 3;
-  } else {
-    //abort if no special parameter was provided and the first argument is not the application or if not enough paremeters
-    const char* prg;
-    int prglen;
-    const char* cmd;
-    int cmdlen;
-    if (!argv[0] || !argv[1] || !argv[2] || !argv[3])
-      return 0;
-    prg = miniargv_getprogramname(argv[0], &prglen);
-    cmd = miniargv_getprogramname(argv[1], &cmdlen);
-    if (!prg || !cmd || cmdlen != prglen ||
-#ifdef _WIN32
-        strnicmp(cmd, prg, cmdlen) != 0
-#else
-        strncmp(cmd, prg, cmdlen) != 0
-#endif
-        )
-      return 0;
-    index = 2;
+  int i;
+  unsigned int slot;
+  slot = miniargv_hash(longarg, longarglen) & index->longargmask;
+  while ((i = index->longargs[slot]) != 0) {
+    if (index->entries[i - 1].longarglen == longarglen && memcmp(index->entries[i - 1].argdef->longarg, longarg, longarglen) == 0)
+      return i;
+    slot = (slot + 1) & index->longargmask;
   }
-  miniargv_complete_arg(argv, env, index, argdef, envdef, callbackdata);
-  return 1;
+  return 0;
 }
 
-DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_shortarg (char shortarg, const miniargv_definition argdef[])
+DLL_EXPORT_MINIARGV void miniargv_index_invalidate (const miniargv_definition argdef[])
+{
+  miniargv_cache_remove(argdef);
+}
+
+/* find first definition with the specified short argument by going through the table */
+static const miniargv_definition* miniargv_scan_shortarg (char shortarg, const miniargv_definition argdef[])
 {
   const miniargv_definition* result;
   const miniargv_definition* current_argdef = argdef;
-  if (!shortarg || !current_argdef)
-    return NULL;
   while (current_argdef->callbackfn) {
     if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-      if ((result = miniargv_find_shortarg(shortarg, (struct miniargv_definition_struct*)(current_argdef->callbackfn))) != NULL)
+      if ((result = miniargv_scan_shortarg(shortarg, (struct miniargv_definition_struct*)(current_argdef->callbackfn))) != NULL)
         return result;
     } else if (shortarg == current_argdef->shortarg) {
       return current_argdef;
@@ -824,20 +1345,17 @@ DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_shortarg (char shor
   return NULL;
 }
 
-DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_longarg (const char* longarg, size_t longarglen, const miniargv_definition argdef[])
+/* find first long argument with exactly the specified name (exact != 0) or starting with it (exact == 0) by going through the table */
+static const miniargv_definition* miniargv_scan_longarg (const char* longarg, size_t longarglen, const miniargv_definition argdef[], int exact)
 {
   const miniargv_definition* result;
   const miniargv_definition* current_argdef = argdef;
-  if (!longarg || !current_argdef)
-    return NULL;
-  if (longarglen <= 0)
-    longarglen = strlen(longarg);
   while (current_argdef->callbackfn) {
     if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-      if ((result = miniargv_find_longarg(longarg, longarglen, (struct miniargv_definition_struct*)(current_argdef->callbackfn))) != NULL)
+      if ((result = miniargv_scan_longarg(longarg, longarglen, (struct miniargv_definition_struct*)(current_argdef->callbackfn), exact)) != NULL)
         return result;
     } else if (current_argdef->longarg) {
-      if (strncmp(longarg, current_argdef->longarg, longarglen) == 0) {
+      if (strncmp(longarg, current_argdef->longarg, longarglen) == 0 && (!exact || current_argdef->longarg[longarglen] == 0)) {
         return current_argdef;
       }
     }
@@ -846,13 +1364,14 @@ DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_longarg (const char
   return NULL;
 }
 
-DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_standalonearg (const miniargv_definition argdef[])
+/* find first standalone value argument by going through the table */
+static const miniargv_definition* miniargv_scan_standalonearg (const miniargv_definition argdef[])
 {
   const miniargv_definition* result;
   const miniargv_definition* current_argdef = argdef;
   while (current_argdef->callbackfn) {
     if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-      if ((result = miniargv_find_standalonearg((struct miniargv_definition_struct*)(current_argdef->callbackfn))) != NULL)
+      if ((result = miniargv_scan_standalonearg((struct miniargv_definition_struct*)(current_argdef->callbackfn))) != NULL)
         return result;
     } else if (!current_argdef->shortarg && !current_argdef->longarg) {
       return current_argdef;
@@ -862,111 +1381,90 @@ DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_standalonearg (cons
   return NULL;
 }
 
-DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_arg (const char* arg, const miniargv_definition argdef[])
+/* find long argument with exactly the specified name (without looking for abbreviations) */
+const miniargv_definition* miniargv_find_longarg_exact (const char* longarg, size_t longarglen, const miniargv_definition argdef[])
 {
-  char* argend;
-  size_t arglen;
-  const miniargv_definition* current_argdef;
+  int i;
+  const struct miniargv_index_struct* index;
+  const miniargv_definition* result;
+  if (!longarg || !argdef || longarglen == 0)
+    return NULL;
+  miniargv_cache_enter();
+  if ((index = miniargv_index_get(argdef)) == NULL)
+    result = miniargv_scan_longarg(longarg, longarglen, argdef, 1);
+  else
+    result = ((i = miniargv_index_find_longarg_position(index, longarg, longarglen)) > 0 ? index->entries[i - 1].argdef : NULL);
+  miniargv_cache_leave();
+  return result;
+}
+
+DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_shortarg (char shortarg, const miniargv_definition argdef[])
+{
+  int i;
+  const struct miniargv_index_struct* index;
+  const miniargv_definition* result;
+  if (!shortarg || !argdef)
+    return NULL;
+  miniargv_cache_enter();
+  if (shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG || (index = miniargv_index_get(argdef)) == NULL)
+    result = miniargv_scan_shortarg(shortarg, argdef);
+  else
+    result = ((i = index->shortargs[(unsigned char)shortarg]) > 0 ? index->entries[i - 1].argdef : NULL);
+  miniargv_cache_leave();
+  return result;
+}
+
+DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_longarg (const char* longarg, size_t longarglen, const miniargv_definition argdef[])
+{
+  const miniargv_definition* result;
+  if (!longarg || !argdef)
+    return NULL;
+  if (longarglen <= 0 && (longarglen = strlen(longarg)) == 0)
+    return NULL;
+  //prefer an exact match over an earlier definition starting with the same text
+  if ((result = miniargv_find_longarg_exact(longarg, longarglen, argdef)) != NULL)
+    return result;
+  return miniargv_scan_longarg(longarg, longarglen, argdef, 0);
+}
+
+DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_standalonearg (const miniargv_definition argdef[])
+{
+  const struct miniargv_index_struct* index;
   const miniargv_definition* result;
+  if (!argdef)
+    return NULL;
+  miniargv_cache_enter();
+  if ((index = miniargv_index_get(argdef)) == NULL)
+    result = miniargv_scan_standalonearg(argdef);
+  else
+    result = (index->standalonearg > 0 ? index->entries[index->standalonearg - 1].argdef : NULL);
+  miniargv_cache_leave();
+  return result;
+}
+
+DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_find_arg (const char* arg, const miniargv_definition argdef[])
+{
+  const char* argend;
   if (!arg || arg[0] != '-')
     return NULL;
-  current_argdef = argdef;
   if (arg[1] != '-') {
-    //not a valid short argument not hyphen followed by only one character
+    //not a valid short argument if hyphen is not followed by only one character
     if (!arg[1] || arg[2])
       return NULL;
-    //loop through short arguments
-    while (current_argdef->callbackfn) {
-      if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-        if ((result = miniargv_find_arg(arg, (struct miniargv_definition_struct*)(current_argdef->callbackfn))) != NULL)
-          return result;
-      } else if (current_argdef->shortarg && arg[1] == current_argdef->shortarg) {
-        return current_argdef;
-      }
-      current_argdef++;
-    }
-  } else {
-    //not a valid long argument if the 2 hyphens are not followed by any text
-    if (!arg[2])
-      return NULL;
-    //determine length of long argument without value
-#if 0
-    argend = strchrnul(arg + 2, '=');
-    arglen = (argend - arg);
-#else
-    if ((argend = strchr(arg + 2, '=')) == NULL)
-      arglen = strlen(arg);
-    else
-      arglen = (argend - arg);
-#endif
-    //loop through long arguments
-    while (current_argdef->callbackfn) {
-      if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
-        if ((result = miniargv_find_arg(arg, (struct miniargv_definition_struct*)(current_argdef->callbackfn))) != NULL)
-          return result;
-      } else if (current_argdef->longarg && strncmp(arg + 2, current_argdef->longarg, arglen - 2) == 0 && arglen - 2 == strlen(current_argdef->longarg)) {
-        return current_argdef;
-      }
-      current_argdef++;
-    }
-  }
-  return NULL;
-}
-
-DLL_EXPORT_MINIARGV void miniargv_wrap_and_indent_text (FILE* dst, const char* text, int currentpos, int indentpos, int wrapwidth, const char* newline)
-{
-  const char* p;
-  const char* q;
-  const char* r;
-  //set default wrap with if not specified
-  if (!wrapwidth)
-    wrapwidth = 79;
-  p = text;
-  //process text
-  while (p) {
-    q = p;
-    r = p;
-    //find wrap position
-    do {
-      //find first blank space
-      while (*r && !isspace(*r))
-        r++;
-      //check if wrap position was exceeded
-      if (currentpos + (r - p) > wrapwidth) {
-        //if single word exceeds maximum width show it as a whole anyway
-        if (q == p)
-          q = r;
-        break;
-      }
-      q = r;
-      //wrap if line break was found
-      if (*r == '\n')
-        break;
-      //skip blank space
-      while (*r && isspace(*r))
-        r++;
-    } while (*r);
-    //print line
-    if (!*q) {
-      //print as a whole if last section of text
-      fprintf(dst, "%s", p);
-      p = NULL;
-    } else {
-      //print partial text, go to new line and indent
-      fprintf(dst, "%.*s%s%*s", (int)(q - p), p, (newline ? newline : "\n"), indentpos, "");
-      currentpos = indentpos;
-      //skip blank space
-      p = q;
-      while (isspace(*p))
-        p++;
-    }
+    return miniargv_find_shortarg(arg[1], argdef);
   }
+  //long argument without value must match exactly
+  if ((argend = strchr(arg + 2, '=')) == NULL)
+    argend = arg + strlen(arg);
+  return miniargv_find_longarg_exact(arg + 2, argend - (arg + 2), argdef);
 }
 
 DLL_EXPORT_MINIARGV int miniargv_cleanup (const miniargv_definition argdef[])
 {
   const miniargv_definition* current_argdef = argdef;
   int result;
+  //release words split from options environment variable by miniargv_process_arg_env_options()
+  miniargv_options_words_free(argdef);
   while (current_argdef->callbackfn) {
     if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
       if ((result = miniargv_cleanup((struct miniargv_definition_struct*)(current_argdef->callbackfn))) != 0)
@@ -976,324 +1474,40 @@ DLL_EXPORT_MINIARGV int miniargv_cleanup (const miniargv_definition argdef[])
         free(*(char**)current_argdef->userdata);
         *(char**)current_argdef->userdata = NULL;
       }
+    } else if (current_argdef->callbackfn == miniargv_cb_lazy) {
+      miniargv_lazy* lazy = (miniargv_lazy*)current_argdef->userdata;
+      free(lazy->value);
+      lazy->value = NULL;
+      lazy->argdef = NULL;
+      lazy->state = MINIARGV_LAZY_STATE_UNSET;
+    } else if (current_argdef->callbackfn == miniargv_cb_set_blob) {
+      miniargv_blob* blob = (miniargv_blob*)current_argdef->userdata;
+      free(blob->data);
+      blob->data = NULL;
+      blob->length = 0;
+      blob->size = 0;
+    } else if (current_argdef->callbackfn == miniargv_cb_set_array) {
+      miniargv_array* array = (miniargv_array*)current_argdef->userdata;
+      free(array->data);
+      array->data = NULL;
+      array->count = 0;
+      array->size = 0;
+    } else if (current_argdef->callbackfn == miniargv_cb_set_cpuset) {
+      miniargv_cpuset* cpuset = (miniargv_cpuset*)current_argdef->userdata;
+      free(cpuset->mask);
+      free(cpuset->cpus);
+      cpuset->mask = NULL;
+      cpuset->masksize = 0;
+      cpuset->cpus = NULL;
+      cpuset->count = 0;
     }
+    if ((current_argdef->flags & MINIARGV_FLAG_FILE_VALUE) != 0)
+      miniargv_file_value_free(current_argdef);
     current_argdef++;
   }
   return 0;
 }
 
-
-
-DLL_EXPORT_MINIARGV int miniargv_cb_set_const_str (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  *(const char**)argdef->userdata = value;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_strdup (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  if (*(char**)argdef->userdata)
-    free(*(char**)argdef->userdata);
-  *(char**)argdef->userdata = (value ? strdup(value) : NULL);
-  return 0;
-}
-
-#define BOOLEAN_VALUES_LISTS_ENTRIES 6
-static const char* boolean_values_lists[2][BOOLEAN_VALUES_LISTS_ENTRIES] = {
-  {"0", "no",  "off", "false", "disable", "disabled"},
-  {"1", "yes", "on",  "true",  "enable",  "enabled"}
-};
-
-DLL_EXPORT_MINIARGV int miniargv_cb_set_boolean (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  int i;
-  int j;
-  if (!value)
-    return 1;
-  if (!*value)
-    return 0;
-  for (i = 0; i < 2; i++) {
-    for (j = 0; j < BOOLEAN_VALUES_LISTS_ENTRIES; j++) {
-      if (strcasecmp(value, boolean_values_lists[i][j]) == 0) {
-        *(int*)argdef->userdata = i;
-        return 0;
-      }
-    }
-  }
-  i = 0;
-  while (value[i]) {
-    if (!isspace(value[i])) {
-      //not an acceptable value, empty or whitespace
-      return 2;
-    }
-    i++;
-  }
-  *(int*)argdef->userdata = 0;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_set_int (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  long intval;
-  char* end = NULL;
-  if (!value || !*value)
-    return 1;
-  intval = strtol(value, &end, 10);
-  if (!end || *end)
-    return 2;
-  if (intval == LONG_MIN)
-    return 3;
-  if (intval == LONG_MAX)
-    return 4;
-  *(int*)argdef->userdata = (int)intval;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_set_int_to_zero (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  *(int*)argdef->userdata = 0;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_set_int_to_one (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  *(int*)argdef->userdata = 1;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_set_int_to_minus_one (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  *(int*)argdef->userdata = -1;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_increment_int (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  (*((int*)argdef->userdata))++;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_decrement_int (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  (*((int*)argdef->userdata))--;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_set_long (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  long intval;
-  char* end = NULL;
-  if (!value || !*value)
-    return 1;
-  intval = strtol(value, &end, 10);
-  if (!end || *end)
-    return 2;
-  if (intval == LONG_MIN)
-    return 3;
-  if (intval == LONG_MAX)
-    return 4;
-  *(long*)argdef->userdata = intval;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_set_long_to_zero (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  *(long*)argdef->userdata = 0;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_set_long_to_one (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  *(long*)argdef->userdata = 1;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_set_long_to_minus_one (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  *(long*)argdef->userdata = -1;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_increment_long (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  (*((long*)argdef->userdata))--;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_decrement_long (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  (*((long*)argdef->userdata))++;
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_noop (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_cb_error (const miniargv_definition* argdef, const char* value, void* callbackdata)
-{
-  if (argdef->userdata)
-    fprintf(stderr, "%s\n", (const char*)argdef->userdata);
-  return -1;
-}
-
-
-
-DLL_EXPORT_MINIARGV int miniargv_complete_cb_noop (char *argv[], char* env[], const miniargv_definition* argdef, const miniargv_definition envdef[], const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata)
-{
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_complete_cb_env (char *argv[], char* env[], const miniargv_definition* argdef, const miniargv_definition envdef[], const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata)
-{
-  size_t pos;
-  size_t len;
-  char** currentenv;
-  char* p;
-  //get environment variable name from argument (starting at the end)
-  pos = strlen(arg);
-  len = 0;
-  while (pos > argparampos && arg[pos - 1] != '$') {
-    pos--;
-    len++;
-  }
-  //abort if dollar sign not found
-  if (pos <= argparampos || arg[pos - 1] != '$')
-    return 0;
-  //loop through environment variables
-  currentenv = env;
-  while (*currentenv) {
-    if (strncmp(*currentenv, arg + pos, len) == 0) {
-      if ((p = strchr(*currentenv, '=')) != NULL) {
-        printf("%.*s%.*s\n", (int)pos, arg, (int)(p - *currentenv), *currentenv);
-      }
-    }
-    currentenv++;
-  }
-  return 0;
-}
-
-int miniargv_complete_file_or_folder (char *argv[], const miniargv_definition* argdef, const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata, int hidefiles)
-{
-  DIR* dir;
-  struct dirent* direntry;
-  struct stat fileinfo;
-  char* path;
-  size_t pathlen;
-  char* filepath;
-  size_t filepathlen;
-  size_t len;
-  size_t pos;
-  size_t direntrylen;
-  char* lastdirpath = NULL;
-  int multipleresults = 0;
-  //get folder path from argument
-  pos = strlen(arg);
-  len = 0;
-  while (pos > argparampos && arg[pos - 1] != '/'
-#ifdef _WIN32
-         && arg[pos - 1] != '\\' && arg[pos - 1] != ':'
-#endif
-  ) {
-    pos--;
-    len++;
-  }
-  pathlen = pos - argparampos;
-  if ((path = (char*)malloc(pathlen + 2)) == NULL) {
-    fprintf(stderr, "memory allocation error\n");
-    return 1;
-  }
-  memcpy(path, arg + argparampos, pathlen);
-/*
-  if (pathlen > 0 && path[pathlen - 1] != '/'
-#ifdef _WIN32
-      && path[pathlen - 1] != '\\'
-#endif
-  ) {
-    path[pathlen++] = '/';
-  }
-*/
-  path[pathlen] = 0;
-  //create placeholder for full file path
-  filepathlen = pathlen;
-  if ((filepath = (char*)malloc(filepathlen + 1)) == NULL) {
-    fprintf(stderr, "memory allocation error\n");
-    return 1;
-  }
-  memcpy(filepath, path, pathlen);
-  //check directory entries
-  if ((dir = opendir(*path ? path : "./")) != NULL) {
-    while ((direntry = readdir(dir)) != NULL) {
-      //only show matches and skip "." (current folder) and ".." (parent folder)
-      if (
-#ifdef _WIN32
-          strnicmp(direntry->d_name, arg + pos, len) == 0
-#else
-          strncmp(direntry->d_name, arg + pos, len) == 0
-#endif
-          && (!*path || (strcmp(direntry->d_name, ".") != 0 && strcmp(direntry->d_name, "..") != 0))
-      ) {
-        //determine full path
-        direntrylen = strlen(direntry->d_name);
-        if (filepathlen < pathlen + direntrylen) {
-          filepathlen = pathlen + direntrylen;
-          if ((filepath = (char*)realloc(filepath, filepathlen + 1)) == NULL) {
-            fprintf(stderr, "memory allocation error\n");
-            return 1;
-          }
-        }
-        strcpy(filepath + pathlen, direntry->d_name);
-        //get file/folder attributes
-        stat(filepath, &fileinfo);
-        //show result as needed
-        if (!S_ISDIR(fileinfo.st_mode)) {
-          if (!hidefiles)
-            printf("%.*s%s\n", argparampos, arg, filepath);
-        } else {
-          printf("%.*s%s/\n", argparampos, arg, filepath);
-          if (!lastdirpath)
-            lastdirpath = strdup(filepath);
-        }
-        if (multipleresults < 2) {
-          multipleresults++;
-        } else if (lastdirpath) {
-          free(lastdirpath);
-          lastdirpath = NULL;
-        }
-      }
-    }
-    closedir(dir);
-  }
-  //if only one result and it is a directory entry repeat it with "/." appended to avoid adding a space on completion
-  if (lastdirpath) {
-    if (multipleresults == 1)
-      printf("%.*s%s/.\n", argparampos, arg, lastdirpath);
-    free(lastdirpath);
-  }
-  free(filepath);
-  free(path);
-  return 0;
-}
-
-DLL_EXPORT_MINIARGV int miniargv_complete_cb_file (char *argv[], char* env[], const miniargv_definition* argdef, const miniargv_definition envdef[], const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata)
-{
-  int result;
-  if ((result = miniargv_complete_cb_env(argv, env, argdef, envdef, currentarg, arg, argparampos, callbackdata)) != 0)
-    return result;
-  return miniargv_complete_file_or_folder(argv, argdef, currentarg, arg, argparampos, callbackdata, 0);
-}
-
-DLL_EXPORT_MINIARGV int miniargv_complete_cb_folder (char *argv[], char* env[], const miniargv_definition* argdef, const miniargv_definition envdef[], const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata)
-{
-  int result;
-  if ((result = miniargv_complete_cb_env(argv, env, argdef, envdef, currentarg, arg, argparampos, callbackdata)) != 0)
-    return result;
-  return miniargv_complete_file_or_folder(argv, argdef, currentarg, arg, argparampos, callbackdata, 1);
-}
-
-
-
 DLL_EXPORT_MINIARGV void miniargv_get_version (int* pmajor, int* pminor, int* pmicro)
 {
   if (pmajor)
@@ -1308,4 +1522,3 @@ DLL_EXPORT_MINIARGV const char* miniargv_get_version_string ()
 {
   return MINIARGV_VERSION_STRING;
 }
-
@@ -0,0 +1,135 @@
+#include "miniargv_internal.h"
+
+/* hash table of applets in a multi-call binary */
+
+struct miniargv_applet_index_struct {
+  struct miniargv_cache_object_struct header;
+  int count;                                      //number of applets
+  size_t* namelens;                               //length of name of each applet
+  unsigned int mask;                              //size of slots - 1
+  int* slots;                                     //hash table with position in applets + 1 for each name, 0 for empty slots
+};
+
+/* hash function for applet names (case insensitive on Windows) */
+static unsigned int miniargv_applet_hash (const char* s, size_t len)
+{
+#ifdef _WIN32
+  unsigned int h = 2166136261u;
+  while (len-- > 0)
+    h = (h ^ (unsigned char)tolower(*s++)) * 16777619u;
+  return h;
+#else
+  return miniargv_hash(s, len);
+#endif
+}
+
+/* compare applet names (case insensitive on Windows) */
+static int miniargv_applet_name_compare (const char* name1, const char* name2, size_t len)
+{
+#ifdef _WIN32
+  return strnicmp(name1, name2, len);
+#else
+  return memcmp(name1, name2, len);
+#endif
+}
+
+static void miniargv_applet_index_free (struct miniargv_cache_object_struct* object)
+{
+  struct miniargv_applet_index_struct* index = (struct miniargv_applet_index_struct*)object;
+  free(index->namelens);
+  free(index->slots);
+  free(index);
+}
+
+/* build hash table for applet table */
+static struct miniargv_applet_index_struct* miniargv_applet_index_build (const miniargv_applet applets[])
+{
+  int i;
+  unsigned int slot;
+  struct miniargv_applet_index_struct* index;
+  if ((index = (struct miniargv_applet_index_struct*)calloc(1, sizeof(struct miniargv_applet_index_struct))) == NULL)
+    return NULL;
+  index->header.key = applets;
+  index->header.kind = MINIARGV_CACHE_KIND_APPLETS;
+  index->header.freefn = miniargv_applet_index_free;
+  while (applets[index->count].name)
+    index->count++;
+  //hash table, at most half full
+  index->mask = 15;
+  while (index->mask < (unsigned int)index->count * 2)
+    index->mask = index->mask * 2 + 1;
+  if ((index->namelens = (size_t*)malloc((index->count + 1) * sizeof(size_t))) == NULL || (index->slots = (int*)calloc(index->mask + 1, sizeof(int))) == NULL) {
+    miniargv_applet_index_free(&index->header);
+    return NULL;
+  }
+  //the first applet wins if there are duplicates
+  for (i = 0; i < index->count; i++) {
+    index->namelens[i] = strlen(applets[i].name);
+    slot = miniargv_applet_hash(applets[i].name, index->namelens[i]) & index->mask;
+    while (index->slots[slot] && (index->namelens[index->slots[slot] - 1] != index->namelens[i] || miniargv_applet_name_compare(applets[index->slots[slot] - 1].name, applets[i].name, index->namelens[i]) != 0))
+      slot = (slot + 1) & index->mask;
+    if (!index->slots[slot])
+      index->slots[slot] = i + 1;
+  }
+  return index;
+}
+
+DLL_EXPORT_MINIARGV const miniargv_applet* miniargv_find_applet (const char* name, size_t namelen, const miniargv_applet applets[])
+{
+  int i;
+  unsigned int slot;
+  struct miniargv_applet_index_struct* index;
+  const miniargv_applet* result;
+  if (!name)
+    return NULL;
+  //get hash table (built on first use and kept until invalidated)
+  miniargv_cache_enter();
+  if ((index = (struct miniargv_applet_index_struct*)miniargv_cache_get(applets, MINIARGV_CACHE_KIND_APPLETS, 0)) == NULL && (index = miniargv_applet_index_build(applets)) != NULL)
+    index = (struct miniargv_applet_index_struct*)miniargv_cache_add(&index->header);
+  result = NULL;
+  if (!index) {
+    //look through all applets if the hash table could not be built
+    for (i = 0; applets[i].name && !result; i++) {
+      if (strlen(applets[i].name) == namelen && miniargv_applet_name_compare(applets[i].name, name, namelen) == 0)
+        result = &applets[i];
+    }
+  } else {
+    slot = miniargv_applet_hash(name, namelen) & index->mask;
+    while (!result && (i = index->slots[slot]) != 0) {
+      if (index->namelens[i - 1] == namelen && miniargv_applet_name_compare(applets[i - 1].name, name, namelen) == 0)
+        result = &applets[i - 1];
+      slot = (slot + 1) & index->mask;
+    }
+  }
+  miniargv_cache_leave();
+  return result;
+}
+
+DLL_EXPORT_MINIARGV const miniargv_applet* miniargv_applet_get (char* argv[], const miniargv_applet applets[], int* argindex)
+{
+  const char* prg;
+  int prglen;
+  const miniargv_applet* applet;
+  //check program name (binary invoked via applet name)
+  if ((prg = miniargv_getprogramname(argv[0], &prglen)) != NULL && (applet = miniargv_find_applet(prg, prglen, applets)) != NULL) {
+    if (argindex)
+      *argindex = 0;
+    return applet;
+  }
+  //check first argument (binary invoked with applet name as first argument)
+  if (argv[0] && argv[1] && (applet = miniargv_find_applet(argv[1], strlen(argv[1]), applets)) != NULL) {
+    if (argindex)
+      *argindex = 1;
+    return applet;
+  }
+  return NULL;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_applet_main (int argc, char* argv[], char* env[], const miniargv_applet applets[])
+{
+  int argindex;
+  const miniargv_applet* applet;
+  if ((applet = miniargv_applet_get(argv, applets, &argindex)) == NULL)
+    return MINIARGV_APPLET_NOT_FOUND;
+  return (applet->mainfn)(argc - argindex, argv + argindex, env);
+}
@@ -0,0 +1,227 @@
+#include "miniargv_internal.h"
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_const_str (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  MINIARGV_CB_SET_CONST_STR(argdef, value);
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_strdup (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  if (*(char**)argdef->userdata)
+    free(*(char**)argdef->userdata);
+  *(char**)argdef->userdata = (value ? strdup(value) : NULL);
+  return 0;
+}
+
+#define BOOLEAN_VALUES_LISTS_ENTRIES 6
+static const char* boolean_values_lists[2][BOOLEAN_VALUES_LISTS_ENTRIES] = {
+  {"0", "no",  "off", "false", "disable", "disabled"},
+  {"1", "yes", "on",  "true",  "enable",  "enabled"}
+};
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_boolean (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  int i;
+  int j;
+  if (!value)
+    return 1;
+  if (!*value)
+    return 0;
+  for (i = 0; i < 2; i++) {
+    for (j = 0; j < BOOLEAN_VALUES_LISTS_ENTRIES; j++) {
+      if (strcasecmp(value, boolean_values_lists[i][j]) == 0) {
+        *(int*)argdef->userdata = i;
+        return 0;
+      }
+    }
+  }
+  i = 0;
+  while (value[i]) {
+    if (!isspace(value[i])) {
+      //not an acceptable value, empty or whitespace
+      return 2;
+    }
+    i++;
+  }
+  *(int*)argdef->userdata = 0;
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_int (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  long intval;
+  char* end = NULL;
+  if (!value || !*value)
+    return 1;
+  intval = strtol(value, &end, 10);
+  if (!end || *end)
+    return 2;
+  if (intval == LONG_MIN)
+    return 3;
+  if (intval == LONG_MAX)
+    return 4;
+  *(int*)argdef->userdata = (int)intval;
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_int_to_zero (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  MINIARGV_CB_SET_INT_TO(argdef, 0);
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_int_to_one (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  MINIARGV_CB_SET_INT_TO(argdef, 1);
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_int_to_minus_one (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  MINIARGV_CB_SET_INT_TO(argdef, -1);
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_increment_int (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  MINIARGV_CB_INCREMENT_INT(argdef);
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_decrement_int (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  MINIARGV_CB_DECREMENT_INT(argdef);
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_long (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  long intval;
+  char* end = NULL;
+  if (!value || !*value)
+    return 1;
+  intval = strtol(value, &end, 10);
+  if (!end || *end)
+    return 2;
+  if (intval == LONG_MIN)
+    return 3;
+  if (intval == LONG_MAX)
+    return 4;
+  *(long*)argdef->userdata = intval;
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_long_to_zero (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  *(long*)argdef->userdata = 0;
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_long_to_one (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  *(long*)argdef->userdata = 1;
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_long_to_minus_one (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  *(long*)argdef->userdata = -1;
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_increment_long (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  (*((long*)argdef->userdata))++;
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_decrement_long (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  (*((long*)argdef->userdata))--;
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_noop (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_error (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  if (argdef->userdata)
+    fprintf(stderr, "%s\n", (const char*)argdef->userdata);
+  return -1;
+}
+
+/* call the deferred callback function of a lazily evaluated value */
+static int miniargv_lazy_evaluate (miniargv_lazy* lazy, int hasvalue)
+{
+  miniargv_definition lazy_argdef;
+  miniargv_handler_fn fn;
+  //call the callback function as if it was set in the original definition
+  if (lazy->argdef)
+    lazy_argdef = *lazy->argdef;
+  else
+    memset(&lazy_argdef, 0, sizeof(lazy_argdef));
+  lazy_argdef.userdata = lazy->userdata;
+  if ((fn = (hasvalue ? lazy->callbackfn : lazy->defaultfn)) == NULL)
+    return 0;
+  lazy_argdef.callbackfn = fn;
+  return (fn)(&lazy_argdef, (hasvalue ? lazy->value : NULL), lazy->callbackdata);
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_lazy (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  int state;
+  int result = 0;
+  char* newvalue = NULL;
+  miniargv_lazy* lazy = (miniargv_lazy*)argdef->userdata;
+  if (value && (newvalue = strdup(value)) == NULL)
+    return 1;
+  //wait until the value is not being evaluated by miniargv_lazy_get() in another thread and keep other threads out while replacing it
+  do {
+    while ((state = MINIARGV_ATOMIC_LOAD(&lazy->state)) == MINIARGV_LAZY_STATE_BUSY)
+      MINIARGV_YIELD();
+  } while (!MINIARGV_ATOMIC_CAS(&lazy->state, &state, MINIARGV_LAZY_STATE_BUSY));
+  free(lazy->value);
+  lazy->value = newvalue;
+  lazy->argdef = argdef;
+  lazy->callbackdata = callbackdata;
+  //call the callback function right away if the value was already read
+  if (state == MINIARGV_LAZY_STATE_DONE) {
+    result = lazy->result = miniargv_lazy_evaluate(lazy, 1);
+    MINIARGV_ATOMIC_STORE(&lazy->state, MINIARGV_LAZY_STATE_DONE);
+  } else {
+    MINIARGV_ATOMIC_STORE(&lazy->state, MINIARGV_LAZY_STATE_SET);
+  }
+  return result;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_lazy_get (miniargv_lazy* lazy)
+{
+  int state;
+  while ((state = MINIARGV_ATOMIC_LOAD(&lazy->state)) != MINIARGV_LAZY_STATE_DONE) {
+    if (state == MINIARGV_LAZY_STATE_BUSY) {
+      //wait for the thread evaluating the value
+      MINIARGV_YIELD();
+    } else if (MINIARGV_ATOMIC_CAS(&lazy->state, &state, MINIARGV_LAZY_STATE_BUSY)) {
+      //only the thread that changed the state evaluates the value
+      lazy->result = miniargv_lazy_evaluate(lazy, state == MINIARGV_LAZY_STATE_SET);
+      MINIARGV_ATOMIC_STORE(&lazy->state, MINIARGV_LAZY_STATE_DONE);
+    }
+  }
+  return lazy->result;
+}
+
+/* get value of hexadecimal digit, or -1 if invalid */
+int miniargv_hex_digit (char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
@@ -0,0 +1,158 @@
+#include "miniargv_internal.h"
+
+#ifdef MINIARGV_SWAR
+/* get number of leading decimal digits in 8 characters (first character in lowest byte) */
+static int miniargv_swar_digit_count (uint64_t chars)
+{
+  uint64_t nondigit = ((chars & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL) | (((chars + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL);
+  nondigit = (((nondigit & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | nondigit) & 0x8080808080808080ULL;
+  return (nondigit ? __builtin_ctzll(nondigit) / 8 : 8);
+}
+
+/* get value of 8 digit characters (first character in lowest byte, 0 bytes are treated as leading zeros) */
+static uint64_t miniargv_swar_digits_value (uint64_t chars)
+{
+  chars = ((chars & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+  chars = ((chars & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+  return ((chars & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+}
+
+static const uint64_t miniargv_powers_of_10[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+#endif
+
+/* parse unsigned decimal number, returns number of digits or -1 on overflow */
+static int miniargv_parse_digits (const char* s, const char* end, uint64_t* result)
+{
+  const char* p = s;
+  uint64_t value = 0;
+  unsigned int digit;
+#ifdef MINIARGV_SWAR
+  uint64_t chars;
+  int n;
+  //convert up to 8 digits at a time as long as the result can't overflow (up to 19 digits)
+  while (end - p >= 8) {
+    memcpy(&chars, p, 8);
+    if ((n = miniargv_swar_digit_count(chars)) == 0 || p - s + n > 19)
+      break;
+    value = value * miniargv_powers_of_10[n] + miniargv_swar_digits_value(chars << (8 * (8 - n)));
+    p += n;
+    if (n < 8) {
+      *result = value;
+      return p - s;
+    }
+  }
+#endif
+  while (p < end && (digit = (unsigned char)*p - '0') <= 9) {
+    if (value > (UINT64_MAX - digit) / 10)
+      return -1;
+    value = value * 10 + digit;
+    p++;
+  }
+  *result = value;
+  return p - s;
+}
+
+/* parse number of the specified array type and store it at dst, returns position following it or NULL on error */
+static const char* miniargv_parse_array_element (const char* p, const char* end, int type, void* dst)
+{
+  int negative = 0;
+  int n;
+  uint64_t value;
+  const char* start = p;
+  char* endptr;
+  if (*p == '-' || *p == '+')
+    negative = (*p++ == '-');
+  n = miniargv_parse_digits(p, end, &value);
+  if (type == MINIARGV_ARRAY_DOUBLE) {
+    //only integers that are represented exactly are converted directly
+    if (n <= 0 || n > 15 || (p + n < end && (p[n] == '.' || p[n] == 'e' || p[n] == 'E'))) {
+      *(double*)dst = strtod(start, &endptr);
+      return (endptr == start || endptr > end ? NULL : endptr);
+    }
+    *(double*)dst = (negative ? -(double)value : (double)value);
+    return p + n;
+  }
+  if (n <= 0)
+    return NULL;
+  switch (type) {
+    case MINIARGV_ARRAY_I32 :
+      if (value > (negative ? (uint64_t)INT32_MAX + 1 : (uint64_t)INT32_MAX))
+        return NULL;
+      *(int32_t*)dst = (negative ? (int32_t)(0 - value) : (int32_t)value);
+      break;
+    case MINIARGV_ARRAY_I64 :
+      if (value > (negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX))
+        return NULL;
+      *(int64_t*)dst = (negative ? (int64_t)(0 - value) : (int64_t)value);
+      break;
+    case MINIARGV_ARRAY_U64 :
+      if (negative)
+        return NULL;
+      *(uint64_t*)dst = value;
+      break;
+    default :
+      return NULL;
+  }
+  return p + n;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_array (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  const char* p;
+  const char* end;
+  const char* separator;
+  void* data;
+  size_t newsize;
+  miniargv_array* array = (miniargv_array*)argdef->userdata;
+  size_t elementsize = (array->type == MINIARGV_ARRAY_I32 ? sizeof(int32_t) : sizeof(uint64_t));
+  array->count = 0;
+  if (!value) {
+    free(array->data);
+    array->data = NULL;
+    array->size = 0;
+    return 0;
+  }
+  p = value;
+  end = value + strlen(value);
+  while (p < end && isspace((unsigned char)*p))
+    p++;
+  while (p < end) {
+    //allocate more memory (reused for following values)
+    if ((array->count + 1) * elementsize > array->size) {
+      newsize = (array->size ? array->size * 2 : 64 * elementsize);
+      if ((data = realloc(array->data, newsize)) == NULL) {
+        array->count = 0;
+        return 1;
+      }
+      array->data = data;
+      array->size = newsize;
+    }
+    //parse number
+    if ((p = miniargv_parse_array_element(p, end, array->type, (char*)array->data + array->count * elementsize)) == NULL) {
+      array->count = 0;
+      return 1;
+    }
+    array->count++;
+    //skip separator (comma and/or spaces)
+    if (p + 1 < end && *p == ',' && (unsigned char)(p[1] - '0') <= 9) {
+      p++;
+      continue;
+    }
+    separator = p;
+    while (p < end && isspace((unsigned char)*p))
+      p++;
+    if (p < end && *p == ',') {
+      p++;
+      while (p < end && isspace((unsigned char)*p))
+        p++;
+      if (p == end) {
+        array->count = 0;
+        return 1;
+      }
+    } else if (p == separator && p < end) {
+      array->count = 0;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,192 @@
+#include "miniargv_internal.h"
+
+/* get value of base64 digit (standard or URL-safe alphabet), or -1 if invalid */
+static int miniargv_base64_digit (char c)
+{
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a' + 26;
+  if (c >= '0' && c <= '9')
+    return c - '0' + 52;
+  if (c == '+' || c == '-')
+    return 62;
+  if (c == '/' || c == '_')
+    return 63;
+  return -1;
+}
+
+#ifdef MINIARGV_SSE2
+/* convert 16 hexadecimal digits to their values, lanes with invalid digits are set in invalid */
+static __m128i miniargv_sse2_hex_digits (__m128i chars, __m128i* invalid)
+{
+  __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+  __m128i isdigit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+  __m128i isletter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+  *invalid = _mm_or_si128(*invalid, _mm_cmpeq_epi8(_mm_or_si128(isdigit, isletter), _mm_setzero_si128()));
+  return _mm_or_si128(_mm_and_si128(isdigit, _mm_sub_epi8(chars, _mm_set1_epi8('0'))), _mm_and_si128(isletter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+}
+
+/* combine pairs of hexadecimal digit values into byte values in 16-bit lanes */
+static __m128i miniargv_sse2_hex_pairs (__m128i digits)
+{
+  return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(digits, _mm_set1_epi16(0x00FF)), 4), _mm_srli_epi16(digits, 8));
+}
+
+/* convert 16 base64 digits to their values, lanes with invalid digits are set in invalid */
+static __m128i miniargv_sse2_base64_digits (__m128i chars, __m128i* invalid)
+{
+  __m128i isupper = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('Z' + 1)));
+  __m128i islower = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('z' + 1)));
+  __m128i isdigit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+  __m128i isplus = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('+')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('-')));
+  __m128i isslash = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('/')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')));
+  __m128i offset = _mm_or_si128(_mm_or_si128(_mm_and_si128(isupper, _mm_set1_epi8(-'A')), _mm_and_si128(islower, _mm_set1_epi8(26 - 'a'))), _mm_and_si128(isdigit, _mm_set1_epi8(52 - '0')));
+  __m128i values = _mm_or_si128(_mm_and_si128(_mm_or_si128(_mm_or_si128(isupper, islower), isdigit), _mm_add_epi8(chars, offset)), _mm_or_si128(_mm_and_si128(isplus, _mm_set1_epi8(62)), _mm_and_si128(isslash, _mm_set1_epi8(63))));
+  *invalid = _mm_or_si128(*invalid, _mm_cmpeq_epi8(_mm_or_si128(_mm_or_si128(_mm_or_si128(isupper, islower), _mm_or_si128(isdigit, isplus)), isslash), _mm_setzero_si128()));
+  return values;
+}
+#endif
+
+/* decode hexadecimal digits (srclen must be even), returns 0 on success */
+static int miniargv_decode_hex (const char* src, size_t srclen, unsigned char* dst)
+{
+  size_t i = 0;
+  int hi;
+  int lo;
+#ifdef MINIARGV_SSE2
+  __m128i invalid = _mm_setzero_si128();
+  __m128i first;
+  __m128i second;
+  //decode 32 digits into 16 bytes at a time
+  for (; i + 32 <= srclen; i += 32) {
+    first = miniargv_sse2_hex_digits(_mm_loadu_si128((const __m128i*)(src + i)), &invalid);
+    second = miniargv_sse2_hex_digits(_mm_loadu_si128((const __m128i*)(src + i + 16)), &invalid);
+    _mm_storeu_si128((__m128i*)(dst + i / 2), _mm_packus_epi16(miniargv_sse2_hex_pairs(first), miniargv_sse2_hex_pairs(second)));
+  }
+  if (_mm_movemask_epi8(invalid) != 0)
+    return -1;
+#endif
+  for (; i < srclen; i += 2) {
+    if ((hi = miniargv_hex_digit(src[i])) < 0 || (lo = miniargv_hex_digit(src[i + 1])) < 0)
+      return -1;
+    dst[i / 2] = (unsigned char)((hi << 4) | lo);
+  }
+  return 0;
+}
+
+/* decode base64 digits without padding (srclen % 4 must not be 1), returns 0 on success */
+static int miniargv_decode_base64 (const char* src, size_t srclen, unsigned char* dst)
+{
+  size_t i = 0;
+  unsigned char* p = dst;
+  int j;
+  int digit;
+  unsigned long bits;
+#ifdef MINIARGV_SSE2
+  __m128i invalid = _mm_setzero_si128();
+  __m128i values;
+  unsigned int groups[4];
+  //decode 16 digits into 12 bytes at a time
+  for (; i + 16 <= srclen; i += 16) {
+    values = miniargv_sse2_base64_digits(_mm_loadu_si128((const __m128i*)(src + i)), &invalid);
+    //combine 4 digits of 6 bits into 24 bits in each 32-bit lane
+    values = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0x00FF)), 6), _mm_srli_epi16(values, 8));
+    values = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(values, _mm_set1_epi32(0x0000FFFF)), 12), _mm_srli_epi32(values, 16));
+    _mm_storeu_si128((__m128i*)groups, values);
+    for (j = 0; j < 4; j++) {
+      *p++ = (unsigned char)(groups[j] >> 16);
+      *p++ = (unsigned char)(groups[j] >> 8);
+      *p++ = (unsigned char)groups[j];
+    }
+  }
+  if (_mm_movemask_epi8(invalid) != 0)
+    return -1;
+#endif
+  bits = 0;
+  j = 0;
+  for (; i < srclen; i++) {
+    if ((digit = miniargv_base64_digit(src[i])) < 0)
+      return -1;
+    bits = (bits << 6) | digit;
+    if (++j == 4) {
+      *p++ = (unsigned char)(bits >> 16);
+      *p++ = (unsigned char)(bits >> 8);
+      *p++ = (unsigned char)bits;
+      bits = 0;
+      j = 0;
+    }
+  }
+  //remaining 2 or 3 digits
+  if (j == 2) {
+    *p++ = (unsigned char)(bits >> 4);
+  } else if (j == 3) {
+    *p++ = (unsigned char)(bits >> 10);
+    *p++ = (unsigned char)(bits >> 2);
+  }
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_blob (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  size_t len;
+  size_t datalen;
+  unsigned char* data;
+  int padding;
+  int status;
+  miniargv_blob* blob = (miniargv_blob*)argdef->userdata;
+  blob->length = 0;
+  if (!value) {
+    free(blob->data);
+    blob->data = NULL;
+    blob->size = 0;
+  } else {
+    //skip leading and trailing spaces
+    while (*value && isspace((unsigned char)*value))
+      value++;
+    len = strlen(value);
+    while (len > 0 && isspace((unsigned char)value[len - 1]))
+      len--;
+    //determine decoded length
+    if (blob->encoding == MINIARGV_BLOB_BASE64) {
+      //padding is optional, but if present it must complete the last group of 4 digits
+      padding = 0;
+      while (padding < 2 && len > 0 && value[len - 1] == '=') {
+        len--;
+        padding++;
+      }
+      if (len % 4 == 1 || (padding && (len + padding) % 4 != 0))
+        return 1;
+      datalen = len / 4 * 3 + (len % 4 ? len % 4 - 1 : 0);
+    } else {
+      if (value[0] == '0' && (value[1] == 'x' || value[1] == 'X')) {
+        value += 2;
+        len -= 2;
+      }
+      if (len % 2 != 0)
+        return 1;
+      datalen = len / 2;
+    }
+    //allocate buffer (reused for following values)
+    if (!blob->data || datalen + 1 > blob->size) {
+      if ((data = (unsigned char*)realloc(blob->data, datalen + 1)) == NULL)
+        return 1;
+      blob->data = data;
+      blob->size = datalen + 1;
+    }
+    //decode and validate
+    if (blob->encoding == MINIARGV_BLOB_BASE64)
+      status = miniargv_decode_base64(value, len, blob->data);
+    else
+      status = miniargv_decode_hex(value, len, blob->data);
+    if (status != 0) {
+      blob->data[0] = 0;
+      return 1;
+    }
+    blob->data[datalen] = 0;
+    blob->length = datalen;
+  }
+  if (blob->callbackfn)
+    return (blob->callbackfn)(argdef, blob->data, blob->length, callbackdata);
+  return 0;
+}
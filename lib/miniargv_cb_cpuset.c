@@ -0,0 +1,262 @@
+#include "miniargv_internal.h"
+
+//number of CPUs in each word of the bitmap (32 on Windows, where long is 32-bit even on 64-bit systems)
+#define MINIARGV_CPUSET_BITS_PER_WORD (8 * sizeof(unsigned long))
+
+/* number of bits set in bitmap word */
+static int miniargv_cpuset_popcount (unsigned long bits)
+{
+#if defined(__GNUC__)
+  return __builtin_popcountl(bits);
+#else
+  int result = 0;
+  for (; bits; bits &= bits - 1)
+    result++;
+  return result;
+#endif
+}
+
+/* position of lowest bit set in non-zero bitmap word */
+static int miniargv_cpuset_ctz (unsigned long bits)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzl(bits);
+#elif defined(_MSC_VER)
+  unsigned long result;
+  _BitScanForward(&result, bits);
+  return (int)result;
+#else
+  int result = 0;
+  while (!(bits & 1)) {
+    bits >>= 1;
+    result++;
+  }
+  return result;
+#endif
+}
+
+/* add or remove CPU to or from bitmap, returns non-zero on memory allocation error */
+static int miniargv_cpuset_mask_set (unsigned long** mask, size_t* words, int cpu)
+{
+  size_t word = cpu / MINIARGV_CPUSET_BITS_PER_WORD;
+  size_t newwords;
+  unsigned long* newmask;
+  if (word >= *words) {
+    newwords = (*words ? *words : 1);
+    while (newwords <= word)
+      newwords *= 2;
+    if ((newmask = (unsigned long*)realloc(*mask, newwords * sizeof(unsigned long))) == NULL)
+      return 1;
+    memset(newmask + *words, 0, (newwords - *words) * sizeof(unsigned long));
+    *mask = newmask;
+    *words = newwords;
+  }
+  (*mask)[word] |= 1UL << (cpu % MINIARGV_CPUSET_BITS_PER_WORD);
+  return 0;
+}
+
+/* parse CPU number, returns position following it or NULL on error */
+static const char* miniargv_cpuset_parse_number (const char* p, int* result)
+{
+  int value = 0;
+  if (!isdigit((unsigned char)*p))
+    return NULL;
+  while (isdigit((unsigned char)*p)) {
+    value = value * 10 + (*p++ - '0');
+    if (value > MINIARGV_CPUSET_MAX_CPU)
+      return NULL;
+  }
+  *result = value;
+  return p;
+}
+
+/* parse hexadecimal mask (without 0x) into bitmap, returns non-zero on error */
+static int miniargv_cpuset_parse_mask (const char* value, unsigned long** mask, size_t* words)
+{
+  const char* p = strchr(value, 0);
+  int digit;
+  int i;
+  int cpu = 0;
+  int digits = 0;
+  //skip trailing spaces
+  while (p != value && isspace((unsigned char)*(p - 1)))
+    p--;
+  if (p == value)
+    return 1;
+  //process digits starting with the lowest CPUs
+  while (p-- != value) {
+    if (*p == ',')
+      continue;
+    if ((digit = miniargv_hex_digit(*p)) < 0)
+      return 1;
+    for (i = 0; i < 4; i++) {
+      if (digit & (1 << i)) {
+        if (cpu + i > MINIARGV_CPUSET_MAX_CPU || miniargv_cpuset_mask_set(mask, words, cpu + i) != 0)
+          return 1;
+      }
+    }
+    //leading zeros beyond the highest CPU are allowed (without counting further)
+    if (cpu <= MINIARGV_CPUSET_MAX_CPU)
+      cpu += 4;
+    digits++;
+  }
+  return (digits ? 0 : 1);
+}
+
+/* parse comma separated list of CPUs into bitmaps of included and excluded CPUs, returns non-zero on error */
+static int miniargv_cpuset_parse_list (const char* p, unsigned long** mask, size_t* words, unsigned long** excludemask, size_t* excludewords)
+{
+  int exclude;
+  int first;
+  int last;
+  int used;
+  int group;
+  int cpu;
+  int i;
+  while (*p) {
+    exclude = 0;
+    if (*p == '^' || *p == '!') {
+      exclude = 1;
+      p++;
+    }
+    //parse CPU number or range
+    if ((p = miniargv_cpuset_parse_number(p, &first)) == NULL)
+      return 1;
+    last = first;
+    used = 1;
+    group = 1;
+    if (*p == '-') {
+      if ((p = miniargv_cpuset_parse_number(p + 1, &last)) == NULL || last < first)
+        return 1;
+      //parse stride or used CPUs per group
+      if (*p == ':') {
+        if ((p = miniargv_cpuset_parse_number(p + 1, &group)) == NULL || group == 0)
+          return 1;
+        if (*p == '/') {
+          used = group;
+          if ((p = miniargv_cpuset_parse_number(p + 1, &group)) == NULL || group == 0 || used > group)
+            return 1;
+        }
+      }
+    }
+    //set CPUs
+    for (cpu = first; cpu <= last; cpu += group) {
+      for (i = 0; i < used && cpu + i <= last; i++) {
+        if (miniargv_cpuset_mask_set((exclude ? excludemask : mask), (exclude ? excludewords : words), cpu + i) != 0)
+          return 1;
+      }
+    }
+    //skip separator
+    while (isspace((unsigned char)*p))
+      p++;
+    if (*p == ',') {
+      p++;
+      while (isspace((unsigned char)*p))
+        p++;
+      if (!*p)
+        return 1;
+    } else if (*p) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* free set of CPUs */
+static void miniargv_cpuset_free (miniargv_cpuset* cpuset)
+{
+  free(cpuset->mask);
+  free(cpuset->cpus);
+  cpuset->mask = NULL;
+  cpuset->masksize = 0;
+  cpuset->cpus = NULL;
+  cpuset->count = 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cb_set_cpuset (const miniargv_definition* argdef, const char* value, void* callbackdata)
+{
+  int status;
+  size_t i;
+  unsigned long bits;
+  unsigned long* mask = NULL;
+  size_t words = 0;
+  unsigned long* excludemask = NULL;
+  size_t excludewords = 0;
+  miniargv_cpuset* cpuset = (miniargv_cpuset*)argdef->userdata;
+  miniargv_cpuset_free(cpuset);
+  if (!value)
+    return 0;
+  //parse mask or list
+  while (*value && isspace((unsigned char)*value))
+    value++;
+  if (value[0] == '0' && (value[1] == 'x' || value[1] == 'X'))
+    status = miniargv_cpuset_parse_mask(value + 2, &mask, &words);
+  else
+    status = miniargv_cpuset_parse_list(value, &mask, &words, &excludemask, &excludewords);
+  if (status == 0) {
+    //remove excluded CPUs
+    for (i = 0; i < words && i < excludewords; i++)
+      mask[i] &= ~excludemask[i];
+    //list CPUs in the set
+    for (i = 0; i < words; i++)
+      cpuset->count += miniargv_cpuset_popcount(mask[i]);
+    if (cpuset->count > 0 && (cpuset->cpus = (int*)malloc(cpuset->count * sizeof(int))) == NULL)
+      status = 1;
+  }
+  free(excludemask);
+  if (status != 0) {
+    free(mask);
+    cpuset->count = 0;
+    return 1;
+  }
+  cpuset->count = 0;
+  for (i = 0; i < words; i++) {
+    for (bits = mask[i]; bits; bits &= bits - 1)
+      cpuset->cpus[cpuset->count++] = i * MINIARGV_CPUSET_BITS_PER_WORD + miniargv_cpuset_ctz(bits);
+  }
+  cpuset->mask = mask;
+  cpuset->masksize = words * sizeof(unsigned long);
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cpuset_get_mask (const miniargv_cpuset* cpuset, void* mask, size_t masksize)
+{
+  memset(mask, 0, masksize);
+  if (cpuset->count > 0 && (size_t)cpuset->cpus[cpuset->count - 1] >= masksize * 8)
+    return 1;
+  memcpy(mask, cpuset->mask, (cpuset->masksize < masksize ? cpuset->masksize : masksize));
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cpuset_spread (const miniargv_cpuset* cpuset, int thread, int numthreads)
+{
+  if (cpuset->count <= 0 || thread < 0)
+    return -1;
+  //space out threads if there are more CPUs than threads
+  if (numthreads > 0 && numthreads < cpuset->count)
+    return cpuset->cpus[(long)(thread % numthreads) * cpuset->count / numthreads];
+  return cpuset->cpus[thread % cpuset->count];
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cpuset_pin (const miniargv_cpuset* cpuset, int thread, int numthreads)
+{
+  int cpu;
+  if ((cpu = miniargv_cpuset_spread(cpuset, thread, numthreads)) < 0)
+    return 1;
+#if defined(__linux__)
+  {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (cpu >= CPU_SETSIZE)
+      return 1;
+    CPU_SET(cpu, &mask);
+    return (sched_setaffinity(0, sizeof(mask), &mask) == 0 ? 0 : 1);
+  }
+#elif defined(_WIN32)
+  if (cpu >= (int)(8 * sizeof(DWORD_PTR)))
+    return 1;
+  return (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0 ? 0 : 1);
+#else
+  return 1;
+#endif
+}
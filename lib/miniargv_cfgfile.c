@@ -0,0 +1,275 @@
+#include "miniargv_internal.h"
+
+/* configuration file scanner */
+
+//whitespace within a line (same as isspace() in the C locale, except for new line)
+#define MINIARGV_CFG_ISSPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\r' || (c) == '\v' || (c) == '\f')
+
+//classes of characters the scanner looks for
+#define MINIARGV_CFG_CLASS_LINE      0x01   //end of line: \n \0
+#define MINIARGV_CFG_CLASS_SEPARATOR 0x02   //end of variable name: = : @ # ; \n \0
+#define MINIARGV_CFG_CLASS_VALUE     0x04   //special character in value: " \ \n \0
+
+/* find first character of the specified class (the data must be followed by MINIARGV_CFG_PADDING NUL characters) */
+static char* miniargv_cfg_find (char* p, int cls)
+{
+#if defined(__AVX2__)
+  __m256i block;
+  __m256i match;
+  unsigned int mask;
+  //classify 32 characters at a time
+  for (;; p += 32) {
+    block = _mm256_loadu_si256((const __m256i*)p);
+    match = _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(block, _mm256_setzero_si256()));
+    if (cls == MINIARGV_CFG_CLASS_SEPARATOR)
+      match = _mm256_or_si256(match, _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('=')), _mm256_cmpeq_epi8(block, _mm256_set1_epi8(':'))), _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('@')), _mm256_cmpeq_epi8(block, _mm256_set1_epi8('#'))), _mm256_cmpeq_epi8(block, _mm256_set1_epi8(';')))));
+    else if (cls == MINIARGV_CFG_CLASS_VALUE)
+      match = _mm256_or_si256(match, _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\\'))));
+    if ((mask = (unsigned int)_mm256_movemask_epi8(match)) != 0)
+      return p + miniargv_ctz(mask);
+  }
+#elif defined(MINIARGV_SSE2)
+  __m128i block;
+  __m128i match;
+  unsigned int mask;
+  //classify 16 characters at a time
+  for (;; p += 16) {
+    block = _mm_loadu_si128((const __m128i*)p);
+    match = _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(block, _mm_setzero_si128()));
+    if (cls == MINIARGV_CFG_CLASS_SEPARATOR)
+      match = _mm_or_si128(match, _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('=')), _mm_cmpeq_epi8(block, _mm_set1_epi8(':'))), _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('@')), _mm_cmpeq_epi8(block, _mm_set1_epi8('#'))), _mm_cmpeq_epi8(block, _mm_set1_epi8(';')))));
+    else if (cls == MINIARGV_CFG_CLASS_VALUE)
+      match = _mm_or_si128(match, _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('"')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\\'))));
+    if ((mask = _mm_movemask_epi8(match)) != 0)
+      return p + miniargv_ctz(mask);
+  }
+#else
+  for (;; p++) {
+    if (*p == '\n' || *p == 0)
+      return p;
+    if (cls == MINIARGV_CFG_CLASS_SEPARATOR && (*p == '=' || *p == ':' || *p == '@' || *p == '#' || *p == ';'))
+      return p;
+    if (cls == MINIARGV_CFG_CLASS_VALUE && (*p == '"' || *p == '\\'))
+      return p;
+  }
+#endif
+}
+
+/* get start of next line (skipping anything following a NUL character inside the line) */
+static char* miniargv_cfg_next_line (char* p, const char* end)
+{
+  p = miniargv_cfg_find(p, MINIARGV_CFG_CLASS_LINE);
+  while (*p == 0 && p < end)
+    p = miniargv_cfg_find(p + 1, MINIARGV_CFG_CLASS_LINE);
+  return (p < end ? p + 1 : p);
+}
+
+
+/* check if a quoted value is terminated on the same line (allowing escaped line ends) and only followed by spaces */
+static int miniargv_cfg_is_quoted (char* value)
+{
+  char* p = value + 1;
+  for (;;) {
+    p = miniargv_cfg_find(p, MINIARGV_CFG_CLASS_VALUE);
+    if (*p == '\\') {
+      if (p[1] == 0)
+        return 0;
+      p += (p[1] == '\r' && p[2] == '\n' ? 3 : 2);
+    } else if (*p == '"') {
+      p++;
+      while (MINIARGV_CFG_ISSPACE(*p))
+        p++;
+      return (*p == '\n' || *p == 0);
+    } else {
+      return 0;
+    }
+  }
+}
+
+/* parse value in place (removing quotes, handling escapes and joining continuation lines of quoted values), returns start of next line */
+static char* miniargv_cfg_parse_value (char* value, const char* end, int* linenumber)
+{
+  char* p;
+  char* r;
+  char* w;
+  char* next;
+  if (*value != '"' || !miniargv_cfg_is_quoted(value)) {
+    //plain value (taken literally up to the end of the line, so a trailing backslash is kept)
+    p = miniargv_cfg_find(value, MINIARGV_CFG_CLASS_LINE);
+    next = miniargv_cfg_next_line(p, end);
+    while (p != value && MINIARGV_CFG_ISSPACE(*(p - 1)))
+      p--;
+    *p = 0;
+    return next;
+  }
+  //copy quoted value onto itself while processing escapes and continuation lines
+  r = value + 1;
+  w = value;
+  for (;;) {
+    p = miniargv_cfg_find(r, MINIARGV_CFG_CLASS_VALUE);
+    if (w != r)
+      memmove(w, r, p - r);
+    w += p - r;
+    if (*p == '\\' && (p[1] == '\n' || (p[1] == '\r' && p[2] == '\n'))) {
+      //continuation line
+      (*linenumber)++;
+      r = p + (p[1] == '\n' ? 2 : 3);
+    } else if (*p == '\\') {
+      //escape sequence
+      r = p + 2;
+      switch (p[1]) {
+        case 'n' : *w++ = '\n'; break;
+        case 't' : *w++ = '\t'; break;
+        case 'r' : *w++ = '\r'; break;
+        case '\\' :
+        case '"' : *w++ = p[1]; break;
+        default : *w++ = '\\'; *w++ = p[1]; break;
+      }
+    } else {
+      //closing quote (miniargv_cfg_is_quoted() made sure there is one)
+      next = miniargv_cfg_next_line(p + 1, end);
+      *w = 0;
+      return next;
+    }
+  }
+}
+
+
+/* find next entry (skipping empty lines and comments), returns start of following line or NULL if there are no more entries */
+char* miniargv_cfg_next_entry (char* p, const char* end, int* linenumber, struct miniargv_cfg_entry_struct* entry)
+{
+  char* q;
+  while (p < end) {
+    (*linenumber)++;
+    entry->line = p;
+    entry->linenumber = *linenumber;
+    //skip spaces preceding varname
+    while (MINIARGV_CFG_ISSPACE(*p))
+      p++;
+    if (*p == '@') {
+      //include specified file if line starts with @
+      p++;
+      while (MINIARGV_CFG_ISSPACE(*p))
+        p++;
+      entry->name = p;
+      q = miniargv_cfg_find(p, MINIARGV_CFG_CLASS_LINE);
+      p = miniargv_cfg_next_line(q, end);
+      //skip spaces following include file
+      while (q != entry->name && MINIARGV_CFG_ISSPACE(*(q - 1)))
+        q--;
+      *q = 0;
+      if (q == entry->name)
+        continue;
+      entry->namelen = q - entry->name;
+      entry->separator = 0;
+      entry->value = NULL;
+      return p;
+    }
+    //find separator following varname
+    entry->name = p;
+    p = miniargv_cfg_find(p, MINIARGV_CFG_CLASS_SEPARATOR);
+    entry->separator = *p;
+    //skip spaces following varname
+    q = p;
+    while (q != entry->name && MINIARGV_CFG_ISSPACE(*(q - 1)))
+      q--;
+    if ((entry->separator != '=' && entry->separator != ':' && entry->separator != '@') || q == entry->name) {
+      //skip empty lines, comments and lines without variable name or separator
+      p = miniargv_cfg_next_line(p, end);
+      continue;
+    }
+    entry->namelen = q - entry->name;
+    //skip spaces preceding value
+    p++;
+    while (MINIARGV_CFG_ISSPACE(*p))
+      p++;
+    entry->value = p;
+    return miniargv_cfg_parse_value(p, end, linenumber);
+  }
+  return NULL;
+}
+
+/* process configuration file using existing state */
+static int miniargv_process_cfgfile_state (const char* cfgfile, const miniargv_definition cfgdef[], miniargv_handler_fn badfn, void* callbackdata, struct miniargv_parse_state_struct* state)
+{
+  int linenumber = 0;
+  char* data;
+  size_t datalen;
+  char* p;
+  struct miniargv_cfg_entry_struct entry;
+  char* loadedvalue;
+  size_t loadedvaluelen;
+  const miniargv_definition* current_cfgdef;
+  const miniargv_definition* suggestion;
+  unsigned char opcode;
+  char* name;
+  int status = 0;
+  //read entire file
+  if ((data = miniargv_cfg_read(cfgfile, &datalen)) == NULL)
+    return 0;
+  MINIARGV_PROBE2(cfg__open, cfgfile, datalen);
+  p = data;
+  while (status == 0 && (p = miniargv_cfg_next_entry(p, data + datalen, &linenumber, &entry)) != NULL) {
+    if (!entry.separator) {
+      //include specified file
+      MINIARGV_PROBE3(cfg__include, entry.name, cfgfile, entry.linenumber);
+      status = miniargv_process_cfgfile_state(entry.name, cfgdef, badfn, callbackdata, state);
+    } else if ((current_cfgdef = miniargv_lookup_longarg(entry.name, entry.namelen, cfgdef, state->index, &opcode)) != NULL) {
+      if (entry.separator == '@') {
+        //process contents of another file
+        if ((loadedvalue = miniargv_cfg_read(entry.value, &loadedvaluelen)) != NULL) {
+          if (loadedvaluelen > 0)
+            status = miniargv_call_handler(state, current_cfgdef, opcode, loadedvalue, callbackdata, entry.linenumber);
+          free(loadedvalue);
+        }
+      } else {
+        //process variable value
+        status = miniargv_call_handler(state, current_cfgdef, opcode, entry.value, callbackdata, entry.linenumber);
+      }
+    } else if (badfn) {
+      //variable name not found, pass it with the definition that was most likely meant
+      if ((name = (char*)malloc(entry.namelen + 1)) == NULL) {
+        status = -1;
+      } else {
+        memcpy(name, entry.name, entry.namelen);
+        name[entry.namelen] = 0;
+        suggestion = NULL;
+        miniargv_suggest(name, cfgdef, &suggestion, 1);
+        status = (badfn)(suggestion, name, callbackdata);
+        free(name);
+      }
+    }
+  }
+  free(data);
+  return status;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_process_cfgfile (const char* cfgfile, const miniargv_definition cfgdef[], void* callbackdata)
+{
+  return miniargv_process_cfgfile_badfn(cfgfile, cfgdef, NULL, callbackdata);
+}
+
+DLL_EXPORT_MINIARGV int miniargv_process_cfgfile_badfn (const char* cfgfile, const miniargv_definition cfgdef[], miniargv_handler_fn badfn, void* callbackdata)
+{
+  int i;
+  int status;
+  struct miniargv_parse_state_struct state = {0};
+  state.source = "cfgfile";
+  MINIARGV_PROBE2(parse__start, state.source, 0);
+  //look up the variables of all included files in the same index
+  miniargv_cache_enter();
+  state.index = miniargv_index_get(cfgdef);
+  status = miniargv_process_cfgfile_state(cfgfile, cfgdef, badfn, callbackdata, &state);
+  if (state.deferred.count > 0) {
+    //run deferred callback invocations and report the first one that failed
+    if (status == 0) {
+      miniargv_deferred_run(&state.deferred);
+      for (i = 0; i < state.deferred.count && status == 0; i++)
+        status = state.deferred.items[i].result;
+    }
+    miniargv_deferred_free(&state.deferred);
+  }
+  miniargv_cache_leave();
+  MINIARGV_PROBE2(parse__end, state.source, status);
+  return status;
+}
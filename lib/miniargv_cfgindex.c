@@ -0,0 +1,351 @@
+#include "miniargv_internal.h"
+
+/* indexed configuration file lookup */
+
+//suffix appended to the path of a configuration file to get the path of its index file
+#define MINIARGV_CFG_INDEX_SUFFIX ".idx"
+
+//index file format version (a file written on a system with different byte order won't match)
+#define MINIARGV_CFG_INDEX_VERSION 1
+
+//nanoseconds part of the last modification time of a file, if available
+#if defined(__APPLE__)
+#define MINIARGV_STAT_MTIME_NSEC(statbuf) ((statbuf).st_mtimespec.tv_nsec)
+#elif defined(__linux__) || defined(__CYGWIN__)
+#define MINIARGV_STAT_MTIME_NSEC(statbuf) ((statbuf).st_mtim.tv_nsec)
+#else
+#define MINIARGV_STAT_MTIME_NSEC(statbuf) 0
+#endif
+
+/* header of index file, followed by the hash table slots and the offsets of the lines including other configuration files */
+struct miniargv_cfg_index_header_struct {
+  char magic[8];                    //"MINIARGV"
+  uint32_t version;                 //MINIARGV_CFG_INDEX_VERSION
+  uint32_t slotcount;               //number of slots in the hash table (power of 2)
+  uint64_t includecount;            //number of lines including other configuration files
+  uint64_t cfgsize;                 //size of the indexed configuration file
+  int64_t cfgmtime;                 //last modification time of the indexed configuration file
+  int64_t cfgmtimensec;
+};
+
+/* slot in hash table of index file */
+struct miniargv_cfg_index_slot_struct {
+  uint64_t offset;                  //offset of line where the variable was last set + 1, or 0 for empty slots
+  uint32_t hash;                    //hash of variable name
+  uint32_t reserved;
+};
+
+
+/* index built in memory for a configuration file without an up to date index file */
+struct miniargv_cfg_index_cached_struct {
+  struct miniargv_cache_object_struct header;
+  char* data;                       //index in the same format as the index file
+};
+
+/* variable found while building the index */
+struct miniargv_cfg_index_entry_struct {
+  const char* name;
+  size_t namelen;
+  uint32_t hash;
+  uint64_t offset;
+};
+
+/* get path of index file for configuration file (caller must free) */
+static char* miniargv_cfg_index_path (const char* cfgfile)
+{
+  char* path;
+  size_t len = strlen(cfgfile);
+  if ((path = (char*)malloc(len + sizeof(MINIARGV_CFG_INDEX_SUFFIX))) == NULL)
+    return NULL;
+  memcpy(path, cfgfile, len);
+  memcpy(path + len, MINIARGV_CFG_INDEX_SUFFIX, sizeof(MINIARGV_CFG_INDEX_SUFFIX));
+  return path;
+}
+
+/* check if index matches the configuration file */
+static int miniargv_cfg_index_is_valid (const struct miniargv_cfg_mapping_struct* index, const struct stat* cfgstatbuf)
+{
+  const struct miniargv_cfg_index_header_struct* header = (const struct miniargv_cfg_index_header_struct*)index->data;
+  size_t slotsize;
+  if (index->length < sizeof(struct miniargv_cfg_index_header_struct))
+    return 0;
+  if (memcmp(header->magic, "MINIARGV", 8) != 0 || header->version != MINIARGV_CFG_INDEX_VERSION)
+    return 0;
+  if (header->slotcount == 0 || (header->slotcount & (header->slotcount - 1)) != 0)
+    return 0;
+  slotsize = (size_t)header->slotcount * sizeof(struct miniargv_cfg_index_slot_struct);
+  if (index->length - sizeof(struct miniargv_cfg_index_header_struct) < slotsize || (index->length - sizeof(struct miniargv_cfg_index_header_struct) - slotsize) / sizeof(uint64_t) != header->includecount || (index->length - sizeof(struct miniargv_cfg_index_header_struct) - slotsize) % sizeof(uint64_t) != 0)
+    return 0;
+  return (header->cfgsize == (uint64_t)cfgstatbuf->st_size && header->cfgmtime == (int64_t)cfgstatbuf->st_mtime && header->cfgmtimensec == (int64_t)MINIARGV_STAT_MTIME_NSEC(*cfgstatbuf));
+}
+
+/* build index for configuration file in memory, returns 0 on success */
+static int miniargv_cfg_index_build (const char* cfgfile, const struct stat* cfgstatbuf, struct miniargv_cfg_mapping_struct* index)
+{
+  int linenumber = 0;
+  char* data;
+  size_t datalen;
+  char* p;
+  struct miniargv_cfg_entry_struct entry;
+  struct miniargv_cfg_index_entry_struct* entries = NULL;
+  struct miniargv_cfg_index_entry_struct* newentries;
+  size_t count = 0;
+  size_t size = 0;
+  uint64_t includecount = 0;
+  uint32_t slotcount;
+  uint32_t mask;
+  uint32_t i;
+  size_t j;
+  struct miniargv_cfg_index_header_struct* header;
+  struct miniargv_cfg_index_slot_struct* slots;
+  const struct miniargv_cfg_index_entry_struct** slotentries;
+  uint64_t* includes;
+  //find all entries in configuration file
+  if ((data = miniargv_cfg_read(cfgfile, &datalen)) == NULL)
+    return -1;
+  p = data;
+  while ((p = miniargv_cfg_next_entry(p, data + datalen, &linenumber, &entry)) != NULL) {
+    if (count >= size) {
+      size = (size ? size * 2 : 64);
+      if ((newentries = (struct miniargv_cfg_index_entry_struct*)realloc(entries, size * sizeof(struct miniargv_cfg_index_entry_struct))) == NULL) {
+        free(entries);
+        free(data);
+        return -1;
+      }
+      entries = newentries;
+    }
+    entries[count].name = (entry.separator ? entry.name : NULL);
+    entries[count].namelen = entry.namelen;
+    entries[count].hash = (entry.separator ? miniargv_hash(entry.name, entry.namelen) : 0);
+    entries[count].offset = entry.line - data;
+    if (!entry.separator)
+      includecount++;
+    count++;
+  }
+  //allocate index with a hash table that is at most half full
+  for (slotcount = 8; slotcount < 2 * (count - includecount); slotcount *= 2)
+    ;
+  mask = slotcount - 1;
+  index->length = sizeof(struct miniargv_cfg_index_header_struct) + slotcount * sizeof(struct miniargv_cfg_index_slot_struct) + includecount * sizeof(uint64_t);
+  index->mappedsize = 0;
+  if ((index->data = (char*)calloc(1, index->length)) == NULL || (slotentries = (const struct miniargv_cfg_index_entry_struct**)calloc(slotcount, sizeof(struct miniargv_cfg_index_entry_struct*))) == NULL) {
+    free(index->data);
+    index->data = NULL;
+    free(entries);
+    free(data);
+    return -1;
+  }
+  header = (struct miniargv_cfg_index_header_struct*)index->data;
+  slots = (struct miniargv_cfg_index_slot_struct*)(header + 1);
+  includes = (uint64_t*)(slots + slotcount);
+  memcpy(header->magic, "MINIARGV", 8);
+  header->version = MINIARGV_CFG_INDEX_VERSION;
+  header->slotcount = slotcount;
+  header->includecount = includecount;
+  header->cfgsize = cfgstatbuf->st_size;
+  header->cfgmtime = cfgstatbuf->st_mtime;
+  header->cfgmtimensec = MINIARGV_STAT_MTIME_NSEC(*cfgstatbuf);
+  //add entries in order, so the last line setting a variable ends up in the index
+  for (j = 0; j < count; j++) {
+    if (!entries[j].name) {
+      *includes++ = entries[j].offset;
+      continue;
+    }
+    i = entries[j].hash & mask;
+    while (slotentries[i] && (slotentries[i]->hash != entries[j].hash || slotentries[i]->namelen != entries[j].namelen || memcmp(slotentries[i]->name, entries[j].name, entries[j].namelen) != 0))
+      i = (i + 1) & mask;
+    slotentries[i] = &entries[j];
+    slots[i].offset = entries[j].offset + 1;
+    slots[i].hash = entries[j].hash;
+  }
+  free(slotentries);
+  free(entries);
+  free(data);
+  return 0;
+}
+
+
+/* free index built in memory */
+static void miniargv_cfg_index_free (struct miniargv_cache_object_struct* object)
+{
+  struct miniargv_cfg_index_cached_struct* cached = (struct miniargv_cfg_index_cached_struct*)object;
+  free(cached->data);
+  free(cached);
+}
+
+/* get valid index for configuration file from its index file or otherwise from the cache (building it in memory if needed), returns NULL on error (indexfile is only mapped if the index file was used) */
+static const struct miniargv_cfg_index_header_struct* miniargv_cfg_index_get (const char* cfgfile, const struct stat* cfgstatbuf, struct miniargv_cfg_mapping_struct* indexfile)
+{
+  char* indexpath;
+  uint64_t key;
+  uint64_t hash;
+  int64_t mtimensec;
+  struct miniargv_cfg_mapping_struct index;
+  struct miniargv_cfg_index_cached_struct* cached;
+  indexfile->data = NULL;
+  //use index file if it exists and is up to date
+  if ((indexpath = miniargv_cfg_index_path(cfgfile)) == NULL)
+    return NULL;
+  if (miniargv_cfg_map(indexpath, indexfile) == 0) {
+    if (miniargv_cfg_index_is_valid(indexfile, cfgstatbuf)) {
+      free(indexpath);
+      return (const struct miniargv_cfg_index_header_struct*)indexfile->data;
+    }
+    miniargv_cfg_unmap(indexfile);
+    indexfile->data = NULL;
+  }
+  free(indexpath);
+  //otherwise use index built in memory, which is cached for the path and the size and last modification time of the configuration file
+  key = miniargv_cache_hash(0xCBF29CE484222325ull, cfgfile, strlen(cfgfile));
+  hash = miniargv_cache_hash(key, &cfgstatbuf->st_size, sizeof(cfgstatbuf->st_size));
+  hash = miniargv_cache_hash(hash, &cfgstatbuf->st_mtime, sizeof(cfgstatbuf->st_mtime));
+  mtimensec = MINIARGV_STAT_MTIME_NSEC(*cfgstatbuf);
+  hash = miniargv_cache_hash(hash, &mtimensec, sizeof(mtimensec));
+  if ((cached = (struct miniargv_cfg_index_cached_struct*)miniargv_cache_get((const void*)(uintptr_t)key, MINIARGV_CACHE_KIND_CFGINDEX, hash)) != NULL)
+    return (const struct miniargv_cfg_index_header_struct*)cached->data;
+  if (miniargv_cfg_index_build(cfgfile, cfgstatbuf, &index) != 0)
+    return NULL;
+  if ((cached = (struct miniargv_cfg_index_cached_struct*)calloc(1, sizeof(struct miniargv_cfg_index_cached_struct))) == NULL) {
+    free(index.data);
+    return NULL;
+  }
+  cached->header.key = (const void*)(uintptr_t)key;
+  cached->header.kind = MINIARGV_CACHE_KIND_CFGINDEX;
+  cached->header.hash = hash;
+  cached->header.freefn = miniargv_cfg_index_free;
+  cached->data = index.data;
+  if ((cached = (struct miniargv_cfg_index_cached_struct*)miniargv_cache_add(&cached->header)) == NULL)
+    return NULL;
+  return (const struct miniargv_cfg_index_header_struct*)cached->data;
+}
+
+static char* miniargv_cfg_lookup_file (const char* cfgfile, const char* key, size_t keylen, uint32_t hash);
+
+/* look up last value of variable by going through the entire configuration file, returns NULL if not found */
+static char* miniargv_cfg_lookup_scan (const char* cfgfile, const char* key, size_t keylen, uint32_t hash)
+{
+  int linenumber = 0;
+  char* data;
+  size_t datalen;
+  char* p;
+  struct miniargv_cfg_entry_struct entry;
+  char* value;
+  size_t len;
+  char* result = NULL;
+  if ((data = miniargv_cfg_read(cfgfile, &datalen)) == NULL)
+    return NULL;
+  p = data;
+  while ((p = miniargv_cfg_next_entry(p, data + datalen, &linenumber, &entry)) != NULL) {
+    value = NULL;
+    if (!entry.separator) {
+      value = miniargv_cfg_lookup_file(entry.name, key, keylen, hash);
+    } else if (entry.namelen == keylen && memcmp(entry.name, key, keylen) == 0) {
+      if (entry.separator != '@') {
+        value = strdup(entry.value);
+      } else if ((value = miniargv_cfg_read(entry.value, &len)) != NULL && len == 0) {
+        //empty files are skipped like miniargv_process_cfgfile() does
+        free(value);
+        value = NULL;
+      }
+    }
+    if (value) {
+      free(result);
+      result = value;
+    }
+  }
+  free(data);
+  return result;
+}
+
+/* look up last value of variable in configuration file or the files it includes, returns NULL if not found */
+static char* miniargv_cfg_lookup_file (const char* cfgfile, const char* key, size_t keylen, uint32_t hash)
+{
+  struct miniargv_cfg_mapping_struct cfg;
+  struct miniargv_cfg_mapping_struct indexfile;
+  const struct miniargv_cfg_index_header_struct* header;
+  const struct miniargv_cfg_index_slot_struct* slots;
+  const uint64_t* includes;
+  struct miniargv_cfg_entry_struct entry;
+  struct miniargv_cfg_entry_struct found;
+  uint64_t offset = 0;
+  uint64_t i;
+  uint32_t mask;
+  int linenumber = 0;
+  size_t len;
+  char* result = NULL;
+  if (miniargv_cfg_map(cfgfile, &cfg) != 0)
+    return NULL;
+  if ((header = miniargv_cfg_index_get(cfgfile, &cfg.statbuf, &indexfile)) == NULL) {
+    //no index available, so go through the entire file
+    miniargv_cfg_unmap(&cfg);
+    return miniargv_cfg_lookup_scan(cfgfile, key, keylen, hash);
+  }
+  slots = (const struct miniargv_cfg_index_slot_struct*)(header + 1);
+  includes = (const uint64_t*)(slots + header->slotcount);
+  //find line where the variable was last set
+  mask = header->slotcount - 1;
+  for (i = hash & mask; slots[i].offset; i = (i + 1) & mask) {
+    if (slots[i].hash == hash && slots[i].offset - 1 < cfg.length && miniargv_cfg_next_entry(cfg.data + slots[i].offset - 1, cfg.data + cfg.length, &linenumber, &found) && found.line == cfg.data + slots[i].offset - 1 && found.separator && found.namelen == keylen && memcmp(found.name, key, keylen) == 0) {
+      offset = slots[i].offset;
+      break;
+    }
+  }
+  //files included after that line take precedence
+  for (i = header->includecount; i-- > 0 && includes[i] + 1 > offset && !result; ) {
+    if (includes[i] < cfg.length && miniargv_cfg_next_entry(cfg.data + includes[i], cfg.data + cfg.length, &linenumber, &entry) && entry.line == cfg.data + includes[i] && !entry.separator)
+      result = miniargv_cfg_lookup_file(entry.name, key, keylen, hash);
+  }
+  if (!result && offset) {
+    if (found.separator != '@') {
+      result = strdup(found.value);
+    } else if ((result = miniargv_cfg_read(found.value, &len)) == NULL || len == 0) {
+      //the value file can't be used, so the previous value has to be found the slow way
+      free(result);
+      result = miniargv_cfg_lookup_scan(cfgfile, key, keylen, hash);
+    }
+  }
+  if (indexfile.data)
+    miniargv_cfg_unmap(&indexfile);
+  miniargv_cfg_unmap(&cfg);
+  return result;
+}
+
+DLL_EXPORT_MINIARGV char* miniargv_cfg_lookup (const char* cfgfile, const char* key)
+{
+  size_t keylen;
+  char* result;
+  if (!cfgfile || !key)
+    return NULL;
+  keylen = strlen(key);
+  miniargv_cache_enter();
+  result = miniargv_cfg_lookup_file(cfgfile, key, keylen, miniargv_hash(key, keylen));
+  miniargv_cache_leave();
+  return result;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_cfg_index_update (const char* cfgfile)
+{
+  struct stat statbuf;
+  char* indexpath;
+  struct miniargv_cfg_mapping_struct index;
+  int result;
+  if (stat(cfgfile, &statbuf) != 0 || (indexpath = miniargv_cfg_index_path(cfgfile)) == NULL)
+    return -1;
+  //keep index file if it is still up to date
+  if (miniargv_cfg_map(indexpath, &index) == 0) {
+    result = miniargv_cfg_index_is_valid(&index, &statbuf);
+    miniargv_cfg_unmap(&index);
+    if (result) {
+      free(indexpath);
+      return 0;
+    }
+  }
+  if (miniargv_cfg_index_build(cfgfile, &statbuf, &index) != 0) {
+    free(indexpath);
+    return -1;
+  }
+  result = miniargv_cfg_index_write(indexpath, &index);
+  free(index.data);
+  free(indexpath);
+  return (result == 0 ? 0 : -1);
+}
@@ -0,0 +1,452 @@
+#include "miniargv_internal.h"
+
+/* define COMPLETE_ADD_SPACE if bash completion is configured via "complete -o nospace -C<path> <command>" */
+//#define COMPLETE_ADD_SPACE
+
+const miniargv_definition* miniargv_complete_arg (char *argv[], char* env[], int index, const miniargv_definition argdef[], const miniargv_definition envdef[], void* callbackdata)
+{
+  char* partialargend;
+  size_t partialarglen;
+  const miniargv_definition* current_argdef;
+  const miniargv_definition* result;
+  const char* partialarg;
+  const char* previousarg;
+  const miniargv_definition* last_argdef = NULL;
+  int multipleresults = 0;
+  if ((partialarg = argv[index]) == NULL || (previousarg = argv[index + 1]) == NULL)
+    return NULL;
+  MINIARGV_PROBE3(complete, NULL, 0, partialarg);
+  //on Windows set console output to binary mode (to avoid showing ^M in bash completion output)
+#ifdef _WIN32
+  setmode(fileno(stdout), O_BINARY);
+#endif
+/*
+  //check if previous argument is reported as just the equals sign
+  const char* commandline;
+  if (previousarg[0] == '=' && !previousarg[1]) {
+    //search for argument preceding the the equals sign
+    const char* commandlinepos;
+    int commandlineposval;
+    commandlinepos = getenv("COMP_POINT");
+    commandlineposval = atoi(commandlinepos ? commandlinepos : NULL) - strlen(partialarg);
+    commandline = getenv("COMP_LINE");
+    while (commandlineposval > 0 && (commandline[commandlineposval - 1] == '=' || isspace(commandline[commandlineposval - 1]))) {
+      commandlineposval--;
+    }
+    while (commandlineposval > 0 && !isspace(commandline[commandlineposval - 1])) {
+      commandlineposval--;
+    }
+    previousarg = commandline + commandlineposval;
+  }
+*/
+  //check previous argument
+  if (previousarg && previousarg[0] == '-' && (
+       (previousarg[1] && previousarg[1] != '-' && !previousarg[2] && (current_argdef = miniargv_find_arg(previousarg, argdef)) != NULL) ||
+       (previousarg[1] == '-' && (current_argdef = miniargv_find_arg(previousarg, argdef)) != NULL)
+      )) {
+    if (current_argdef->argparam) {
+      if (current_argdef->completefn) {
+        (current_argdef->completefn)(argv + 1, env, argdef, envdef, current_argdef, partialarg, 0, callbackdata);
+      }
+      return current_argdef;
+    }
+  }
+  //find standalone value argument definition
+  if (!partialarg[0] || partialarg[0] != '-') {
+    if ((current_argdef = miniargv_find_standalonearg(argdef)) != NULL) {
+      if (current_argdef->completefn) {
+        if ((current_argdef->completefn)(argv + 1, env, argdef, envdef, current_argdef, partialarg, 0, callbackdata) != 0)
+          return current_argdef;
+      }
+    }
+  }
+  //loop through short argument definitions
+  if (!partialarg[0] || (partialarg[0] == '-' && partialarg[1] != '-')) {
+    current_argdef = argdef;
+    while (current_argdef->callbackfn) {
+      if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+        if ((result = miniargv_complete_arg(argv, env, index, (struct miniargv_definition_struct*)(current_argdef->callbackfn), envdef, callbackdata)) != NULL)
+          return result;
+      } else if (current_argdef->shortarg && (!partialarg[0] || !partialarg[1] || partialarg[1] == current_argdef->shortarg)) {
+        if (current_argdef->argparam && partialarg[0] == '-' && partialarg[1] == current_argdef->shortarg) {
+          if (current_argdef->completefn) {
+            (current_argdef->completefn)(argv + 1, env, argdef, envdef, current_argdef, partialarg, 2, callbackdata);
+          }
+          return current_argdef;
+        }
+#ifdef COMPLETE_ADD_SPACE
+        printf("-%c%s\n", current_argdef->shortarg, (current_argdef->argparam ? "" : " "));
+#else
+        printf("-%c\n", current_argdef->shortarg);
+#endif
+        multipleresults++;
+      }
+      current_argdef++;
+    }
+  }
+  //loop through long argument definitions
+  if (!partialarg[0] || (partialarg[0] == '-' && (!partialarg[1] || partialarg[1] == '-'))) {
+    //determine length of long argument without value
+#if 0
+    partialargend = strchrnul(partialarg, '=');
+    partialarglen = (partialargend - partialarg);
+#else
+    if ((partialargend = strchr(partialarg, '=')) == NULL)
+      partialarglen = strlen(partialarg);
+    else
+      partialarglen = (partialargend - partialarg);
+#endif
+    //loop through long argument definitions
+    current_argdef = argdef;
+    while (current_argdef->callbackfn) {
+      if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+        if ((result = miniargv_complete_arg(argv, env, index, (struct miniargv_definition_struct*)(current_argdef->callbackfn), envdef, callbackdata)) != NULL)
+          return result;
+      } else if (current_argdef->longarg && (partialarglen < 2 || (strncmp(partialarg + 2, current_argdef->longarg, partialarglen - 2) == 0 && (!partialarg[partialarglen] || partialarg[partialarglen] == '=')))) {
+        if (current_argdef->argparam && partialarg[partialarglen] == '=') {
+          if (current_argdef->completefn) {
+            (current_argdef->completefn)(argv + 1, env, argdef, envdef, current_argdef, partialarg, partialarglen + 1, callbackdata);
+          }
+          return current_argdef;
+        }
+#ifdef COMPLETE_ADD_SPACE
+        printf("--%s%s\n", current_argdef->longarg, (current_argdef->argparam ? "=" : " "));
+#else
+        if (!current_argdef->argparam) {
+          printf("--%s\n", current_argdef->longarg);
+        } else {
+          printf("--%s=\n", current_argdef->longarg);
+        }
+        last_argdef = current_argdef;
+        multipleresults++;
+#endif
+      }
+      current_argdef++;
+    }
+    //if only long argument found display a seperate entry for it so no space is appended on completion
+    if (multipleresults == 1 && last_argdef->argparam) {
+      printf("--%s=%s\n", last_argdef->longarg, last_argdef->argparam);
+    }
+  }
+  return NULL;
+}
+
+/* get value of environment variable from env (or from the process environment if not found), returns NULL if not set */
+const char* miniargv_complete_getenv (char* env[], const char* name)
+{
+  char** current_env;
+  size_t len = strlen(name);
+  for (current_env = env; current_env && *current_env; current_env++) {
+    if (strncmp(*current_env, name, len) == 0 && (*current_env)[len] == '=')
+      return *current_env + len + 1;
+  }
+  return getenv(name);
+}
+
+/* when bash completion occurs the program specified via "complete -o nospace -C" is called as follows
+     3 arguments are passed to this application:
+      - the command whose arguments are being completed
+      - the prefix of the word where the cursor is, up to the cursor
+      - the word before the cursor
+     environment variables passed to the application:
+      - COMP_LINE contains the complete line in which completion is performed.
+      - COMP_POINT contains the cursor position inside COMP_LINE (counting from 0).
+      - COMP_TYPE is 9 for normal completion, 33 when listing alternatives on ambiguous completions, 37 for menu completion, 63 when tabbing between ambiguous completions, 64 to list completions after a partial completion.
+      - COMP_KEY contains the key that triggered completion (e.g. a tab character if the user pressed Tab).
+*/
+
+DLL_EXPORT_MINIARGV int miniargv_completion (char *argv[], char* env[], const miniargv_definition argdef[], const miniargv_definition envdef[], const char* completionparam, void* callbackdata)
+{
+  int index = 0;
+  const char* line;
+  const char* point;
+  //check if called from bash completion
+  if (completionparam) {
+    //abort if a special parameter was provided and the first argument does not match it or if not enough paremeters
+    if (!argv[0] || !argv[1] || !argv[2] || !argv[3] || !argv[4] || strcmp(argv[1], completionparam) != 0)
+      return 0;
+    index = 3;
+  } else {
+    //abort if no special parameter was provided and the first argument is not the application or if not enough paremeters
+    const char* prg;
+    int prglen;
+    const char* cmd;
+    int cmdlen;
+    if (!argv[0] || !argv[1] || !argv[2] || !argv[3])
+      return 0;
+    prg = miniargv_getprogramname(argv[0], &prglen);
+    cmd = miniargv_getprogramname(argv[1], &cmdlen);
+    if (!prg || !cmd || cmdlen != prglen ||
+#ifdef _WIN32
+        strnicmp(cmd, prg, cmdlen) != 0
+#else
+        strncmp(cmd, prg, cmdlen) != 0
+#endif
+        )
+      return 0;
+    index = 2;
+  }
+  //replay the command line up to the cursor if bash provided it, otherwise only look at the current and the previous word
+  if ((line = miniargv_complete_getenv(env, "COMP_LINE")) != NULL && (point = miniargv_complete_getenv(env, "COMP_POINT")) != NULL)
+    miniargv_complete_line(argv, env, index, line, strtoul(point, NULL, 10), argdef, envdef, callbackdata);
+  else
+    miniargv_complete_arg(argv, env, index, argdef, envdef, callbackdata);
+  return 1;
+}
+
+/* context-aware bash completion using the lookup index */
+
+/* check if definition may be specified more than once */
+static int miniargv_complete_is_repeatable (const miniargv_definition* argdef)
+{
+  return ((argdef->flags & MINIARGV_FLAG_REPEATABLE) != 0 || argdef->callbackfn == miniargv_cb_increment_int || argdef->callbackfn == miniargv_cb_increment_long || argdef->callbackfn == miniargv_cb_decrement_int || argdef->callbackfn == miniargv_cb_decrement_long);
+}
+
+/* get position of definition in lookup index for command line argument that was given (matching the way it is processed), returns -1 if not found */
+static int miniargv_complete_find (const struct miniargv_index_struct* index, const miniargv_definition argdef[], const char* word, size_t len)
+{
+  int i;
+  const miniargv_definition* current_argdef;
+  if (word[1] != '-')
+    return index->shortargs[(unsigned char)word[1]] - 1;
+  if ((i = miniargv_index_find_longarg_position(index, word + 2, len - 2)) > 0)
+    return i - 1;
+  //abbreviated long argument
+  if ((current_argdef = miniargv_find_longarg(word + 2, len - 2, argdef)) != NULL) {
+    for (i = 0; i < index->count; i++) {
+      if (index->entries[i].argdef == current_argdef)
+        return i;
+    }
+  }
+  return -1;
+}
+
+/* complete command line up to cursor position after skipping the specified number of words using the lookup index of the definitions */
+static const miniargv_definition* miniargv_complete_line_index (char *argv[], char* env[], int index, const char* line, size_t point, int skipwords, const miniargv_definition argdef[], const struct miniargv_index_struct* argindex, const miniargv_definition envdef[], void* callbackdata)
+{
+  unsigned char* given;
+  char* word;
+  const char* p;
+  const char* end;
+  const char* value;
+  size_t len;
+  size_t offset;
+  int i;
+  int multipleresults = 0;
+  int terminated = 0;
+  const miniargv_definition* pending = NULL;
+  const miniargv_definition* current_argdef;
+  const miniargv_definition* last_argdef = NULL;
+  const miniargv_definition* result = NULL;
+  MINIARGV_PROBE3(complete, line, point, (argv ? argv[index] : NULL));
+  len = strlen(line);
+  end = line + (point < len ? point : len);
+  if ((given = (unsigned char*)calloc(argindex->count + 1, 1)) == NULL || (word = (char*)malloc(end - line + 1)) == NULL) {
+    free(given);
+    return NULL;
+  }
+#ifdef _WIN32
+  setmode(fileno(stdout), O_BINARY);
+#endif
+  //replay all complete words to determine which arguments were given and if a value is expected
+  p = line;
+  for (;;) {
+    while (p < end && isspace((unsigned char)*p))
+      p++;
+    if ((p = miniargv_next_word(p, end, word)) == NULL)
+      break;
+    if (skipwords > 0) {
+      skipwords--;
+    } else if (pending) {
+      pending = NULL;
+    } else if (!terminated && word[0] == '-' && word[1] == '-' && !word[2]) {
+      terminated = 1;
+    } else if (!terminated && word[0] == '-' && word[1]) {
+      for (len = 2; word[1] == '-' && word[len] && word[len] != '='; len++)
+        ;
+      if ((i = miniargv_complete_find(argindex, argdef, word, len)) >= 0) {
+        given[i] = 1;
+        if (argindex->entries[i].argdef->argparam && !word[len])
+          pending = argindex->entries[i].argdef;
+      }
+    }
+  }
+  //nothing to complete for the command itself
+  if (skipwords > 0) {
+    free(word);
+    free(given);
+    return NULL;
+  }
+  //only pass the part of the word after the last word break bash uses (e.g. '=') to completion functions
+  len = strlen(word);
+  offset = 0;
+  if (argv && argv[index] && strlen(argv[index]) <= len && strcmp(word + len - strlen(argv[index]), argv[index]) == 0)
+    offset = len - strlen(argv[index]);
+  else if (argv && argv[index] && !strchr(argv[index], '=') && (value = strrchr(word, '=')) != NULL)
+    offset = value + 1 - word;
+  if (pending) {
+    //value for previous argument
+    if (pending->completefn)
+      (pending->completefn)(argv + 1, env, argdef, envdef, pending, word + offset, 0, callbackdata);
+    result = pending;
+  } else if (!terminated && word[0] == '-' && word[1] == '-' && (value = strchr(word, '=')) != NULL) {
+    //value of long argument
+    if ((i = miniargv_complete_find(argindex, argdef, word, value - word)) >= 0 && (result = argindex->entries[i].argdef)->argparam && result->completefn)
+      (result->completefn)(argv + 1, env, argdef, envdef, result, word + offset, (value + 1 - word > offset ? value + 1 - word - offset : 0), callbackdata);
+  } else if (!terminated && word[0] == '-' && word[1] && word[1] != '-' && word[2]) {
+    //value of short argument
+    if ((i = argindex->shortargs[(unsigned char)word[1]] - 1) >= 0 && (result = argindex->entries[i].argdef)->argparam && result->completefn)
+      (result->completefn)(argv + 1, env, argdef, envdef, result, word + offset, (2 > offset ? 2 - offset : 0), callbackdata);
+  } else {
+    //standalone value
+    if ((terminated || word[0] != '-') && argindex->standalonearg && (current_argdef = argindex->entries[argindex->standalonearg - 1].argdef)->completefn) {
+      if ((current_argdef->completefn)(argv + 1, env, argdef, envdef, current_argdef, word + offset, 0, callbackdata) != 0)
+        result = current_argdef;
+    }
+    //arguments that were not given yet (or that may be repeated) in one pass
+    if (!result && !terminated && (!word[0] || word[0] == '-')) {
+      for (i = 0; i < argindex->count; i++) {
+        current_argdef = argindex->entries[i].argdef;
+        if (given[i] && !miniargv_complete_is_repeatable(current_argdef))
+          continue;
+        if (current_argdef->shortarg && (!word[1] || (word[1] == current_argdef->shortarg && !word[2]))) {
+#ifdef COMPLETE_ADD_SPACE
+          printf("-%c%s\n", current_argdef->shortarg, (current_argdef->argparam ? "" : " "));
+#else
+          printf("-%c\n", current_argdef->shortarg);
+#endif
+        }
+        if (current_argdef->longarg && (!word[1] || (word[1] == '-' && strncmp(word + 2, current_argdef->longarg, len - 2) == 0))) {
+#ifdef COMPLETE_ADD_SPACE
+          printf("--%s%s\n", current_argdef->longarg, (current_argdef->argparam ? "=" : " "));
+#else
+          printf("--%s%s\n", current_argdef->longarg, (current_argdef->argparam ? "=" : ""));
+#endif
+          last_argdef = current_argdef;
+          multipleresults++;
+        }
+      }
+#ifndef COMPLETE_ADD_SPACE
+      //if only one long argument was found display a seperate entry for it so no space is appended on completion
+      if (multipleresults == 1 && last_argdef->argparam)
+        printf("--%s=%s\n", last_argdef->longarg, last_argdef->argparam);
+#endif
+    }
+  }
+  free(word);
+  free(given);
+  return result;
+}
+
+/* complete command line up to cursor position after skipping the specified number of words (command and applet name) */
+const miniargv_definition* miniargv_complete_line_words (char *argv[], char* env[], int index, const char* line, size_t point, int skipwords, const miniargv_definition argdef[], const miniargv_definition envdef[], void* callbackdata)
+{
+  const struct miniargv_index_struct* argindex;
+  const miniargv_definition* result;
+  miniargv_cache_enter();
+  if ((argindex = miniargv_index_get(argdef)) == NULL)
+    result = miniargv_complete_arg(argv, env, index, argdef, envdef, callbackdata);
+  else
+    result = miniargv_complete_line_index(argv, env, index, line, point, skipwords, argdef, argindex, envdef, callbackdata);
+  miniargv_cache_leave();
+  return result;
+}
+
+DLL_EXPORT_MINIARGV const miniargv_definition* miniargv_complete_line (char *argv[], char* env[], int index, const char* line, size_t point, const miniargv_definition argdef[], const miniargv_definition envdef[], void* callbackdata)
+{
+  return miniargv_complete_line_words(argv, env, index, line, point, 1, argdef, envdef, callbackdata);
+}
+
+DLL_EXPORT_MINIARGV int miniargv_applet_completion (char* argv[], char* env[], const miniargv_applet applets[], const char* completionparam, void* callbackdata)
+{
+  int index;
+  const char* prg;
+  int prglen;
+  const char* cmd;
+  int cmdlen;
+  const char* line;
+  const char* point;
+  const char* word;
+  size_t len;
+  const miniargv_applet* applet;
+  //check if called from bash completion
+  if (completionparam) {
+    if (!argv[0] || !argv[1] || !argv[2] || !argv[3] || !argv[4] || strcmp(argv[1], completionparam) != 0)
+      return 0;
+    index = 3;
+  } else {
+    //bash passes exactly 3 arguments and sets COMP_LINE (an applet invoked with 3 arguments is not mistaken for completion)
+    if (!argv[0] || !argv[1] || !argv[2] || !argv[3] || argv[4])
+      return 0;
+    index = 2;
+  }
+  //get command line being completed
+  line = miniargv_complete_getenv(env, "COMP_LINE");
+  point = miniargv_complete_getenv(env, "COMP_POINT");
+  if (!completionparam && !line)
+    return 0;
+  //complete arguments of applet invoked via its own name
+  cmd = miniargv_getprogramname(argv[index - 1], &cmdlen);
+  if (cmd && (applet = miniargv_find_applet(cmd, cmdlen, applets)) != NULL) {
+    if (applet->argdef) {
+      if (line && point)
+        miniargv_complete_line_words(argv, env, index, line, strtoul(point, NULL, 10), 1, applet->argdef, applet->envdef, callbackdata);
+      else
+        miniargv_complete_arg(argv, env, index, applet->argdef, applet->envdef, callbackdata);
+    }
+    return 1;
+  }
+  //abort if no special parameter was provided and the command is not the application itself
+  if (!completionparam) {
+    prg = miniargv_getprogramname(argv[0], &prglen);
+    if (!prg || !cmd || cmdlen != prglen ||
+#ifdef _WIN32
+        strnicmp(cmd, prg, cmdlen) != 0
+#else
+        strncmp(cmd, prg, cmdlen) != 0
+#endif
+        )
+      return 0;
+  }
+  //list applet names when completing the first argument
+  if (strcmp(argv[index + 1], argv[index - 1]) == 0) {
+    len = strlen(argv[index]);
+    for (applet = applets; applet->name; applet++) {
+      if (strncmp(applet->name, argv[index], len) == 0)
+        printf("%s\n", applet->name);
+    }
+    return 1;
+  }
+  //get applet name from the first argument on the command line
+  if (!line)
+    return 1;
+  word = line;
+  while (*word && isspace(*word))
+    word++;
+  while (*word && !isspace(*word))
+    word++;
+  while (*word && isspace(*word))
+    word++;
+  len = 0;
+  while (word[len] && !isspace(word[len]))
+    len++;
+  if ((applet = miniargv_find_applet(word, len, applets)) != NULL && applet->argdef) {
+    //replay the command line after the command and the applet name
+    if (point)
+      miniargv_complete_line_words(argv, env, index, line, strtoul(point, NULL, 10), 2, applet->argdef, applet->envdef, callbackdata);
+    else
+      miniargv_complete_arg(argv, env, index, applet->argdef, applet->envdef, callbackdata);
+  }
+  return 1;
+}
+
+DLL_EXPORT_MINIARGV void miniargv_applet_completion_script (FILE* dst, const char* path, const char* completionparam, const miniargv_applet applets[])
+{
+  const char* prg;
+  int prglen;
+  const miniargv_applet* current_applet;
+  prg = miniargv_getprogramname(path, &prglen);
+  fprintf(dst, "complete -C\"%s%s%s\" %.*s\n", path, (completionparam ? " " : ""), (completionparam ? completionparam : ""), prglen, prg);
+  for (current_applet = applets; current_applet->name; current_applet++)
+    fprintf(dst, "complete -C\"%s%s%s\" %s\n", path, (completionparam ? " " : ""), (completionparam ? completionparam : ""), current_applet->name);
+}
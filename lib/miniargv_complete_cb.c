@@ -0,0 +1,154 @@
+#include "miniargv_internal.h"
+#include <dirent.h>
+
+DLL_EXPORT_MINIARGV int miniargv_complete_cb_noop (char *argv[], char* env[], const miniargv_definition* argdef, const miniargv_definition envdef[], const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata)
+{
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_complete_cb_env (char *argv[], char* env[], const miniargv_definition* argdef, const miniargv_definition envdef[], const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata)
+{
+  size_t pos;
+  size_t len;
+  char** currentenv;
+  char* p;
+  //get environment variable name from argument (starting at the end)
+  pos = strlen(arg);
+  len = 0;
+  while (pos > argparampos && arg[pos - 1] != '$') {
+    pos--;
+    len++;
+  }
+  //abort if dollar sign not found
+  if (pos <= argparampos || arg[pos - 1] != '$')
+    return 0;
+  //loop through environment variables
+  currentenv = env;
+  while (*currentenv) {
+    if (strncmp(*currentenv, arg + pos, len) == 0) {
+      if ((p = strchr(*currentenv, '=')) != NULL) {
+        printf("%.*s%.*s\n", (int)pos, arg, (int)(p - *currentenv), *currentenv);
+      }
+    }
+    currentenv++;
+  }
+  return 0;
+}
+
+int miniargv_complete_file_or_folder (char *argv[], const miniargv_definition* argdef, const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata, int hidefiles)
+{
+  DIR* dir;
+  struct dirent* direntry;
+  struct stat fileinfo;
+  char* path;
+  size_t pathlen;
+  char* filepath;
+  size_t filepathlen;
+  size_t len;
+  size_t pos;
+  size_t direntrylen;
+  char* lastdirpath = NULL;
+  int multipleresults = 0;
+  //get folder path from argument
+  pos = strlen(arg);
+  len = 0;
+  while (pos > argparampos && arg[pos - 1] != '/'
+#ifdef _WIN32
+         && arg[pos - 1] != '\\' && arg[pos - 1] != ':'
+#endif
+  ) {
+    pos--;
+    len++;
+  }
+  pathlen = pos - argparampos;
+  if ((path = (char*)malloc(pathlen + 2)) == NULL) {
+    fprintf(stderr, "memory allocation error\n");
+    return 1;
+  }
+  memcpy(path, arg + argparampos, pathlen);
+/*
+  if (pathlen > 0 && path[pathlen - 1] != '/'
+#ifdef _WIN32
+      && path[pathlen - 1] != '\\'
+#endif
+  ) {
+    path[pathlen++] = '/';
+  }
+*/
+  path[pathlen] = 0;
+  //create placeholder for full file path
+  filepathlen = pathlen;
+  if ((filepath = (char*)malloc(filepathlen + 1)) == NULL) {
+    fprintf(stderr, "memory allocation error\n");
+    return 1;
+  }
+  memcpy(filepath, path, pathlen);
+  //check directory entries
+  if ((dir = opendir(*path ? path : "./")) != NULL) {
+    while ((direntry = readdir(dir)) != NULL) {
+      //only show matches and skip "." (current folder) and ".." (parent folder)
+      if (
+#ifdef _WIN32
+          strnicmp(direntry->d_name, arg + pos, len) == 0
+#else
+          strncmp(direntry->d_name, arg + pos, len) == 0
+#endif
+          && (!*path || (strcmp(direntry->d_name, ".") != 0 && strcmp(direntry->d_name, "..") != 0))
+      ) {
+        //determine full path
+        direntrylen = strlen(direntry->d_name);
+        if (filepathlen < pathlen + direntrylen) {
+          filepathlen = pathlen + direntrylen;
+          if ((filepath = (char*)realloc(filepath, filepathlen + 1)) == NULL) {
+            fprintf(stderr, "memory allocation error\n");
+            return 1;
+          }
+        }
+        strcpy(filepath + pathlen, direntry->d_name);
+        //get file/folder attributes
+        stat(filepath, &fileinfo);
+        //show result as needed
+        if (!S_ISDIR(fileinfo.st_mode)) {
+          if (!hidefiles)
+            printf("%.*s%s\n", argparampos, arg, filepath);
+        } else {
+          printf("%.*s%s/\n", argparampos, arg, filepath);
+          if (!lastdirpath)
+            lastdirpath = strdup(filepath);
+        }
+        if (multipleresults < 2) {
+          multipleresults++;
+        } else if (lastdirpath) {
+          free(lastdirpath);
+          lastdirpath = NULL;
+        }
+      }
+    }
+    closedir(dir);
+  }
+  //if only one result and it is a directory entry repeat it with "/." appended to avoid adding a space on completion
+  if (lastdirpath) {
+    if (multipleresults == 1)
+      printf("%.*s%s/.\n", argparampos, arg, lastdirpath);
+    free(lastdirpath);
+  }
+  free(filepath);
+  free(path);
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_complete_cb_file (char *argv[], char* env[], const miniargv_definition* argdef, const miniargv_definition envdef[], const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata)
+{
+  int result;
+  if ((result = miniargv_complete_cb_env(argv, env, argdef, envdef, currentarg, arg, argparampos, callbackdata)) != 0)
+    return result;
+  return miniargv_complete_file_or_folder(argv, argdef, currentarg, arg, argparampos, callbackdata, 0);
+}
+
+DLL_EXPORT_MINIARGV int miniargv_complete_cb_folder (char *argv[], char* env[], const miniargv_definition* argdef, const miniargv_definition envdef[], const miniargv_definition* currentarg, const char* arg, int argparampos, void* callbackdata)
+{
+  int result;
+  if ((result = miniargv_complete_cb_env(argv, env, argdef, envdef, currentarg, arg, argparampos, callbackdata)) != 0)
+    return result;
+  return miniargv_complete_file_or_folder(argv, argdef, currentarg, arg, argparampos, callbackdata, 1);
+}
@@ -0,0 +1,189 @@
+#include "miniargv_internal.h"
+#ifdef MINIARGV_WEAK_REFERENCES
+//values of these callback functions only need to be handled if they are linked
+#pragma weak miniargv_cb_set_blob
+#pragma weak miniargv_cb_set_array
+#pragma weak miniargv_cb_set_cpuset
+#endif
+
+/* get size of variable set by predefined callback function, or 0 if the callback function has to be called */
+size_t miniargv_defaults_value_size (miniargv_handler_fn callbackfn)
+{
+  if (callbackfn == miniargv_cb_set_int || callbackfn == miniargv_cb_set_boolean)
+    return sizeof(int);
+  if (callbackfn == miniargv_cb_set_long)
+    return sizeof(long);
+  if (callbackfn == miniargv_cb_set_const_str)
+    return sizeof(const char*);
+  return 0;
+}
+
+/* get size of variable that must not be overwritten with the image, or 0 if none */
+static size_t miniargv_defaults_protected_size (miniargv_handler_fn callbackfn)
+{
+  if (callbackfn == miniargv_cb_strdup)
+    return sizeof(char*);
+  if (callbackfn == miniargv_cb_lazy)
+    return sizeof(miniargv_lazy);
+  if (callbackfn == miniargv_cb_set_blob)
+    return sizeof(miniargv_blob);
+  if (callbackfn == miniargv_cb_set_array)
+    return sizeof(miniargv_array);
+  if (callbackfn == miniargv_cb_set_cpuset)
+    return sizeof(miniargv_cpuset);
+  return 0;
+}
+
+/* exclude part of the store from the segments copied from the image */
+static int miniargv_defaults_protect (miniargv_defaults* defaults, size_t offset, size_t size)
+{
+  int i;
+  struct miniargv_defaults_segment_struct* segment;
+  for (i = 0; i < defaults->segmentcount; i++) {
+    segment = &defaults->segments[i];
+    if (offset >= segment->offset + segment->size || offset + size <= segment->offset)
+      continue;
+    if (offset > segment->offset && offset + size < segment->offset + segment->size) {
+      //split segment in two
+      if ((segment = (struct miniargv_defaults_segment_struct*)realloc(defaults->segments, (defaults->segmentcount + 1) * sizeof(struct miniargv_defaults_segment_struct))) == NULL)
+        return -1;
+      defaults->segments = segment;
+      memmove(segment + i + 1, segment + i, (defaults->segmentcount - i) * sizeof(struct miniargv_defaults_segment_struct));
+      defaults->segmentcount++;
+      segment[i].size = offset - segment[i].offset;
+      segment[i + 1].size = segment[i + 1].offset + segment[i + 1].size - (offset + size);
+      segment[i + 1].offset = offset + size;
+      return 0;
+    }
+    if (offset <= segment->offset) {
+      //cut off beginning of segment
+      if (offset + size >= segment->offset + segment->size) {
+        segment->size = 0;
+      } else {
+        segment->size -= offset + size - segment->offset;
+        segment->offset = offset + size;
+      }
+    } else {
+      //cut off end of segment
+      segment->size = offset - segment->offset;
+    }
+  }
+  return 0;
+}
+
+/* add default values of definitions to precomputed default values */
+static int miniargv_defaults_add (miniargv_defaults* defaults, const miniargv_definition argdef[])
+{
+  size_t size;
+  void* p;
+  miniargv_definition default_argdef;
+  union {
+    int intval;
+    long longval;
+    const char* strval;
+  } value;
+  const miniargv_definition* current_argdef = argdef;
+  while (current_argdef->callbackfn) {
+    if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+      if (miniargv_defaults_add(defaults, (struct miniargv_definition_struct*)(current_argdef->callbackfn)) != 0)
+        return -1;
+    } else {
+      //keep variables holding memory managed by the callback function out of the image (also without default value, as copying the initial state over them would leak or corrupt it)
+      if (defaults->store && (size = miniargv_defaults_protected_size(current_argdef->callbackfn)) != 0 && (unsigned char*)current_argdef->userdata >= defaults->store && (unsigned char*)current_argdef->userdata + size <= defaults->store + defaults->storesize) {
+        if (miniargv_defaults_protect(defaults, (unsigned char*)current_argdef->userdata - defaults->store, size) != 0)
+          return -1;
+      }
+      if (current_argdef->defaultvalue) {
+        if ((size = miniargv_defaults_value_size(current_argdef->callbackfn)) == 0) {
+          //call callback function when applying defaults
+          if ((p = realloc(defaults->callbacks, (defaults->callbackcount + 1) * sizeof(const miniargv_definition*))) == NULL)
+            return -1;
+          defaults->callbacks = (const miniargv_definition**)p;
+          defaults->callbacks[defaults->callbackcount++] = current_argdef;
+        } else {
+          //convert default value once
+          default_argdef = *current_argdef;
+          default_argdef.userdata = &value;
+          memset(&value, 0, sizeof(value));
+          if ((current_argdef->callbackfn)(&default_argdef, current_argdef->defaultvalue, NULL) != 0)
+            return -1;
+          if (defaults->store && (unsigned char*)current_argdef->userdata >= defaults->store && (unsigned char*)current_argdef->userdata + size <= defaults->store + defaults->storesize) {
+            //store in image
+            memcpy(defaults->image + ((unsigned char*)current_argdef->userdata - defaults->store), &value, size);
+          } else {
+            //store separately
+            if ((p = realloc(defaults->values, (defaults->valuecount + 1) * sizeof(struct miniargv_defaults_value_struct))) == NULL)
+              return -1;
+            defaults->values = (struct miniargv_defaults_value_struct*)p;
+            if ((p = realloc(defaults->valuedata, defaults->valuedatalen + size)) == NULL)
+              return -1;
+            defaults->valuedata = (unsigned char*)p;
+            memcpy(defaults->valuedata + defaults->valuedatalen, &value, size);
+            defaults->values[defaults->valuecount].target = (void*)current_argdef->userdata;
+            defaults->values[defaults->valuecount].offset = defaults->valuedatalen;
+            defaults->values[defaults->valuecount].size = size;
+            defaults->valuecount++;
+            defaults->valuedatalen += size;
+          }
+        }
+      }
+    }
+    current_argdef++;
+  }
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV miniargv_defaults* miniargv_defaults_create (const miniargv_definition argdef[], void* store, size_t storesize)
+{
+  miniargv_defaults* defaults;
+  if ((defaults = (miniargv_defaults*)calloc(1, sizeof(miniargv_defaults))) == NULL)
+    return NULL;
+  if (store && storesize > 0) {
+    //take image of store in its initial state
+    if ((defaults->image = (unsigned char*)malloc(storesize)) == NULL || (defaults->segments = (struct miniargv_defaults_segment_struct*)malloc(sizeof(struct miniargv_defaults_segment_struct))) == NULL) {
+      miniargv_defaults_free(defaults);
+      return NULL;
+    }
+    memcpy(defaults->image, store, storesize);
+    defaults->store = (unsigned char*)store;
+    defaults->storesize = storesize;
+    defaults->segments[0].offset = 0;
+    defaults->segments[0].size = storesize;
+    defaults->segmentcount = 1;
+  }
+  if (miniargv_defaults_add(defaults, argdef) != 0) {
+    miniargv_defaults_free(defaults);
+    return NULL;
+  }
+  return defaults;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_defaults_apply (const miniargv_defaults* defaults, void* callbackdata)
+{
+  int i;
+  int result;
+  //copy image to store
+  for (i = 0; i < defaults->segmentcount; i++)
+    memcpy(defaults->store + defaults->segments[i].offset, defaults->image + defaults->segments[i].offset, defaults->segments[i].size);
+  //write values outside of store
+  for (i = 0; i < defaults->valuecount; i++)
+    memcpy(defaults->values[i].target, defaults->valuedata + defaults->values[i].offset, defaults->values[i].size);
+  //call callback functions for the rest
+  for (i = 0; i < defaults->callbackcount; i++) {
+    if ((result = (defaults->callbacks[i]->callbackfn)(defaults->callbacks[i], defaults->callbacks[i]->defaultvalue, callbackdata)) != 0)
+      return result;
+  }
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV void miniargv_defaults_free (miniargv_defaults* defaults)
+{
+  if (!defaults)
+    return;
+  free(defaults->image);
+  free(defaults->segments);
+  free(defaults->values);
+  free(defaults->valuedata);
+  free(defaults->callbacks);
+  free(defaults);
+}
@@ -0,0 +1,136 @@
+#include "miniargv_internal.h"
+
+/* sorted dictionary files for completion */
+
+//dictionary file format version (a file written on a system with different byte order won't match)
+#define MINIARGV_DICT_VERSION 1
+
+/* header of dictionary file, followed by the offsets of the entries in sorted order and the NUL-terminated entries */
+struct miniargv_dict_header_struct {
+  char magic[8];                    //"MINIDICT"
+  uint32_t version;                 //MINIARGV_DICT_VERSION
+  uint32_t reserved;
+  uint64_t count;                   //number of entries
+};
+
+/* compare dictionary entries for sorting (byte order) */
+static int miniargv_dict_compare (const void* entry1, const void* entry2)
+{
+  return strcmp(*(const char**)entry1, *(const char**)entry2);
+}
+
+DLL_EXPORT_MINIARGV int miniargv_dict_build (const char* srcfile, const char* dictfile)
+{
+  struct miniargv_cfg_mapping_struct dict;
+  struct miniargv_dict_header_struct* header;
+  uint64_t* offsets;
+  char* data;
+  size_t datalen;
+  char** entries;
+  char* p;
+  char* end;
+  char* eol;
+  size_t count = 0;
+  size_t size = 0;
+  size_t i;
+  size_t n;
+  size_t len;
+  int status;
+  if (!srcfile || !dictfile || (data = miniargv_cfg_read(srcfile, &datalen)) == NULL)
+    return -1;
+  //count lines to allocate entries only once
+  for (p = data, end = data + datalen; p < end && (eol = (char*)memchr(p, '\n', end - p)) != NULL; p = eol + 1)
+    count++;
+  if ((entries = (char**)malloc((count + 1) * sizeof(char*))) == NULL) {
+    free(data);
+    return -1;
+  }
+  //split in NUL-terminated entries without line endings, skipping empty lines
+  count = 0;
+  for (p = data; p < end; p = eol + 1) {
+    if ((eol = (char*)memchr(p, '\n', end - p)) == NULL)
+      eol = end;
+    *eol = 0;
+    if (eol > p && eol[-1] == '\r')
+      eol[-1] = 0;
+    if (*p) {
+      entries[count++] = p;
+      size += strlen(p) + 1;
+    }
+  }
+  qsort(entries, count, sizeof(char*), miniargv_dict_compare);
+  //remove duplicates
+  for (i = 0, n = 0; i < count; i++) {
+    if (n > 0 && strcmp(entries[n - 1], entries[i]) == 0)
+      size -= strlen(entries[i]) + 1;
+    else
+      entries[n++] = entries[i];
+  }
+  count = n;
+  //build dictionary in memory and write it in one go
+  dict.mappedsize = 0;
+  dict.length = sizeof(struct miniargv_dict_header_struct) + count * sizeof(uint64_t) + size;
+  if ((dict.data = (char*)calloc(1, dict.length)) == NULL) {
+    free(entries);
+    free(data);
+    return -1;
+  }
+  header = (struct miniargv_dict_header_struct*)dict.data;
+  memcpy(header->magic, "MINIDICT", 8);
+  header->version = MINIARGV_DICT_VERSION;
+  header->count = count;
+  offsets = (uint64_t*)(header + 1);
+  p = (char*)(offsets + count);
+  for (i = 0; i < count; i++) {
+    len = strlen(entries[i]) + 1;
+    offsets[i] = p - dict.data;
+    memcpy(p, entries[i], len);
+    p += len;
+  }
+  status = miniargv_cfg_index_write(dictfile, &dict);
+  free(dict.data);
+  free(entries);
+  free(data);
+  return status;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_complete_dict (const char* dictfile, const char* arg, int argparampos, size_t maxresults)
+{
+  struct miniargv_cfg_mapping_struct dict;
+  const struct miniargv_dict_header_struct* header;
+  const uint64_t* offsets;
+  const char* prefix;
+  size_t prefixlen;
+  uint64_t first;
+  uint64_t last;
+  uint64_t middle;
+  int result = 0;
+  if (!dictfile || !arg || miniargv_cfg_map(dictfile, &dict) != 0)
+    return -1;
+  header = (const struct miniargv_dict_header_struct*)dict.data;
+  if (dict.length < sizeof(struct miniargv_dict_header_struct) || memcmp(header->magic, "MINIDICT", 8) != 0 || header->version != MINIARGV_DICT_VERSION || header->count > (dict.length - sizeof(struct miniargv_dict_header_struct)) / sizeof(uint64_t)) {
+    miniargv_cfg_unmap(&dict);
+    return -1;
+  }
+  offsets = (const uint64_t*)(header + 1);
+  prefix = arg + argparampos;
+  prefixlen = strlen(prefix);
+  //binary search for the first entry not sorted before the prefix (only the pages on the search path are touched)
+  first = 0;
+  last = header->count;
+  while (first < last) {
+    middle = first + (last - first) / 2;
+    if (offsets[middle] < dict.length && strcmp(dict.data + offsets[middle], prefix) < 0)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+  //list entries starting with the prefix (which follow each other)
+  while (first < header->count && offsets[first] < dict.length && strncmp(dict.data + offsets[first], prefix, prefixlen) == 0 && (maxresults == 0 || (size_t)result < maxresults)) {
+    printf("%.*s%s\n", argparampos, arg, dict.data + offsets[first]);
+    result++;
+    first++;
+  }
+  miniargv_cfg_unmap(&dict);
+  return result;
+}
@@ -0,0 +1,266 @@
+#include "miniargv_internal.h"
+
+/* canonical command line arguments and environment */
+
+//kinds of predefined callback functions whose variables can be emitted
+#define MINIARGV_EMIT_NUMBER    1   //value is number
+#define MINIARGV_EMIT_BOOLEAN   2   //value is boolean
+#define MINIARGV_EMIT_STRING    3   //value is string
+#define MINIARGV_EMIT_FLAG      4   //flag sets variable to target value
+#define MINIARGV_EMIT_INCREMENT 5   //flag increments variable
+#define MINIARGV_EMIT_DECREMENT 6   //flag decrements variable
+
+/* predefined callback function whose variable can be emitted */
+struct miniargv_emit_callback_struct {
+  miniargv_handler_fn callbackfn;
+  int kind;
+  size_t size;                      //size of variable (sizeof(int), sizeof(long) or sizeof(const char*))
+  long target;                      //value set by MINIARGV_EMIT_FLAG callback functions
+};
+
+static const struct miniargv_emit_callback_struct miniargv_emit_callbacks[] = {
+  {miniargv_cb_set_int, MINIARGV_EMIT_NUMBER, sizeof(int), 0},
+  {miniargv_cb_set_long, MINIARGV_EMIT_NUMBER, sizeof(long), 0},
+  {miniargv_cb_set_boolean, MINIARGV_EMIT_BOOLEAN, sizeof(int), 0},
+  {miniargv_cb_set_const_str, MINIARGV_EMIT_STRING, sizeof(const char*), 0},
+  {miniargv_cb_strdup, MINIARGV_EMIT_STRING, sizeof(char*), 0},
+  {miniargv_cb_set_int_to_zero, MINIARGV_EMIT_FLAG, sizeof(int), 0},
+  {miniargv_cb_set_int_to_one, MINIARGV_EMIT_FLAG, sizeof(int), 1},
+  {miniargv_cb_set_int_to_minus_one, MINIARGV_EMIT_FLAG, sizeof(int), -1},
+  {miniargv_cb_set_long_to_zero, MINIARGV_EMIT_FLAG, sizeof(long), 0},
+  {miniargv_cb_set_long_to_one, MINIARGV_EMIT_FLAG, sizeof(long), 1},
+  {miniargv_cb_set_long_to_minus_one, MINIARGV_EMIT_FLAG, sizeof(long), -1},
+  {miniargv_cb_increment_int, MINIARGV_EMIT_INCREMENT, sizeof(int), 0},
+  {miniargv_cb_increment_long, MINIARGV_EMIT_INCREMENT, sizeof(long), 0},
+  {miniargv_cb_decrement_int, MINIARGV_EMIT_DECREMENT, sizeof(int), 0},
+  {miniargv_cb_decrement_long, MINIARGV_EMIT_DECREMENT, sizeof(long), 0},
+  {NULL, 0, 0, 0}
+};
+
+/* arguments and environment variables being emitted (only counted and measured while items is NULL) */
+struct miniargv_emit_struct {
+  char** items;
+  size_t count;
+  char* strings;
+  size_t stringslen;
+  const void** done;                //variables already emitted
+  size_t donecount;
+  size_t donesize;
+};
+
+/* add item consisting of up to 4 concatenated parts (unused parts are NULL) */
+static void miniargv_emit_item (struct miniargv_emit_struct* emit, const char* part1, const char* part2, const char* part3, const char* part4)
+{
+  const char* parts[4] = {part1, part2, part3, part4};
+  size_t len;
+  int i;
+  if (emit->items)
+    emit->items[emit->count] = emit->strings + emit->stringslen;
+  emit->count++;
+  for (i = 0; i < 4; i++) {
+    if (parts[i]) {
+      len = strlen(parts[i]);
+      if (emit->items)
+        memcpy(emit->strings + emit->stringslen, parts[i], len);
+      emit->stringslen += len;
+    }
+  }
+  if (emit->items)
+    emit->strings[emit->stringslen] = 0;
+  emit->stringslen++;
+}
+
+/* get value variable had before processing (from precomputed defaults if available, otherwise converted default value or zero) */
+static void miniargv_emit_initial_value (const miniargv_definition* argdef, const struct miniargv_emit_callback_struct* callback, const miniargv_defaults* defaults, void* initialvalue)
+{
+  int i;
+  miniargv_definition default_argdef;
+  if (callback->callbackfn == miniargv_cb_strdup) {
+    //applying defaults duplicates the default value
+    *(const char**)initialvalue = argdef->defaultvalue;
+    return;
+  }
+  if (defaults) {
+    if (defaults->store && (unsigned char*)argdef->userdata >= defaults->store && (unsigned char*)argdef->userdata + callback->size <= defaults->store + defaults->storesize) {
+      memcpy(initialvalue, defaults->image + ((unsigned char*)argdef->userdata - defaults->store), callback->size);
+      return;
+    }
+    for (i = 0; i < defaults->valuecount; i++) {
+      if (defaults->values[i].target == argdef->userdata && defaults->values[i].size == callback->size) {
+        memcpy(initialvalue, defaults->valuedata + defaults->values[i].offset, callback->size);
+        return;
+      }
+    }
+  }
+  if (argdef->defaultvalue && miniargv_defaults_value_size(argdef->callbackfn) == callback->size) {
+    default_argdef = *argdef;
+    default_argdef.userdata = initialvalue;
+    (argdef->callbackfn)(&default_argdef, argdef->defaultvalue, NULL);
+  }
+}
+
+/* emit definition as command line argument or environment variable if its variable differs from its initial value, returns 0 on success */
+static int miniargv_emit_definition (struct miniargv_emit_struct* emit, const miniargv_definition* argdef, const miniargv_defaults* defaults, int isenv)
+{
+  const struct miniargv_emit_callback_struct* callback;
+  union {
+    int intval;
+    long longval;
+    const char* strval;
+  } initialvalue;
+  long current = 0;
+  long initial = 0;
+  long repeat = 0;
+  const char* value = NULL;
+  const void** done;
+  char buf[24];
+  char shortarg[3] = {'-', argdef->shortarg, 0};
+  size_t i;
+  //only variables set by supported predefined callback functions can be emitted
+  if (!argdef->userdata || !(argdef->longarg || (argdef->shortarg && !isenv)))
+    return 0;
+  for (callback = miniargv_emit_callbacks; callback->callbackfn && callback->callbackfn != argdef->callbackfn; callback++)
+    ;
+  if (!callback->callbackfn)
+    return 0;
+  //skip variables already emitted by another definition
+  for (i = 0; i < emit->donecount; i++) {
+    if (emit->done[i] == argdef->userdata)
+      return 0;
+  }
+  //compare current value with initial value
+  memset(&initialvalue, 0, sizeof(initialvalue));
+  miniargv_emit_initial_value(argdef, callback, defaults, &initialvalue);
+  if (callback->kind == MINIARGV_EMIT_STRING) {
+    value = *(const char**)argdef->userdata;
+    if (value && initialvalue.strval && strcmp(value, initialvalue.strval) == 0)
+      value = NULL;
+  } else {
+    current = (callback->size == sizeof(int) ? *(int*)argdef->userdata : *(long*)argdef->userdata);
+    initial = (callback->size == sizeof(int) ? initialvalue.intval : initialvalue.longval);
+    if (current == initial)
+      return 0;
+    switch (callback->kind) {
+      case MINIARGV_EMIT_NUMBER :
+        snprintf(buf, sizeof(buf), "%li", current);
+        value = buf;
+        break;
+      case MINIARGV_EMIT_BOOLEAN :
+        value = (current ? "1" : "0");
+        break;
+      case MINIARGV_EMIT_FLAG :
+        repeat = (current == callback->target ? 1 : 0);
+        break;
+      case MINIARGV_EMIT_INCREMENT :
+        repeat = (isenv ? (current > initial) : current - initial);
+        break;
+      case MINIARGV_EMIT_DECREMENT :
+        repeat = (isenv ? (current < initial) : initial - current);
+        break;
+    }
+  }
+  if (!value && repeat <= 0)
+    return 0;
+  //remember variable was emitted
+  if (emit->donecount >= emit->donesize) {
+    emit->donesize = (emit->donesize ? emit->donesize * 2 : 16);
+    if ((done = (const void**)realloc(emit->done, emit->donesize * sizeof(const void*))) == NULL)
+      return -1;
+    emit->done = done;
+  }
+  emit->done[emit->donecount++] = argdef->userdata;
+  //add environment variable or argument(s) (escaping values starting with @ if they would be read from a file)
+  if (isenv) {
+    miniargv_emit_item(emit, argdef->longarg, "=", (value ? value : "1"), NULL);
+  } else if (!value) {
+    while (repeat-- > 0)
+      miniargv_emit_item(emit, (argdef->longarg ? "--" : shortarg), argdef->longarg, NULL, NULL);
+  } else if (argdef->longarg) {
+    miniargv_emit_item(emit, "--", argdef->longarg, ((argdef->flags & MINIARGV_FLAG_FILE_VALUE) && *value == '@' ? "=@" : "="), value);
+  } else {
+    miniargv_emit_item(emit, shortarg, NULL, NULL, NULL);
+    miniargv_emit_item(emit, ((argdef->flags & MINIARGV_FLAG_FILE_VALUE) && *value == '@' ? "@" : NULL), value, NULL, NULL);
+  }
+  return 0;
+}
+
+/* emit all definitions (including included definitions), returns 0 on success */
+static int miniargv_emit_definitions (struct miniargv_emit_struct* emit, const miniargv_definition argdef[], const miniargv_defaults* defaults, int isenv)
+{
+  const miniargv_definition* current_argdef = argdef;
+  while (current_argdef->callbackfn) {
+    if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+      if (miniargv_emit_definitions(emit, (struct miniargv_definition_struct*)(current_argdef->callbackfn), defaults, isenv) != 0)
+        return -1;
+    } else if (miniargv_emit_definition(emit, current_argdef, defaults, isenv) != 0) {
+      return -1;
+    }
+    current_argdef++;
+  }
+  return 0;
+}
+
+/* check if environment variable name is defined (exact match) */
+static int miniargv_emit_env_defined (const char* name, size_t namelen, const miniargv_definition envdef[])
+{
+  const miniargv_definition* current_envdef = envdef;
+  while (current_envdef->callbackfn) {
+    if (current_envdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+      if (miniargv_emit_env_defined(name, namelen, (struct miniargv_definition_struct*)(current_envdef->callbackfn)))
+        return 1;
+    } else if (current_envdef->longarg && strncmp(current_envdef->longarg, name, namelen) == 0 && current_envdef->longarg[namelen] == 0) {
+      return 1;
+    }
+    current_envdef++;
+  }
+  return 0;
+}
+
+/* emit command line arguments followed by environment (if newenv is not NULL), returns 0 on success */
+static int miniargv_emit_all (struct miniargv_emit_struct* emit, const char* argv0, const miniargv_definition argdef[], char* env[], const miniargv_definition envdef[], const miniargv_defaults* defaults, char*** newenv)
+{
+  char** current_env;
+  const char* s;
+  emit->donecount = 0;
+  if (argv0)
+    miniargv_emit_item(emit, argv0, NULL, NULL, NULL);
+  if (argdef && miniargv_emit_definitions(emit, argdef, defaults, 0) != 0)
+    return -1;
+  if (emit->items)
+    emit->items[emit->count] = NULL;
+  emit->count++;
+  if (newenv) {
+    if (emit->items)
+      *newenv = emit->items + emit->count;
+    //copy environment except for variables that are (re)defined
+    for (current_env = env; current_env && *current_env; current_env++) {
+      if ((s = strchr(*current_env, '=')) == NULL || !envdef || !miniargv_emit_env_defined(*current_env, s - *current_env, envdef))
+        miniargv_emit_item(emit, *current_env, NULL, NULL, NULL);
+    }
+    if (envdef && miniargv_emit_definitions(emit, envdef, defaults, 1) != 0)
+      return -1;
+    if (emit->items)
+      emit->items[emit->count] = NULL;
+    emit->count++;
+  }
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV char** miniargv_emit (const char* argv0, const miniargv_definition argdef[], char* env[], const miniargv_definition envdef[], const miniargv_defaults* defaults, char*** newenv)
+{
+  struct miniargv_emit_struct emit = {NULL, 0, NULL, 0, NULL, 0, 0};
+  char** result = NULL;
+  //determine size first, so everything fits in a single allocation
+  if (miniargv_emit_all(&emit, argv0, argdef, env, envdef, defaults, newenv) == 0 && (result = (char**)malloc(emit.count * sizeof(char*) + emit.stringslen)) != NULL) {
+    emit.items = result;
+    emit.strings = (char*)(result + emit.count);
+    emit.count = 0;
+    emit.stringslen = 0;
+    if (miniargv_emit_all(&emit, argv0, argdef, env, envdef, defaults, newenv) != 0) {
+      free(result);
+      result = NULL;
+    }
+  }
+  free(emit.done);
+  return result;
+}
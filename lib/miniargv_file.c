@@ -0,0 +1,118 @@
+#include "miniargv_internal.h"
+
+/* reading and mapping files */
+
+//initial buffer size for reading configuration files
+#define MINIARGV_CFG_BLOCK_SIZE 4096
+
+/* read entire file in memory (followed by MINIARGV_CFG_PADDING + 1 NUL characters), returns NULL on error */
+char* miniargv_cfg_read (const char* path, size_t* length)
+{
+  FILE* src;
+  char* data = NULL;
+  char* newdata;
+  size_t size = 0;
+  size_t len = 0;
+  size_t n;
+  if ((src = fopen(path, "rb")) == NULL)
+    return NULL;
+  do {
+    //grow buffer exponentially
+    if (len + MINIARGV_CFG_PADDING + 1 >= size) {
+      size = (size ? size * 2 : MINIARGV_CFG_BLOCK_SIZE);
+      if ((newdata = (char*)realloc(data, size)) == NULL) {
+        free(data);
+        fclose(src);
+        return NULL;
+      }
+      data = newdata;
+    }
+    n = fread(data + len, 1, size - len - MINIARGV_CFG_PADDING - 1, src);
+    len += n;
+  } while (n > 0);
+  fclose(src);
+  memset(data + len, 0, MINIARGV_CFG_PADDING + 1);
+  *length = len;
+  return data;
+}
+
+/* map file in memory as private copy, returns 0 on success */
+int miniargv_cfg_map (const char* path, struct miniargv_cfg_mapping_struct* mapping)
+{
+#ifndef _WIN32
+  int fd;
+  size_t pagesize;
+  void* base;
+#endif
+  mapping->data = NULL;
+  mapping->length = 0;
+  mapping->mappedsize = 0;
+#ifndef _WIN32
+  if ((fd = open(path, O_RDONLY)) == -1)
+    return -1;
+  if (fstat(fd, &mapping->statbuf) != 0) {
+    close(fd);
+    return -1;
+  }
+  if (S_ISREG(mapping->statbuf.st_mode)) {
+    //reserve zero-filled memory for the padding and map the file over it (writable, as values are parsed in place)
+    pagesize = sysconf(_SC_PAGESIZE);
+    mapping->length = mapping->statbuf.st_size;
+    mapping->mappedsize = (mapping->length + MINIARGV_CFG_PADDING + pagesize) / pagesize * pagesize;
+    if ((base = mmap(NULL, mapping->mappedsize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) != MAP_FAILED) {
+      if (mapping->length == 0 || mmap(base, mapping->length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED)
+        mapping->data = (char*)base;
+      else
+        munmap(base, mapping->mappedsize);
+    }
+  }
+  close(fd);
+  if (mapping->data)
+    return 0;
+  mapping->mappedsize = 0;
+#else
+  if (stat(path, &mapping->statbuf) != 0)
+    return -1;
+#endif
+  //read file in memory if it wasn't mapped
+  return ((mapping->data = miniargv_cfg_read(path, &mapping->length)) != NULL ? 0 : -1);
+}
+
+/* release file mapped by miniargv_cfg_map() */
+void miniargv_cfg_unmap (struct miniargv_cfg_mapping_struct* mapping)
+{
+#ifndef _WIN32
+  if (mapping->mappedsize)
+    munmap(mapping->data, mapping->mappedsize);
+  else
+#endif
+    free(mapping->data);
+  mapping->data = NULL;
+}
+
+/* write index next to configuration file (via a temporary file to avoid other processes reading a partial file), returns 0 on success */
+int miniargv_cfg_index_write (const char* indexpath, const struct miniargv_cfg_mapping_struct* index)
+{
+  FILE* dst;
+  char* tmppath;
+  size_t len = strlen(indexpath);
+  int status = -1;
+  if ((tmppath = (char*)malloc(len + 32)) == NULL)
+    return -1;
+  snprintf(tmppath, len + 32, "%s.%lu.tmp", indexpath, (unsigned long)getpid());
+  if ((dst = fopen(tmppath, "wb")) != NULL) {
+    status = (fwrite(index->data, 1, index->length, dst) == index->length ? 0 : -1);
+    if (fclose(dst) != 0)
+      status = -1;
+#ifdef _WIN32
+    if (status == 0)
+      remove(indexpath);
+#endif
+    if (status == 0)
+      status = rename(tmppath, indexpath);
+    if (status != 0)
+      remove(tmppath);
+  }
+  free(tmppath);
+  return status;
+}
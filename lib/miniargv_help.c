@@ -0,0 +1,437 @@
+#include "miniargv_internal.h"
+
+/* compressed help texts */
+
+/* compressed help texts registered for a definition table */
+struct miniargv_help_blob_struct {
+  const miniargv_definition* argdef;
+  const unsigned char* data;
+  size_t size;
+  struct miniargv_help_blob_struct* next;
+};
+
+
+/* list of registered compressed help texts */
+static struct miniargv_help_blob_struct* miniargv_help_blobs = NULL;
+static int miniargv_help_blobs_lock = 0;
+
+static void miniargv_help_blobs_acquire ()
+{
+  int expected = 0;
+  while (!MINIARGV_ATOMIC_CAS(&miniargv_help_blobs_lock, &expected, 1)) {
+    expected = 0;
+    MINIARGV_YIELD();
+  }
+}
+
+static void miniargv_help_blobs_release ()
+{
+  MINIARGV_ATOMIC_STORE(&miniargv_help_blobs_lock, 0);
+}
+
+/* read 32-bit value from compressed help texts (which may not be aligned) */
+static uint32_t miniargv_help_blob_get (const unsigned char* data, size_t offset)
+{
+  uint32_t result;
+  memcpy(&result, data + offset, sizeof(result));
+  return result;
+}
+
+/* prepare for getting help texts of definition table */
+void miniargv_help_text_init (struct miniargv_help_text_struct* helptext, const miniargv_definition argdef[])
+{
+  struct miniargv_help_blob_struct* blob;
+  helptext->data = NULL;
+  helptext->size = 0;
+  helptext->valid = 0;
+  helptext->buffer = NULL;
+  miniargv_help_blobs_acquire();
+  for (blob = miniargv_help_blobs; blob; blob = blob->next) {
+    if (blob->argdef == argdef) {
+      helptext->data = blob->data;
+      helptext->size = blob->size;
+      break;
+    }
+  }
+  miniargv_help_blobs_release();
+}
+
+void miniargv_help_text_free (struct miniargv_help_text_struct* helptext)
+{
+  free(helptext->buffer);
+  helptext->buffer = NULL;
+}
+
+/* check if compressed help texts are complete and allocate buffer for uncompressed text, returns non-zero if valid */
+static int miniargv_help_text_check (struct miniargv_help_text_struct* helptext)
+{
+  helptext->valid = -1;
+  if (!helptext->data || helptext->size < sizeof(struct miniargv_help_blob_header_struct))
+    return 0;
+  memcpy(&helptext->header, helptext->data, sizeof(struct miniargv_help_blob_header_struct));
+  if (memcmp(helptext->header.magic, "MINIHELP", 8) != 0 || helptext->header.version != MINIARGV_HELP_BLOB_VERSION)
+    return 0;
+  if (helptext->header.wordcount > MINIARGV_HELP_BLOB_MAX_WORDS || helptext->header.count > (helptext->size - sizeof(struct miniargv_help_blob_header_struct)) / sizeof(uint32_t))
+    return 0;
+  helptext->words = sizeof(struct miniargv_help_blob_header_struct) + ((size_t)helptext->header.wordcount + 1 + helptext->header.count + 1) * sizeof(uint32_t);
+  if (helptext->words > helptext->size)
+    return 0;
+  helptext->texts = helptext->words + miniargv_help_blob_get(helptext->data, sizeof(struct miniargv_help_blob_header_struct) + helptext->header.wordcount * sizeof(uint32_t));
+  if (helptext->texts > helptext->size || helptext->texts + miniargv_help_blob_get(helptext->data, sizeof(struct miniargv_help_blob_header_struct) + ((size_t)helptext->header.wordcount + 1 + helptext->header.count) * sizeof(uint32_t)) > helptext->size)
+    return 0;
+  if ((helptext->buffer = (char*)malloc(helptext->header.maxlength + 1)) == NULL)
+    return 0;
+  helptext->valid = 1;
+  return 1;
+}
+
+/* get help text of definition at the specified position (counting all definitions including the included ones in order), returns NULL if not available */
+const char* miniargv_help_text_get (struct miniargv_help_text_struct* helptext, const miniargv_definition* argdef, uint32_t position)
+{
+  const unsigned char* data = helptext->data;
+  size_t offsets = sizeof(struct miniargv_help_blob_header_struct);
+  size_t i;
+  size_t end;
+  size_t len = 0;
+  size_t wordstart;
+  size_t wordend;
+  uint32_t word;
+  if (!argdef->help || argdef->help[0] != MINIARGV_HELP_COMPRESSED[0] || argdef->help[1])
+    return argdef->help;
+  if (helptext->valid == 0)
+    miniargv_help_text_check(helptext);
+  if (helptext->valid < 0 || position >= helptext->header.count)
+    return NULL;
+  //offsets of words are followed by offsets of texts
+  i = helptext->texts + miniargv_help_blob_get(data, offsets + ((size_t)helptext->header.wordcount + 1 + position) * sizeof(uint32_t));
+  end = helptext->texts + miniargv_help_blob_get(data, offsets + ((size_t)helptext->header.wordcount + 1 + position + 1) * sizeof(uint32_t));
+  if (end > helptext->size)
+    end = helptext->size;
+  //expand words from the dictionary and copy literal characters
+  while (i < end) {
+    if (data[i] < 0x80) {
+      if (len >= helptext->header.maxlength)
+        break;
+      helptext->buffer[len++] = data[i++];
+    } else if (data[i] == MINIARGV_HELP_BLOB_ESCAPE) {
+      if (i + 1 >= end || len >= helptext->header.maxlength)
+        break;
+      helptext->buffer[len++] = data[i + 1];
+      i += 2;
+    } else {
+      if (i + 1 >= end || (word = (data[i] - 0x80) * 256 + data[i + 1]) >= helptext->header.wordcount)
+        break;
+      i += 2;
+      wordstart = helptext->words + miniargv_help_blob_get(data, offsets + (size_t)word * sizeof(uint32_t));
+      wordend = helptext->words + miniargv_help_blob_get(data, offsets + ((size_t)word + 1) * sizeof(uint32_t));
+      if (wordend < wordstart || wordend > helptext->texts || len + (wordend - wordstart) > helptext->header.maxlength)
+        break;
+      memcpy(helptext->buffer + len, data + wordstart, wordend - wordstart);
+      len += wordend - wordstart;
+    }
+  }
+  helptext->buffer[len] = 0;
+  return helptext->buffer;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_set_compressed_help (const miniargv_definition argdef[], const void* blob, size_t blobsize)
+{
+  struct miniargv_help_blob_struct* current;
+  struct miniargv_help_blob_struct** p;
+  if (!argdef)
+    return -1;
+  miniargv_help_blobs_acquire();
+  for (p = &miniargv_help_blobs; *p && (*p)->argdef != argdef; p = &(*p)->next)
+    ;
+  if (!blob) {
+    //unregister
+    if ((current = *p) != NULL) {
+      *p = current->next;
+      free(current);
+    }
+  } else {
+    if ((current = *p) == NULL) {
+      if ((current = (struct miniargv_help_blob_struct*)malloc(sizeof(struct miniargv_help_blob_struct))) == NULL) {
+        miniargv_help_blobs_release();
+        return -1;
+      }
+      current->argdef = argdef;
+      current->next = miniargv_help_blobs;
+      miniargv_help_blobs = current;
+    }
+    current->data = (const unsigned char*)blob;
+    current->size = blobsize;
+  }
+  miniargv_help_blobs_release();
+  return 0;
+}
+
+/* write example configuration file entries for definitions (position counts all definitions including the included ones) */
+static void miniargv_cfgfile_generate_entries (FILE* cfgfile, const miniargv_definition cfgdef[], struct miniargv_help_text_struct* helptext, uint32_t* position)
+{
+  const miniargv_definition* current_cfgdef = cfgdef;
+  static const char* help_indent = "\n;   ";
+  while (current_cfgdef->callbackfn) {
+    if (current_cfgdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+      miniargv_cfgfile_generate_entries(cfgfile, (struct miniargv_definition_struct*)(current_cfgdef->callbackfn), helptext, position);
+    } else {
+      if (current_cfgdef->longarg) {
+        fprintf(cfgfile, "; %s:%s", current_cfgdef->longarg, help_indent);
+        miniargv_wrap_and_indent_text(cfgfile, miniargv_help_text_get(helptext, current_cfgdef, *position), 0, 0, 79 - 4, help_indent);
+        fprintf(cfgfile, "\n%s = %s\n\n", current_cfgdef->longarg, (current_cfgdef->defaultvalue ? current_cfgdef->defaultvalue : (current_cfgdef->argparam ? current_cfgdef->argparam : "")));
+      }
+      (*position)++;
+    }
+    current_cfgdef++;
+  }
+}
+
+DLL_EXPORT_MINIARGV void miniargv_cfgfile_generate (FILE* cfgfile, const miniargv_definition cfgdef[])
+{
+  struct miniargv_help_text_struct helptext;
+  uint32_t position = 0;
+  miniargv_help_text_init(&helptext, cfgdef);
+  miniargv_cfgfile_generate_entries(cfgfile, cfgdef, &helptext, &position);
+  miniargv_help_text_free(&helptext);
+}
+
+DLL_EXPORT_MINIARGV unsigned int miniargv_arg_list (const miniargv_definition argdef[], int shortonly)
+{
+  unsigned int count = 0;
+  const miniargv_definition* current_argdef = argdef;
+  while (current_argdef->callbackfn) {
+    if (count > 0)
+      printf(" ");
+    if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+      //note: if the next command prints nothing and it's the last entry there will be an extra space at the end
+      count += miniargv_arg_list((struct miniargv_definition_struct*)(current_argdef->callbackfn), shortonly);
+    } else {
+      if (current_argdef->shortarg  || current_argdef->longarg) {
+        printf("[");
+        if (current_argdef->shortarg) {
+          printf("-%c", current_argdef->shortarg);
+          if (current_argdef->argparam)
+            printf(" %s", current_argdef->argparam);
+        }
+        if (current_argdef->longarg && !(shortonly && current_argdef->shortarg)) {
+          if (current_argdef->shortarg)
+            printf("|");
+          printf("--%s", current_argdef->longarg);
+          if (current_argdef->argparam)
+            printf("=%s", current_argdef->argparam);
+        }
+        printf("]");
+      } else {
+        printf("%s", (current_argdef->argparam ? current_argdef->argparam : "param"));
+      }
+      count++;
+    }
+    current_argdef++;
+  }
+  return count;
+}
+
+DLL_EXPORT_MINIARGV unsigned int miniargv_env_list (const miniargv_definition envdef[], int noparam)
+{
+  unsigned int count = 0;
+  const miniargv_definition* current_envdef = envdef;
+  while (current_envdef->callbackfn) {
+    if (count > 0)
+      printf(" ");
+    if (current_envdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+      //note: if the next command prints nothing and it's the last entry there will be an extra space at the end
+      count += miniargv_env_list((struct miniargv_definition_struct*)(current_envdef->callbackfn), noparam);
+    } else {
+      if (current_envdef->longarg) {
+        printf("%s", current_envdef->longarg);
+        if (!noparam && current_envdef->argparam)
+          printf("=%s", current_envdef->argparam);
+        count++;
+      }
+    }
+    current_envdef++;
+  }
+  return count;
+}
+
+/* show help for a single command line argument */
+void miniargv_arg_help_entry (const miniargv_definition* current_argdef, const char* help, int descindent, int wrapwidth)
+{
+  int pos;
+  pos = printf("  ");
+  if (!current_argdef->shortarg && !current_argdef->longarg) {
+    pos += printf("%s", (current_argdef->argparam ? current_argdef->argparam : "param"));
+  } else {
+    if (current_argdef->shortarg) {
+      pos += printf("-%c", current_argdef->shortarg);
+      if (current_argdef->argparam && !current_argdef->longarg)
+        pos += printf(" %s", current_argdef->argparam);
+    }
+    if (current_argdef->longarg) {
+      if (current_argdef->shortarg)
+        pos += printf(", ");
+      pos += printf("--%s", current_argdef->longarg);
+      if (current_argdef->argparam)
+        pos += printf("=%s", current_argdef->argparam);
+    }
+  }
+  if (pos > descindent - 2)
+    printf("\n%*s", descindent, "");
+  else
+    printf("%*s", (pos < descindent ? descindent - pos : 2), "");
+  miniargv_wrap_and_indent_text(stdout, help, descindent, descindent, wrapwidth, NULL);
+  printf("\n");
+}
+
+/* show help for command line arguments (position counts all definitions including the included ones) */
+static void miniargv_arg_help_entries (const miniargv_definition argdef[], int descindent, int wrapwidth, struct miniargv_help_text_struct* helptext, uint32_t* position)
+{
+  const miniargv_definition* current_argdef = argdef;
+  while (current_argdef->callbackfn) {
+    if (current_argdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+      //note: if the next command prints nothing and it's the last entry there will be an extra space at the end
+      miniargv_arg_help_entries((struct miniargv_definition_struct*)(current_argdef->callbackfn), descindent, wrapwidth, helptext, position);
+    } else {
+      miniargv_arg_help_entry(current_argdef, miniargv_help_text_get(helptext, current_argdef, *position), descindent, wrapwidth);
+      (*position)++;
+    }
+    current_argdef++;
+  }
+}
+
+DLL_EXPORT_MINIARGV void miniargv_arg_help (const miniargv_definition argdef[], int descindent, int wrapwidth)
+{
+  struct miniargv_help_text_struct helptext;
+  uint32_t position = 0;
+  if (!descindent)
+    descindent = 25;
+  miniargv_help_text_init(&helptext, argdef);
+  miniargv_arg_help_entries(argdef, descindent, wrapwidth, &helptext, &position);
+  miniargv_help_text_free(&helptext);
+}
+
+/* show help for environment variables (position counts all definitions including the included ones) */
+static void miniargv_env_help_entries (const miniargv_definition envdef[], int descindent, int wrapwidth, struct miniargv_help_text_struct* helptext, uint32_t* position)
+{
+  int pos;
+  const miniargv_definition* current_envdef = envdef;
+  while (current_envdef->callbackfn) {
+    if (current_envdef->shortarg == MINIARGV_DEFINITION_INCLUDE_SHORTARG) {
+      //note: if the next command prints nothing and it's the last entry there will be an extra space at the end
+      miniargv_env_help_entries((struct miniargv_definition_struct*)(current_envdef->callbackfn), descindent, wrapwidth, helptext, position);
+    } else {
+      pos = printf("  ");
+      if (!current_envdef->shortarg && !current_envdef->longarg) {
+        pos += printf(" %s", (current_envdef->argparam ? current_envdef->argparam : "param"));
+      } else {
+        if (current_envdef->longarg) {
+          if (current_envdef->shortarg)
+            pos += printf(", ");
+          pos += printf("%s", current_envdef->longarg);
+          if (current_envdef->argparam)
+            pos += printf("=%s", current_envdef->argparam);
+        }
+      }
+      if (pos > descindent - 2)
+        printf("\n%*s", descindent, "");
+      else
+        printf("%*s", (pos < descindent ? descindent - pos : 2), "");
+      miniargv_wrap_and_indent_text(stdout, miniargv_help_text_get(helptext, current_envdef, *position), descindent, descindent, wrapwidth, NULL);
+      printf("\n");
+      (*position)++;
+    }
+    current_envdef++;
+  }
+}
+
+DLL_EXPORT_MINIARGV void miniargv_env_help (const miniargv_definition envdef[], int descindent, int wrapwidth)
+{
+  struct miniargv_help_text_struct helptext;
+  uint32_t position = 0;
+  if (!descindent)
+    descindent = 25;
+  miniargv_help_text_init(&helptext, envdef);
+  miniargv_env_help_entries(envdef, descindent, wrapwidth, &helptext, &position);
+  miniargv_help_text_free(&helptext);
+}
+
+DLL_EXPORT_MINIARGV void miniargv_help (const miniargv_definition argdef[], const miniargv_definition envdef[], int descindent, int wrapwidth)
+{
+  if (argdef) {
+    printf("Command line arguments:\n");
+    miniargv_arg_help(argdef, descindent, wrapwidth);
+  }
+  if (envdef) {
+    printf("Environment variables:\n");
+    miniargv_env_help(envdef, descindent, wrapwidth);
+  }
+}
+
+DLL_EXPORT_MINIARGV void miniargv_wrap_and_indent_text (FILE* dst, const char* text, int currentpos, int indentpos, int wrapwidth, const char* newline)
+{
+  const char* p;
+  const char* q;
+  const char* r;
+  //set default wrap with if not specified
+  if (!wrapwidth)
+    wrapwidth = 79;
+  p = text;
+  //process text
+  while (p) {
+    q = p;
+    r = p;
+    //find wrap position
+    do {
+      //find first blank space
+      while (*r && !isspace(*r))
+        r++;
+      //check if wrap position was exceeded
+      if (currentpos + (r - p) > wrapwidth) {
+        //if single word exceeds maximum width show it as a whole anyway
+        if (q == p)
+          q = r;
+        break;
+      }
+      q = r;
+      //wrap if line break was found
+      if (*r == '\n')
+        break;
+      //skip blank space
+      while (*r && isspace(*r))
+        r++;
+    } while (*r);
+    //print line
+    if (!*q) {
+      //print as a whole if last section of text
+      fprintf(dst, "%s", p);
+      p = NULL;
+    } else {
+      //print partial text, go to new line and indent
+      fprintf(dst, "%.*s%s%*s", (int)(q - p), p, (newline ? newline : "\n"), indentpos, "");
+      currentpos = indentpos;
+      //skip blank space
+      p = q;
+      while (isspace(*p))
+        p++;
+    }
+  }
+}
+
+DLL_EXPORT_MINIARGV void miniargv_applet_help (const miniargv_applet applets[], int descindent, int wrapwidth)
+{
+  int pos;
+  const miniargv_applet* current_applet = applets;
+  if (!descindent)
+    descindent = 25;
+  while (current_applet->name) {
+    pos = printf("  %s", current_applet->name);
+    if (pos > descindent - 2)
+      printf("\n%*s", descindent, "");
+    else
+      printf("%*s", (pos < descindent ? descindent - pos : 2), "");
+    if (current_applet->help)
+      miniargv_wrap_and_indent_text(stdout, current_applet->help, descindent, descindent, wrapwidth, NULL);
+    printf("\n");
+    current_applet++;
+  }
+}
@@ -0,0 +1,205 @@
+#include "miniargv_internal.h"
+
+/* compressing help texts */
+
+/* word found in help texts while compressing */
+struct miniargv_help_compress_word_struct {
+  char* word;
+  size_t len;
+  size_t count;                     //number of occurrences
+  uint32_t code;                    //position in dictionary + 1, or 0 if not in dictionary
+};
+
+/* words found while compressing help texts */
+struct miniargv_help_compress_struct {
+  struct miniargv_help_compress_word_struct* words;
+  size_t wordcount;
+  size_t wordsize;
+  unsigned int mask;                //size of hashtable - 1
+  size_t* hashtable;                //hash table with position in words + 1 for each word, 0 for empty slots (at most half full)
+};
+
+/* get length of word at the start of text (ASCII letters only, so the dictionary never contains characters that need escaping) */
+static size_t miniargv_help_compress_word_length (const char* text)
+{
+  size_t len = 0;
+  while ((text[len] >= 'a' && text[len] <= 'z') || (text[len] >= 'A' && text[len] <= 'Z'))
+    len++;
+  return len;
+}
+
+/* find word in hash table, returns position in words + 1 or 0 if not found and sets slot to where it was found or can be added */
+static size_t miniargv_help_compress_find (const struct miniargv_help_compress_struct* compress, const char* word, size_t len, unsigned int* slot)
+{
+  size_t i;
+  *slot = miniargv_hash(word, len) & compress->mask;
+  while ((i = compress->hashtable[*slot]) != 0 && (compress->words[i - 1].len != len || memcmp(compress->words[i - 1].word, word, len) != 0))
+    *slot = (*slot + 1) & compress->mask;
+  return i;
+}
+
+/* count occurrence of word, returns 0 on success */
+static int miniargv_help_compress_add (struct miniargv_help_compress_struct* compress, const char* word, size_t len)
+{
+  size_t i;
+  unsigned int slot;
+  void* p;
+  //grow hash table so it's at most half full
+  if (compress->wordcount * 2 >= compress->mask) {
+    if ((p = calloc((compress->mask + 1) * 2, sizeof(size_t))) == NULL)
+      return -1;
+    free(compress->hashtable);
+    compress->hashtable = (size_t*)p;
+    compress->mask = compress->mask * 2 + 1;
+    for (i = 0; i < compress->wordcount; i++) {
+      miniargv_help_compress_find(compress, compress->words[i].word, compress->words[i].len, &slot);
+      compress->hashtable[slot] = i + 1;
+    }
+  }
+  if ((i = miniargv_help_compress_find(compress, word, len, &slot)) == 0) {
+    if (compress->wordcount >= compress->wordsize) {
+      compress->wordsize = (compress->wordsize ? compress->wordsize * 2 : 256);
+      if ((p = realloc(compress->words, compress->wordsize * sizeof(struct miniargv_help_compress_word_struct))) == NULL)
+        return -1;
+      compress->words = (struct miniargv_help_compress_word_struct*)p;
+    }
+    //keep a copy as the text may be overwritten when the next text is uncompressed
+    if ((compress->words[compress->wordcount].word = (char*)malloc(len)) == NULL)
+      return -1;
+    memcpy(compress->words[compress->wordcount].word, word, len);
+    compress->words[compress->wordcount].len = len;
+    compress->words[compress->wordcount].count = 0;
+    compress->words[compress->wordcount].code = 0;
+    i = compress->hashtable[slot] = ++compress->wordcount;
+  }
+  compress->words[i - 1].count++;
+  return 0;
+}
+
+/* compare words for selecting the dictionary (most bytes saved first) */
+static int miniargv_help_compress_word_compare (const void* word1, const void* word2)
+{
+  const struct miniargv_help_compress_word_struct* w1 = *(const struct miniargv_help_compress_word_struct**)word1;
+  const struct miniargv_help_compress_word_struct* w2 = *(const struct miniargv_help_compress_word_struct**)word2;
+  size_t saved1 = w1->count * (w1->len - 2);
+  size_t saved2 = w2->count * (w2->len - 2);
+  if (saved1 != saved2)
+    return (saved1 > saved2 ? -1 : 1);
+  return (w1 < w2 ? -1 : (w1 > w2 ? 1 : 0));
+}
+
+DLL_EXPORT_MINIARGV int miniargv_help_compress (FILE* dst, const miniargv_definition argdef[])
+{
+  const struct miniargv_index_struct* index;
+  struct miniargv_help_blob_header_struct header;
+  struct miniargv_help_compress_struct compress;
+  struct miniargv_help_compress_word_struct** selected = NULL;
+  struct miniargv_help_text_struct helptext;
+  unsigned char* texts = NULL;
+  uint32_t* offsets = NULL;
+  size_t textslen = 0;
+  size_t selectedcount = 0;
+  size_t offsetcount = 0;
+  size_t len = 0;
+  size_t i;
+  size_t j;
+  size_t found;
+  unsigned int slot;
+  const char* text;
+  int status = 0;
+  if (!dst || !argdef)
+    return -1;
+  miniargv_cache_enter();
+  if ((index = miniargv_index_get(argdef)) == NULL) {
+    miniargv_cache_leave();
+    return -1;
+  }
+  miniargv_help_text_init(&helptext, argdef);
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "MINIHELP", 8);
+  header.version = MINIARGV_HELP_BLOB_VERSION;
+  header.count = index->count;
+  //count words of at least 3 letters (which are the only ones that make the text shorter when replaced by a 2 byte code)
+  memset(&compress, 0, sizeof(compress));
+  compress.mask = 255;
+  if ((compress.hashtable = (size_t*)calloc(compress.mask + 1, sizeof(size_t))) == NULL)
+    status = -1;
+  for (i = 0; i < (size_t)index->count && status == 0; i++) {
+    if ((text = miniargv_help_text_get(&helptext, index->entries[i].argdef, i)) == NULL)
+      continue;
+    if (strlen(text) > header.maxlength)
+      header.maxlength = strlen(text);
+    textslen += strlen(text) * 2;
+    for (; *text && status == 0; text += (j ? j : 1)) {
+      if ((j = miniargv_help_compress_word_length(text)) >= 3)
+        status = miniargv_help_compress_add(&compress, text, j);
+    }
+  }
+  //select words that save most bytes (taking into account the space they take in the dictionary)
+  if (status == 0 && (selected = (struct miniargv_help_compress_word_struct**)malloc((compress.wordcount + 1) * sizeof(struct miniargv_help_compress_word_struct*))) == NULL)
+    status = -1;
+  if (status == 0) {
+    for (i = 0; i < compress.wordcount; i++) {
+      if (compress.words[i].count * (compress.words[i].len - 2) > compress.words[i].len + sizeof(uint32_t))
+        selected[selectedcount++] = &compress.words[i];
+    }
+    qsort(selected, selectedcount, sizeof(struct miniargv_help_compress_word_struct*), miniargv_help_compress_word_compare);
+    if (selectedcount > MINIARGV_HELP_BLOB_MAX_WORDS)
+      selectedcount = MINIARGV_HELP_BLOB_MAX_WORDS;
+    header.wordcount = selectedcount;
+    offsetcount = selectedcount + 1 + index->count + 1;
+    if ((offsets = (uint32_t*)malloc(offsetcount * sizeof(uint32_t))) == NULL || (texts = (unsigned char*)malloc(textslen + 1)) == NULL)
+      status = -1;
+  }
+  if (status == 0) {
+    //assign codes to the words in the dictionary
+    for (i = 0; i < selectedcount; i++) {
+      selected[i]->code = i + 1;
+      offsets[i] = len;
+      len += selected[i]->len;
+    }
+    offsets[selectedcount] = len;
+    //compress texts
+    len = 0;
+    for (i = 0; i < (size_t)index->count; i++) {
+      offsets[selectedcount + 1 + i] = len;
+      if ((text = miniargv_help_text_get(&helptext, index->entries[i].argdef, i)) == NULL)
+        continue;
+      while (*text) {
+        if ((j = miniargv_help_compress_word_length(text)) >= 3 && (found = miniargv_help_compress_find(&compress, text, j, &slot)) != 0 && compress.words[found - 1].code) {
+          texts[len++] = 0x80 + (compress.words[found - 1].code - 1) / 256;
+          texts[len++] = (compress.words[found - 1].code - 1) % 256;
+          text += j;
+        } else if (j > 0) {
+          memcpy(texts + len, text, j);
+          len += j;
+          text += j;
+        } else {
+          if ((unsigned char)*text >= 0x80)
+            texts[len++] = MINIARGV_HELP_BLOB_ESCAPE;
+          texts[len++] = (unsigned char)*text++;
+        }
+      }
+    }
+    offsets[offsetcount - 1] = len;
+    //write header, offsets, dictionary and compressed texts
+    if (fwrite(&header, sizeof(header), 1, dst) != 1 || fwrite(offsets, sizeof(uint32_t), offsetcount, dst) != offsetcount)
+      status = -1;
+    for (i = 0; i < selectedcount && status == 0; i++) {
+      if (fwrite(selected[i]->word, 1, selected[i]->len, dst) != selected[i]->len)
+        status = -1;
+    }
+    if (status == 0 && fwrite(texts, 1, len, dst) != len)
+      status = -1;
+  }
+  for (i = 0; i < compress.wordcount; i++)
+    free(compress.words[i].word);
+  free(compress.words);
+  free(compress.hashtable);
+  free(selected);
+  free(offsets);
+  free(texts);
+  miniargv_help_text_free(&helptext);
+  miniargv_cache_leave();
+  return status;
+}
@@ -0,0 +1,352 @@
+#include "miniargv_internal.h"
+
+/* search in command line help using an inverted index of the words in long arguments, parameter names and help texts */
+
+//weight of a word depending on where it was found
+#define MINIARGV_HELP_WEIGHT_LONGARG 4
+#define MINIARGV_HELP_WEIGHT_ARGPARAM 2
+#define MINIARGV_HELP_WEIGHT_HELP 1
+
+/* word in inverted index */
+struct miniargv_help_word_struct {
+  const char* word;                               //lowercase word (not NUL-terminated)
+  size_t len;
+  size_t first;                                   //position of first posting in postings
+  size_t count;                                   //number of postings
+};
+
+/* definition a word was found in */
+struct miniargv_help_posting_struct {
+  int position;                                   //position of definition in argdefs
+  int weight;                                     //highest weight of the word in the definition
+};
+
+struct miniargv_help_index_struct {
+  struct miniargv_cache_object_struct header;
+  int count;                                      //number of definitions
+  const miniargv_definition** argdefs;            //definitions in order (without includes)
+  size_t wordcount;                               //number of distinct words
+  struct miniargv_help_word_struct* words;        //distinct words sorted alphabetically
+  struct miniargv_help_posting_struct* postings;  //definitions for each word in order of definition
+  char* text;                                     //lowercase copy of all distinct words
+};
+
+/* occurrence of a word while building inverted index */
+struct miniargv_help_occurrence_struct {
+  size_t word;                                    //number of word in order of first occurrence
+  int position;
+  int weight;
+};
+
+/* state while building inverted index */
+struct miniargv_help_build_struct {
+  struct miniargv_help_index_struct* help;
+  size_t wordsize;                                //allocated number of words
+  unsigned int wordmask;                          //size of wordhash - 1
+  size_t* wordhash;                               //hash table with position in words + 1 for each word, 0 for empty slots (at most half full)
+  size_t occurrencecount;
+  size_t occurrencesize;
+  struct miniargv_help_occurrence_struct* occurrences;
+  char* textpos;
+};
+
+/* ranking of definition while searching */
+struct miniargv_help_result_struct {
+  int position;
+  int matches;                                    //number of search terms found
+  int score;                                      //sum of best weights of search terms found
+  int termscore;                                  //best weight for the current search term
+};
+
+static void miniargv_help_index_free (struct miniargv_cache_object_struct* object)
+{
+  struct miniargv_help_index_struct* help = (struct miniargv_help_index_struct*)object;
+  free(help->argdefs);
+  free(help->words);
+  free(help->postings);
+  free(help->text);
+  free(help);
+}
+
+/* compare words in inverted index for sorting */
+static int miniargv_help_word_compare (const void* word1, const void* word2)
+{
+  const struct miniargv_help_word_struct* w1 = (const struct miniargv_help_word_struct*)word1;
+  const struct miniargv_help_word_struct* w2 = (const struct miniargv_help_word_struct*)word2;
+  int result;
+  if ((result = memcmp(w1->word, w2->word, (w1->len < w2->len ? w1->len : w2->len))) != 0)
+    return result;
+  return (w1->len < w2->len ? -1 : (w1->len > w2->len ? 1 : 0));
+}
+
+/* compare search results for sorting (most search terms found first, then highest score, then in order of definition) */
+static int miniargv_help_result_compare (const void* result1, const void* result2)
+{
+  const struct miniargv_help_result_struct* r1 = (const struct miniargv_help_result_struct*)result1;
+  const struct miniargv_help_result_struct* r2 = (const struct miniargv_help_result_struct*)result2;
+  if (r1->matches != r2->matches)
+    return r2->matches - r1->matches;
+  if (r1->score != r2->score)
+    return r2->score - r1->score;
+  return r1->position - r2->position;
+}
+
+//check if character is part of a word (ASCII letters and digits, and all non-ASCII characters so UTF-8 sequences are kept together)
+#define MINIARGV_HELP_IS_WORD_CHAR(c) (((c) >= 'a' && (c) <= 'z') || ((c) >= '0' && (c) <= '9') || ((c) >= 'A' && (c) <= 'Z') || (c) >= 0x80)
+
+/* copy lowercase version of next word in text, returns position after word or NULL if no more words */
+static const char* miniargv_help_next_word (const char* text, char* word, size_t* len)
+{
+  unsigned char c;
+  while ((c = (unsigned char)*text) != 0 && !MINIARGV_HELP_IS_WORD_CHAR(c))
+    text++;
+  if (!c)
+    return NULL;
+  *len = 0;
+  while ((c = (unsigned char)*text) != 0 && MINIARGV_HELP_IS_WORD_CHAR(c)) {
+    word[(*len)++] = (c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+    text++;
+  }
+  return text;
+}
+
+/* add words in text to inverted index being built, returns 0 on success */
+static int miniargv_help_index_add_words (struct miniargv_help_build_struct* build, const char* text, int position, int weight)
+{
+  struct miniargv_help_index_struct* help = build->help;
+  void* p;
+  size_t i;
+  size_t len;
+  unsigned int slot;
+  while (text && (text = miniargv_help_next_word(text, build->textpos, &len)) != NULL) {
+    //grow hash table so it's at most half full
+    if (help->wordcount * 2 >= build->wordmask) {
+      build->wordmask = build->wordmask * 2 + 1;
+      if ((p = calloc(build->wordmask + 1, sizeof(size_t))) == NULL)
+        return -1;
+      free(build->wordhash);
+      build->wordhash = (size_t*)p;
+      for (i = 0; i < help->wordcount; i++) {
+        slot = miniargv_hash(help->words[i].word, help->words[i].len) & build->wordmask;
+        while (build->wordhash[slot])
+          slot = (slot + 1) & build->wordmask;
+        build->wordhash[slot] = i + 1;
+      }
+    }
+    //look up word in hash table and add it if it's new
+    slot = miniargv_hash(build->textpos, len) & build->wordmask;
+    while ((i = build->wordhash[slot]) != 0 && (help->words[i - 1].len != len || memcmp(help->words[i - 1].word, build->textpos, len) != 0))
+      slot = (slot + 1) & build->wordmask;
+    if (!i) {
+      if (help->wordcount >= build->wordsize) {
+        build->wordsize = (build->wordsize ? build->wordsize * 2 : 256);
+        if ((p = realloc(help->words, build->wordsize * sizeof(struct miniargv_help_word_struct))) == NULL)
+          return -1;
+        help->words = (struct miniargv_help_word_struct*)p;
+      }
+      help->words[help->wordcount].word = build->textpos;
+      help->words[help->wordcount].len = len;
+      help->words[help->wordcount].count = 0;
+      i = build->wordhash[slot] = ++help->wordcount;
+      build->textpos += len;
+    }
+    //remember occurrence
+    if (build->occurrencecount >= build->occurrencesize) {
+      build->occurrencesize = (build->occurrencesize ? build->occurrencesize * 2 : 1024);
+      if ((p = realloc(build->occurrences, build->occurrencesize * sizeof(struct miniargv_help_occurrence_struct))) == NULL)
+        return -1;
+      build->occurrences = (struct miniargv_help_occurrence_struct*)p;
+    }
+    build->occurrences[build->occurrencecount].word = i - 1;
+    build->occurrences[build->occurrencecount].position = position;
+    build->occurrences[build->occurrencecount].weight = weight;
+    build->occurrencecount++;
+  }
+  return 0;
+}
+
+/* build inverted index for definition table */
+static struct miniargv_help_index_struct* miniargv_help_index_build (const miniargv_definition argdef[])
+{
+  int i;
+  size_t n;
+  size_t* order;
+  size_t textlen = 0;
+  char shortarg[2] = {0, 0};
+  const char* text;
+  const struct miniargv_index_struct* index;
+  struct miniargv_help_index_struct* help;
+  struct miniargv_help_text_struct helptext;
+  struct miniargv_help_build_struct build;
+  struct miniargv_help_posting_struct* posting;
+  if ((index = miniargv_index_get(argdef)) == NULL)
+    return NULL;
+  if ((help = (struct miniargv_help_index_struct*)calloc(1, sizeof(struct miniargv_help_index_struct))) == NULL)
+    return NULL;
+  help->header.key = argdef;
+  help->header.kind = MINIARGV_CACHE_KIND_HELP;
+  help->header.freefn = miniargv_help_index_free;
+  help->count = index->count;
+  memset(&build, 0, sizeof(build));
+  build.help = help;
+  if ((help->argdefs = (const miniargv_definition**)malloc((index->count + 1) * sizeof(miniargv_definition*))) == NULL) {
+    miniargv_help_index_free(&help->header);
+    return NULL;
+  }
+  //words take up at most as much space as the texts they are found in
+  miniargv_help_text_init(&helptext, argdef);
+  for (i = 0; i < index->count; i++) {
+    help->argdefs[i] = index->entries[i].argdef;
+    text = miniargv_help_text_get(&helptext, help->argdefs[i], i);
+    textlen += 2 + index->entries[i].longarglen + (help->argdefs[i]->argparam ? strlen(help->argdefs[i]->argparam) : 0) + (text ? strlen(text) : 0);
+  }
+  build.wordmask = 255;
+  if ((help->text = (char*)malloc(textlen + 1)) == NULL || (build.wordhash = (size_t*)calloc(build.wordmask + 1, sizeof(size_t))) == NULL) {
+    miniargv_help_text_free(&helptext);
+    miniargv_help_index_free(&help->header);
+    return NULL;
+  }
+  build.textpos = help->text;
+  for (i = 0; i < index->count; i++) {
+    shortarg[0] = (help->argdefs[i]->shortarg > 0 ? help->argdefs[i]->shortarg : 0);
+    if (miniargv_help_index_add_words(&build, shortarg, i, MINIARGV_HELP_WEIGHT_LONGARG) != 0 ||
+        miniargv_help_index_add_words(&build, help->argdefs[i]->longarg, i, MINIARGV_HELP_WEIGHT_LONGARG) != 0 ||
+        miniargv_help_index_add_words(&build, help->argdefs[i]->argparam, i, MINIARGV_HELP_WEIGHT_ARGPARAM) != 0 ||
+        miniargv_help_index_add_words(&build, miniargv_help_text_get(&helptext, help->argdefs[i], i), i, MINIARGV_HELP_WEIGHT_HELP) != 0) {
+      free(build.wordhash);
+      free(build.occurrences);
+      miniargv_help_text_free(&helptext);
+      miniargv_help_index_free(&help->header);
+      return NULL;
+    }
+  }
+  miniargv_help_text_free(&helptext);
+  free(build.wordhash);
+  //only the distinct words need to be sorted (remembering their original number)
+  for (n = 0; n < help->wordcount; n++)
+    help->words[n].first = n;
+  if (help->wordcount > 0)
+    qsort(help->words, help->wordcount, sizeof(struct miniargv_help_word_struct), miniargv_help_word_compare);
+  if ((order = (size_t*)malloc((help->wordcount + 1) * sizeof(size_t))) == NULL || (help->postings = (struct miniargv_help_posting_struct*)malloc((build.occurrencecount + 1) * sizeof(struct miniargv_help_posting_struct))) == NULL) {
+    free(order);
+    free(build.occurrences);
+    miniargv_help_index_free(&help->header);
+    return NULL;
+  }
+  for (n = 0; n < help->wordcount; n++)
+    order[help->words[n].first] = n;
+  //reserve room for the postings of each word in sorted order
+  for (n = 0; n < build.occurrencecount; n++)
+    help->words[order[build.occurrences[n].word]].count++;
+  for (n = 0, textlen = 0; n < help->wordcount; n++) {
+    help->words[n].first = textlen;
+    textlen += help->words[n].count;
+    help->words[n].count = 0;
+  }
+  //add postings in order of definition (keeping the highest weight if a word occurs more than once in the same definition)
+  for (n = 0; n < build.occurrencecount; n++) {
+    struct miniargv_help_word_struct* word = &help->words[order[build.occurrences[n].word]];
+    posting = &help->postings[word->first + word->count];
+    if (word->count > 0 && posting[-1].position == build.occurrences[n].position) {
+      if (build.occurrences[n].weight > posting[-1].weight)
+        posting[-1].weight = build.occurrences[n].weight;
+    } else {
+      posting->position = build.occurrences[n].position;
+      posting->weight = build.occurrences[n].weight;
+      word->count++;
+    }
+  }
+  free(order);
+  free(build.occurrences);
+  return help;
+}
+
+/* get inverted index for definition table (built on first use and kept until invalidated), returns NULL on error (only use between miniargv_cache_enter() and miniargv_cache_leave()) */
+static const struct miniargv_help_index_struct* miniargv_help_index_get (const miniargv_definition argdef[])
+{
+  struct miniargv_help_index_struct* help;
+  if ((help = (struct miniargv_help_index_struct*)miniargv_cache_get(argdef, MINIARGV_CACHE_KIND_HELP, 0)) != NULL)
+    return help;
+  if ((help = miniargv_help_index_build(argdef)) == NULL)
+    return NULL;
+  return (const struct miniargv_help_index_struct*)miniargv_cache_add(&help->header);
+}
+
+DLL_EXPORT_MINIARGV int miniargv_help_search (const miniargv_definition argdef[], const char* terms, int descindent, int wrapwidth)
+{
+  const struct miniargv_help_index_struct* help;
+  const struct miniargv_help_word_struct* word;
+  const struct miniargv_help_posting_struct* posting;
+  struct miniargv_help_result_struct* results;
+  char* term;
+  struct miniargv_help_text_struct helptext;
+  size_t termlen;
+  size_t first;
+  size_t last;
+  size_t middle;
+  size_t i;
+  size_t j;
+  int score;
+  int count = 0;
+  if (!argdef || !terms)
+    return -1;
+  miniargv_cache_enter();
+  if ((help = miniargv_help_index_get(argdef)) == NULL) {
+    miniargv_cache_leave();
+    return -1;
+  }
+  if ((results = (struct miniargv_help_result_struct*)calloc(help->count + 1, sizeof(struct miniargv_help_result_struct))) == NULL || (term = (char*)malloc(strlen(terms) + 1)) == NULL) {
+    free(results);
+    miniargv_cache_leave();
+    return -1;
+  }
+  for (i = 0; i < (size_t)help->count; i++)
+    results[i].position = i;
+  while ((terms = miniargv_help_next_word(terms, term, &termlen)) != NULL) {
+    //binary search for the first word not sorted before the search term
+    first = 0;
+    last = help->wordcount;
+    while (first < last) {
+      middle = first + (last - first) / 2;
+      word = &help->words[middle];
+      if (memcmp(word->word, term, (word->len < termlen ? word->len : termlen)) < 0 || (word->len < termlen && memcmp(word->word, term, word->len) == 0))
+        first = middle + 1;
+      else
+        last = middle;
+    }
+    //words starting with the search term follow each other (single characters only match exactly, as they are mostly short arguments)
+    for (last = first; last < help->wordcount && help->words[last].len >= termlen && memcmp(help->words[last].word, term, termlen) == 0 && (termlen > 1 || help->words[last].len == 1); last++) {
+      word = &help->words[last];
+      for (j = 0, posting = help->postings + word->first; j < word->count; j++, posting++) {
+        score = posting->weight * (word->len == termlen ? 2 : 1);
+        if (score > results[posting->position].termscore)
+          results[posting->position].termscore = score;
+      }
+    }
+    //add best score of the search term for each definition it was found in
+    for (i = first; i < last; i++) {
+      word = &help->words[i];
+      for (j = 0, posting = help->postings + word->first; j < word->count; j++, posting++) {
+        if (results[posting->position].termscore) {
+          results[posting->position].matches++;
+          results[posting->position].score += results[posting->position].termscore;
+          results[posting->position].termscore = 0;
+        }
+      }
+    }
+  }
+  //show help for matching definitions in order of relevance
+  qsort(results, help->count, sizeof(struct miniargv_help_result_struct), miniargv_help_result_compare);
+  if (!descindent)
+    descindent = 25;
+  miniargv_help_text_init(&helptext, argdef);
+  while (count < help->count && results[count].matches > 0) {
+    miniargv_arg_help_entry(help->argdefs[results[count].position], miniargv_help_text_get(&helptext, help->argdefs[results[count].position], results[count].position), descindent, wrapwidth);
+    count++;
+  }
+  miniargv_help_text_free(&helptext);
+  free(term);
+  free(results);
+  miniargv_cache_leave();
+  return count;
+}
@@ -0,0 +1,357 @@
+/* definitions shared between the modules of the miniargv library (not installed) */
+
+#ifndef INCLUDED_MINIARGV_INTERNAL_H
+#define INCLUDED_MINIARGV_INTERNAL_H
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#include "miniargv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sched.h>
+#endif
+#if defined(_MSC_VER) || (defined(__MINGW32__) && !defined(__MINGW64__))
+#define strcasecmp _stricmp
+#endif
+#if defined(_MSC_VER)
+#define MINIARGV_THREAD_LOCAL __declspec(thread)
+#else
+#define MINIARGV_THREAD_LOCAL __thread
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MINIARGV_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* number of trailing zero bits in a non-zero value (position of the first match in a SIMD comparison mask) */
+static __inline unsigned int miniargv_ctz (unsigned int value)
+{
+#if defined(__GNUC__)
+  return (unsigned int)__builtin_ctz(value);
+#elif defined(_MSC_VER)
+  unsigned long result;
+  _BitScanForward(&result, value);
+  return (unsigned int)result;
+#else
+  unsigned int result = 0;
+  while (!(value & 1)) {
+    value >>= 1;
+    result++;
+  }
+  return result;
+#endif
+}
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define MINIARGV_SWAR
+#endif
+//atomic operations on int variables (MINIARGV_ATOMIC_*) and pointer variables (MINIARGV_ATOMIC_*_PTR) shared between threads
+#if defined(__GNUC__)
+#define MINIARGV_ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define MINIARGV_ATOMIC_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define MINIARGV_ATOMIC_CAS(ptr, expected, desired) __atomic_compare_exchange_n((ptr), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define MINIARGV_ATOMIC_FETCH_ADD(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_ACQ_REL)
+#define MINIARGV_ATOMIC_LOAD_PTR(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define MINIARGV_ATOMIC_CAS_PTR(ptr, expected, desired) __atomic_compare_exchange_n((ptr), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define MINIARGV_ATOMIC_EXCHANGE_PTR(ptr, value) __atomic_exchange_n((ptr), (value), __ATOMIC_ACQ_REL)
+#elif defined(_MSC_VER)
+static __inline int miniargv_atomic_cas (volatile int* ptr, int* expected, int desired)
+{
+  int previous = (int)InterlockedCompareExchange((volatile LONG*)ptr, desired, *expected);
+  if (previous == *expected)
+    return 1;
+  *expected = previous;
+  return 0;
+}
+static __inline int miniargv_atomic_cas_ptr (PVOID volatile* ptr, PVOID* expected, PVOID desired)
+{
+  PVOID previous = InterlockedCompareExchangePointer(ptr, desired, *expected);
+  if (previous == *expected)
+    return 1;
+  *expected = previous;
+  return 0;
+}
+#define MINIARGV_ATOMIC_LOAD(ptr) ((int)InterlockedCompareExchange((volatile LONG*)(ptr), 0, 0))
+#define MINIARGV_ATOMIC_STORE(ptr, value) InterlockedExchange((volatile LONG*)(ptr), (value))
+#define MINIARGV_ATOMIC_CAS(ptr, expected, desired) miniargv_atomic_cas((ptr), (expected), (desired))
+#define MINIARGV_ATOMIC_FETCH_ADD(ptr, value) ((int)InterlockedExchangeAdd((volatile LONG*)(ptr), (value)))
+#define MINIARGV_ATOMIC_LOAD_PTR(ptr) InterlockedCompareExchangePointer((PVOID volatile*)(ptr), NULL, NULL)
+#define MINIARGV_ATOMIC_CAS_PTR(ptr, expected, desired) miniargv_atomic_cas_ptr((PVOID volatile*)(ptr), (PVOID*)(expected), (desired))
+#define MINIARGV_ATOMIC_EXCHANGE_PTR(ptr, value) InterlockedExchangePointer((PVOID volatile*)(ptr), (value))
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define MINIARGV_ATOMIC_LOAD(ptr) atomic_load_explicit((_Atomic int*)(ptr), memory_order_acquire)
+#define MINIARGV_ATOMIC_STORE(ptr, value) atomic_store_explicit((_Atomic int*)(ptr), (value), memory_order_release)
+#define MINIARGV_ATOMIC_CAS(ptr, expected, desired) atomic_compare_exchange_strong_explicit((_Atomic int*)(ptr), (expected), (desired), memory_order_acq_rel, memory_order_acquire)
+#define MINIARGV_ATOMIC_FETCH_ADD(ptr, value) atomic_fetch_add_explicit((_Atomic int*)(ptr), (value), memory_order_acq_rel)
+#define MINIARGV_ATOMIC_LOAD_PTR(ptr) atomic_load_explicit((void* _Atomic*)(ptr), memory_order_acquire)
+#define MINIARGV_ATOMIC_CAS_PTR(ptr, expected, desired) atomic_compare_exchange_strong_explicit((void* _Atomic*)(ptr), (void**)(expected), (desired), memory_order_acq_rel, memory_order_acquire)
+#define MINIARGV_ATOMIC_EXCHANGE_PTR(ptr, value) atomic_exchange_explicit((void* _Atomic*)(ptr), (value), memory_order_acq_rel)
+#else
+#error no atomic operations available for this compiler
+#endif
+#ifdef _WIN32
+#define MINIARGV_YIELD() Sleep(0)
+#else
+#define MINIARGV_YIELD() sched_yield()
+#endif
+
+//static tracepoints for tools like bpftrace, perf and SystemTap (only if <sys/sdt.h> is available, otherwise they compile to nothing)
+#if !defined(MINIARGV_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define MINIARGV_PROBES
+#endif
+#endif
+#ifdef MINIARGV_PROBES
+#define MINIARGV_PROBE1(name, a1) DTRACE_PROBE1(miniargv, name, a1)
+#define MINIARGV_PROBE2(name, a1, a2) DTRACE_PROBE2(miniargv, name, a1, a2)
+#define MINIARGV_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(miniargv, name, a1, a2, a3)
+#define MINIARGV_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(miniargv, name, a1, a2, a3, a4)
+#else
+#define MINIARGV_PROBE1(name, a1)
+#define MINIARGV_PROBE2(name, a1, a2)
+#define MINIARGV_PROBE3(name, a1, a2, a3)
+#define MINIARGV_PROBE4(name, a1, a2, a3, a4)
+#endif
+
+//functions shared between the modules of the library (not exported from the shared library)
+#if defined(__GNUC__) && !defined(_WIN32)
+#define MINIARGV_INTERNAL __attribute__((visibility("hidden")))
+#else
+#define MINIARGV_INTERNAL
+#endif
+
+//functions declared with #pragma weak in a module don't cause the module defining them to be linked from the static library (their address is NULL if nothing else needs them)
+#if defined(__GNUC__) && defined(__ELF__)
+#define MINIARGV_WEAK_REFERENCES
+#endif
+
+/* callback invocation deferred to run in parallel after processing */
+struct miniargv_deferred_struct {
+  const miniargv_definition* argdef;
+  char* value;
+  void* callbackdata;
+  int index;
+  int result;
+  int ownvalue;                     //non-zero if value is a copy that needs to be freed
+  unsigned char opcode;             //MINIARGV_OPCODE_* for callbackfn
+};
+
+/* list of callback invocations deferred to run in parallel after processing */
+struct miniargv_deferred_list_struct {
+  struct miniargv_deferred_struct* items;
+  int count;
+  int size;
+  volatile int next;
+};
+
+/* state kept while processing command line arguments */
+struct miniargv_parse_state_struct {
+  const char* source;               //what is being processed ("arg", "options" or "cfgfile"), reported by the match probe
+  int terminator;                   //index of "--" end of options marker (0 if not encountered yet)
+  const struct miniargv_index_struct* index;    //lookup index for the definitions, or NULL to scan them
+  struct miniargv_deferred_list_struct deferred;
+};
+
+//number of NUL characters following the data read by miniargv_cfg_read() so it can be scanned in blocks
+#define MINIARGV_CFG_PADDING 32
+
+/* entry found in configuration file */
+struct miniargv_cfg_entry_struct {
+  char* line;                       //start of line where the entry was found
+  int linenumber;                   //number of line where the entry was found
+  char* name;                       //variable name (not NUL-terminated) or path of configuration file to include
+  size_t namelen;
+  char separator;                   //'=', ':' or '@' for variables or 0 for configuration files to include
+  char* value;                      //value of variable (parsed in place and NUL-terminated)
+};
+
+//compressed help text format version (a blob written on a system with different byte order won't match)
+#define MINIARGV_HELP_BLOB_VERSION 1
+
+//maximum number of words in the dictionary of compressed help texts (codes 0x80-0xFE followed by a second byte)
+#define MINIARGV_HELP_BLOB_MAX_WORDS (0x7F * 256)
+
+//byte preceding a literal byte with the high bit set in compressed help texts
+#define MINIARGV_HELP_BLOB_ESCAPE 0xFF
+
+/* header of compressed help texts, followed by the word offsets, the text offsets, the words and the compressed texts (all offsets are 32-bit) */
+struct miniargv_help_blob_header_struct {
+  char magic[8];                    //"MINIHELP"
+  uint32_t version;                 //MINIARGV_HELP_BLOB_VERSION
+  uint32_t count;                   //number of texts (one for each definition, including the included ones)
+  uint32_t wordcount;               //number of words in the dictionary
+  uint32_t maxlength;               //length of the longest text
+};
+
+/* state for getting help texts of definitions (which may be stored compressed) */
+struct miniargv_help_text_struct {
+  const unsigned char* data;        //registered compressed help texts (only touched when a compressed text is needed), or NULL
+  size_t size;
+  int valid;                        //1 if compressed help texts were checked and are valid, -1 if invalid, 0 if not checked yet
+  struct miniargv_help_blob_header_struct header;
+  size_t words;                     //offset of the words in the dictionary
+  size_t texts;                     //offset of the compressed texts
+  char* buffer;                     //buffer for uncompressed text
+};
+
+//kinds of cached objects
+#define MINIARGV_CACHE_KIND_INDEX 1
+#define MINIARGV_CACHE_KIND_APPLETS 2
+#define MINIARGV_CACHE_KIND_HELP 3
+#define MINIARGV_CACHE_KIND_SUGGEST 4
+#define MINIARGV_CACHE_KIND_CFGINDEX 5    //key is the hash of the path of the configuration file instead of a table address
+
+/* header of every cached object */
+struct miniargv_cache_object_struct {
+  const void* key;                  //address of the table the object was built for
+  int kind;                         //MINIARGV_CACHE_KIND_*
+  uint64_t hash;                    //0 for tables (which are invalidated explicitly), hash of size and modification time for configuration files
+  void (*freefn)(struct miniargv_cache_object_struct* object);
+  struct miniargv_cache_object_struct* nextretired;   //next object removed from the cache that is waiting to be freed
+};
+
+/* entry in lookup index */
+//opcodes for built-in callback functions, which are run directly while processing instead of via an indirect call through callbackfn
+#define MINIARGV_OPCODE_CALL 0                  //call callbackfn (custom callback functions)
+#define MINIARGV_OPCODE_SET_CONST_STR 1
+#define MINIARGV_OPCODE_STRDUP 2
+#define MINIARGV_OPCODE_SET_BOOLEAN 3
+#define MINIARGV_OPCODE_SET_INT 4
+#define MINIARGV_OPCODE_SET_INT_TO_ZERO 5
+#define MINIARGV_OPCODE_SET_INT_TO_ONE 6
+#define MINIARGV_OPCODE_SET_INT_TO_MINUS_ONE 7
+#define MINIARGV_OPCODE_INCREMENT_INT 8
+#define MINIARGV_OPCODE_DECREMENT_INT 9
+#define MINIARGV_OPCODE_SET_LONG 10
+#define MINIARGV_OPCODE_NOOP 11
+
+//bodies of the trivial built-in callback functions, shared by miniargv_cb_* and the opcodes run directly so they can't get out of sync (the other opcodes call the miniargv_cb_* function)
+#define MINIARGV_CB_SET_CONST_STR(argdef, value) (*(const char**)(argdef)->userdata = (value))
+#define MINIARGV_CB_SET_INT_TO(argdef, intval) (*(int*)(argdef)->userdata = (intval))
+#define MINIARGV_CB_INCREMENT_INT(argdef) ((*(int*)(argdef)->userdata)++)
+#define MINIARGV_CB_DECREMENT_INT(argdef) ((*(int*)(argdef)->userdata)--)
+
+struct miniargv_index_entry_struct {
+  const miniargv_definition* argdef;
+  size_t longarglen;
+  unsigned char opcode;             //MINIARGV_OPCODE_* for callbackfn
+};
+
+struct miniargv_index_struct {
+  struct miniargv_cache_object_struct header;
+  int count;                                      //number of definitions
+  struct miniargv_index_entry_struct* entries;    //definitions in order (without includes)
+  int shortargs[256];                             //position in entries + 1 for each short argument, 0 if not defined
+  int standalonearg;                              //position in entries + 1 of standalone value argument, 0 if not defined
+  unsigned int longargmask;                       //size of longargs - 1
+  int* longargs;                                  //hash table with position in entries + 1 for each long argument, 0 for empty slots
+};
+
+/* contents of a file mapped in memory (or read in memory if it can't be mapped) */
+struct miniargv_cfg_mapping_struct {
+  char* data;                       //contents followed by at least MINIARGV_CFG_PADDING + 1 NUL characters
+  size_t length;
+  size_t mappedsize;                //size of memory mapping or 0 if data was allocated
+  struct stat statbuf;
+};
+
+//states of lazily evaluated values
+#define MINIARGV_LAZY_STATE_UNSET 0
+#define MINIARGV_LAZY_STATE_SET   1
+#define MINIARGV_LAZY_STATE_BUSY  2
+#define MINIARGV_LAZY_STATE_DONE  3
+
+/* precomputed default value written to a variable outside the store */
+struct miniargv_defaults_value_struct {
+  void* target;
+  size_t offset;
+  size_t size;
+};
+
+/* part of the store copied from the image */
+struct miniargv_defaults_segment_struct {
+  size_t offset;
+  size_t size;
+};
+
+/* precomputed defaults created by miniargv_defaults_create() */
+struct miniargv_defaults_struct {
+  unsigned char* store;
+  size_t storesize;
+  unsigned char* image;
+  struct miniargv_defaults_segment_struct* segments;
+  int segmentcount;
+  struct miniargv_defaults_value_struct* values;
+  int valuecount;
+  unsigned char* valuedata;
+  size_t valuedatalen;
+  const miniargv_definition** callbacks;
+  int callbackcount;
+};
+
+//argument processing (miniargv.c)
+MINIARGV_INTERNAL const miniargv_definition* miniargv_find_longarg_exact (const char* longarg, size_t longarglen, const miniargv_definition argdef[]);
+MINIARGV_INTERNAL const miniargv_definition* miniargv_lookup_longarg (const char* longarg, size_t longarglen, const miniargv_definition argdef[], const struct miniargv_index_struct* index, unsigned char* opcode);
+MINIARGV_INTERNAL int miniargv_call_handler (struct miniargv_parse_state_struct* state, const miniargv_definition* argdef, unsigned char opcode, const char* value, void* callbackdata, int index);
+MINIARGV_INTERNAL const char* miniargv_next_word (const char* p, const char* end, char* word);
+MINIARGV_INTERNAL void miniargv_deferred_run (struct miniargv_deferred_list_struct* deferred);
+MINIARGV_INTERNAL void miniargv_deferred_free (struct miniargv_deferred_list_struct* deferred);
+MINIARGV_INTERNAL void miniargv_cache_enter ();
+MINIARGV_INTERNAL void miniargv_cache_leave ();
+MINIARGV_INTERNAL struct miniargv_cache_object_struct* miniargv_cache_get (const void* key, int kind, uint64_t hash);
+MINIARGV_INTERNAL struct miniargv_cache_object_struct* miniargv_cache_add (struct miniargv_cache_object_struct* object);
+MINIARGV_INTERNAL void miniargv_cache_remove (const void* key);
+MINIARGV_INTERNAL uint64_t miniargv_cache_hash (uint64_t hash, const void* data, size_t len);
+MINIARGV_INTERNAL unsigned int miniargv_hash (const char* s, size_t len);
+MINIARGV_INTERNAL const struct miniargv_index_struct* miniargv_index_get (const miniargv_definition argdef[]);
+MINIARGV_INTERNAL int miniargv_index_find_longarg_position (const struct miniargv_index_struct* index, const char* longarg, size_t longarglen);
+
+//reading and mapping files (miniargv_file.c)
+MINIARGV_INTERNAL char* miniargv_cfg_read (const char* path, size_t* length);
+MINIARGV_INTERNAL int miniargv_cfg_map (const char* path, struct miniargv_cfg_mapping_struct* mapping);
+MINIARGV_INTERNAL void miniargv_cfg_unmap (struct miniargv_cfg_mapping_struct* mapping);
+MINIARGV_INTERNAL int miniargv_cfg_index_write (const char* indexpath, const struct miniargv_cfg_mapping_struct* index);
+
+//configuration file scanner (miniargv_cfgfile.c)
+MINIARGV_INTERNAL char* miniargv_cfg_next_entry (char* p, const char* end, int* linenumber, struct miniargv_cfg_entry_struct* entry);
+
+//help texts (miniargv_help.c)
+MINIARGV_INTERNAL void miniargv_help_text_init (struct miniargv_help_text_struct* helptext, const miniargv_definition argdef[]);
+MINIARGV_INTERNAL const char* miniargv_help_text_get (struct miniargv_help_text_struct* helptext, const miniargv_definition* argdef, uint32_t position);
+MINIARGV_INTERNAL void miniargv_help_text_free (struct miniargv_help_text_struct* helptext);
+MINIARGV_INTERNAL void miniargv_arg_help_entry (const miniargv_definition* current_argdef, const char* help, int descindent, int wrapwidth);
+
+//bash completion (miniargv_complete.c)
+MINIARGV_INTERNAL const char* miniargv_complete_getenv (char* env[], const char* name);
+MINIARGV_INTERNAL const miniargv_definition* miniargv_complete_line_words (char *argv[], char* env[], int index, const char* line, size_t point, int skipwords, const miniargv_definition argdef[], const miniargv_definition envdef[], void* callbackdata);
+
+//callback functions (miniargv_callbacks.c)
+MINIARGV_INTERNAL int miniargv_hex_digit (char c);
+
+//precomputed defaults (miniargv_defaults.c)
+MINIARGV_INTERNAL size_t miniargv_defaults_value_size (miniargv_handler_fn callbackfn);
+
+#endif
@@ -0,0 +1,316 @@
+#include "miniargv_internal.h"
+#include <dirent.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <poll.h>
+#include <time.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+/* key-per-file configuration directories (like Kubernetes ConfigMap and Secret volumes) */
+
+//name of the symbolic link to the current version of the files, which is swapped atomically when they are updated
+#define MINIARGV_KEYDIR_DATA "..data"
+
+//maximum time in milliseconds between checks if the data link changed (also when it can be watched, in case events are missed)
+#define MINIARGV_KEYDIR_POLL_INTERVAL 1000
+
+/* file in key-per-file directory with a matching definition */
+struct miniargv_keydir_entry_struct {
+  const miniargv_definition* cfgdef;
+  unsigned char opcode;             //MINIARGV_OPCODE_* for callback function of definition
+  char* path;                       //path of file containing the value
+  size_t offset;                    //position of value in buffer with all values
+  size_t length;                    //length of value (size of file before reading)
+};
+
+/* watch for atomic updates of key-per-file directory */
+struct miniargv_keydir_watch_struct {
+  char* path;                       //path of directory
+  char* target;                     //last seen target of data link, or NULL if there is none
+  int fd;                           //inotify file descriptor watching the directory, or -1
+};
+
+/* join directory and file name, returns allocated path or NULL on error */
+static char* miniargv_keydir_path (const char* dir, const char* name)
+{
+  char* path;
+  size_t dirlen = strlen(dir);
+  size_t namelen = strlen(name);
+  if ((path = (char*)malloc(dirlen + namelen + 2)) == NULL)
+    return NULL;
+  memcpy(path, dir, dirlen);
+  path[dirlen] = '/';
+  memcpy(path + dirlen + 1, name, namelen + 1);
+  return path;
+}
+
+/* get target of data link in key-per-file directory, returns allocated target or NULL if there is no such symbolic link */
+static char* miniargv_keydir_data_target (const char* dir)
+{
+#ifndef _WIN32
+  char* linkpath;
+  char target[PATH_MAX];
+  ssize_t len;
+  if ((linkpath = miniargv_keydir_path(dir, MINIARGV_KEYDIR_DATA)) == NULL)
+    return NULL;
+  len = readlink(linkpath, target, sizeof(target) - 1);
+  free(linkpath);
+  if (len <= 0)
+    return NULL;
+  target[len] = 0;
+  return strdup(target);
+#else
+  return NULL;
+#endif
+}
+
+/* compare directory entries by path (so values are always processed in the same order) */
+static int miniargv_keydir_entry_compare (const void* a, const void* b)
+{
+  return strcmp(((const struct miniargv_keydir_entry_struct*)a)->path, ((const struct miniargv_keydir_entry_struct*)b)->path);
+}
+
+/* list files in directory with a matching definition (sorted by name), returns number of entries or -1 on error */
+static int miniargv_keydir_list (const char* dir, const miniargv_definition cfgdef[], struct miniargv_keydir_entry_struct** entries)
+{
+  DIR* dirhandle;
+  struct dirent* direntry;
+  struct stat statbuf;
+  struct miniargv_keydir_entry_struct* newentries;
+  const struct miniargv_index_struct* index;
+  const miniargv_definition* current_cfgdef;
+  unsigned char opcode;
+  char* path;
+  int i;
+  int count = 0;
+  int size = 0;
+  *entries = NULL;
+  if ((dirhandle = opendir(dir)) == NULL)
+    return -1;
+  miniargv_cache_enter();
+  index = miniargv_index_get(cfgdef);
+  while ((direntry = readdir(dirhandle)) != NULL) {
+    //skip hidden entries (including the data link and the versions it points to)
+    if (direntry->d_name[0] == '.')
+      continue;
+    //file name must exactly match the long name of a definition
+    opcode = MINIARGV_OPCODE_CALL;
+    if (!index) {
+      current_cfgdef = miniargv_find_longarg_exact(direntry->d_name, strlen(direntry->d_name), cfgdef);
+    } else if ((i = miniargv_index_find_longarg_position(index, direntry->d_name, strlen(direntry->d_name))) > 0) {
+      current_cfgdef = index->entries[i - 1].argdef;
+      opcode = index->entries[i - 1].opcode;
+    } else {
+      current_cfgdef = NULL;
+    }
+    if (!current_cfgdef)
+      continue;
+    //only regular files (following symbolic links)
+    if ((path = miniargv_keydir_path(dir, direntry->d_name)) == NULL)
+      break;
+    if (stat(path, &statbuf) != 0 || !S_ISREG(statbuf.st_mode)) {
+      free(path);
+      continue;
+    }
+    if (count >= size) {
+      if ((newentries = (struct miniargv_keydir_entry_struct*)realloc(*entries, (size ? size * 2 : 16) * sizeof(struct miniargv_keydir_entry_struct))) == NULL) {
+        free(path);
+        break;
+      }
+      *entries = newentries;
+      size = (size ? size * 2 : 16);
+    }
+    (*entries)[count].cfgdef = current_cfgdef;
+    (*entries)[count].opcode = opcode;
+    (*entries)[count].path = path;
+    (*entries)[count].offset = 0;
+    (*entries)[count].length = statbuf.st_size;
+    count++;
+  }
+  miniargv_cache_leave();
+  closedir(dirhandle);
+  //abort if listing was interrupted by an allocation failure
+  if (direntry) {
+    for (i = 0; i < count; i++)
+      free((*entries)[i].path);
+    free(*entries);
+    *entries = NULL;
+    return -1;
+  }
+  qsort(*entries, count, sizeof(struct miniargv_keydir_entry_struct), miniargv_keydir_entry_compare);
+  return count;
+}
+
+/* read values of all files in one buffer (with a single read for each file), returns buffer or NULL on error */
+static char* miniargv_keydir_read (struct miniargv_keydir_entry_struct* entries, int count)
+{
+  int i;
+  int fd;
+  ssize_t n;
+  size_t size = 0;
+  char* data;
+  //room for each value followed by a NUL character
+  for (i = 0; i < count; i++) {
+    entries[i].offset = size;
+    size += entries[i].length + 1;
+  }
+  if ((data = (char*)malloc(size + 1)) == NULL)
+    return NULL;
+  for (i = 0; i < count; i++) {
+#ifdef _WIN32
+    if ((fd = open(entries[i].path, O_RDONLY | O_BINARY)) == -1) {
+#else
+    if ((fd = open(entries[i].path, O_RDONLY)) == -1) {
+#endif
+      free(data);
+      return NULL;
+    }
+    n = read(fd, data + entries[i].offset, entries[i].length);
+    close(fd);
+    if (n < 0) {
+      free(data);
+      return NULL;
+    }
+    //strip a single line break at the end (as most editors add one)
+    if (n > 0 && data[entries[i].offset + n - 1] == '\n')
+      n--;
+    if (n > 0 && data[entries[i].offset + n - 1] == '\r')
+      n--;
+    entries[i].length = n;
+    data[entries[i].offset + n] = 0;
+  }
+  return data;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_process_keydir (const char* path, const miniargv_definition cfgdef[], void* callbackdata)
+{
+  int i;
+  int count;
+  int status = 0;
+  char* target;
+  char* dir;
+  char* data;
+  struct miniargv_keydir_entry_struct* entries;
+  struct miniargv_parse_state_struct state = {0};
+  //read from the version the data link points to, so all values are from the same version even if it is swapped while reading
+  if ((target = miniargv_keydir_data_target(path)) != NULL) {
+    dir = (target[0] == '/' ? target : miniargv_keydir_path(path, target));
+    if (dir != target)
+      free(target);
+  } else {
+    dir = strdup(path);
+  }
+  if (!dir)
+    return -1;
+  count = miniargv_keydir_list(dir, cfgdef, &entries);
+  free(dir);
+  if (count <= 0)
+    return count;
+  if ((data = miniargv_keydir_read(entries, count)) == NULL) {
+    status = -1;
+  } else {
+    state.source = "keydir";
+    MINIARGV_PROBE2(parse__start, state.source, 0);
+    for (i = 0; i < count && status == 0; i++)
+      status = miniargv_call_handler(&state, entries[i].cfgdef, entries[i].opcode, data + entries[i].offset, callbackdata, i + 1);
+    if (state.deferred.count > 0) {
+      //run deferred callback invocations and report the first one that failed
+      if (status == 0) {
+        miniargv_deferred_run(&state.deferred);
+        for (i = 0; i < state.deferred.count && status == 0; i++)
+          status = state.deferred.items[i].result;
+      }
+      miniargv_deferred_free(&state.deferred);
+    }
+    MINIARGV_PROBE2(parse__end, state.source, status);
+    free(data);
+  }
+  for (i = 0; i < count; i++)
+    free(entries[i].path);
+  free(entries);
+  return status;
+}
+
+DLL_EXPORT_MINIARGV miniargv_keydir_watch* miniargv_keydir_watch_create (const char* path)
+{
+  struct miniargv_keydir_watch_struct* watch;
+  if ((watch = (struct miniargv_keydir_watch_struct*)malloc(sizeof(struct miniargv_keydir_watch_struct))) == NULL)
+    return NULL;
+  if ((watch->path = strdup(path)) == NULL) {
+    free(watch);
+    return NULL;
+  }
+  watch->target = miniargv_keydir_data_target(path);
+  watch->fd = -1;
+#ifdef __linux__
+  //the data link is swapped by renaming a new link over it
+  if ((watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) != -1 && inotify_add_watch(watch->fd, path, IN_CREATE | IN_MOVED_TO) == -1) {
+    close(watch->fd);
+    watch->fd = -1;
+  }
+#endif
+  return watch;
+}
+
+#ifndef _WIN32
+/* get time in milliseconds from monotonic clock */
+static long long miniargv_keydir_now ()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+#endif
+
+DLL_EXPORT_MINIARGV int miniargv_keydir_watch_wait (miniargv_keydir_watch* watch, int timeout)
+{
+#ifndef _WIN32
+  char* target;
+  char events[4096];
+  struct pollfd pollinfo;
+  long long end;
+  long long remaining;
+  end = miniargv_keydir_now() + timeout;
+  for (;;) {
+    //check if the data link points to another version
+    target = miniargv_keydir_data_target(watch->path);
+    if ((target || watch->target) && (!target || !watch->target || strcmp(target, watch->target) != 0)) {
+      free(watch->target);
+      watch->target = target;
+      return 1;
+    }
+    free(target);
+    //wait for changes in the directory (or just wait if it can't be watched)
+    remaining = (timeout < 0 ? MINIARGV_KEYDIR_POLL_INTERVAL : end - miniargv_keydir_now());
+    if (remaining <= 0)
+      return 0;
+    pollinfo.fd = watch->fd;
+    pollinfo.events = POLLIN;
+    pollinfo.revents = 0;
+    if (poll(&pollinfo, (watch->fd != -1 ? 1 : 0), (remaining < MINIARGV_KEYDIR_POLL_INTERVAL ? (int)remaining : MINIARGV_KEYDIR_POLL_INTERVAL)) < 0 && errno != EINTR)
+      return -1;
+    //discard events, the data link is checked anyway
+    if (watch->fd != -1)
+      while (read(watch->fd, events, sizeof(events)) > 0)
+        ;
+  }
+#else
+  return -1;
+#endif
+}
+
+DLL_EXPORT_MINIARGV void miniargv_keydir_watch_free (miniargv_keydir_watch* watch)
+{
+  if (!watch)
+    return;
+#ifndef _WIN32
+  if (watch->fd != -1)
+    close(watch->fd);
+#endif
+  free(watch->target);
+  free(watch->path);
+  free(watch);
+}
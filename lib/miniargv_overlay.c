@@ -0,0 +1,67 @@
+#include "miniargv_internal.h"
+
+/* overlays of values overriding variables of definitions */
+
+//bit in overlay mask for variable (consecutive int variables get different bits)
+#define MINIARGV_OVERLAY_BIT(userdata) (1u << (((uintptr_t)(userdata) / sizeof(int)) % (8 * sizeof(unsigned int))))
+
+/* get size of variable set by callback function supported in overlays, or 0 if not supported */
+static size_t miniargv_overlay_value_size (miniargv_handler_fn callbackfn)
+{
+  if (callbackfn == miniargv_cb_set_int || callbackfn == miniargv_cb_set_boolean || callbackfn == miniargv_cb_set_int_to_zero || callbackfn == miniargv_cb_set_int_to_one || callbackfn == miniargv_cb_set_int_to_minus_one || callbackfn == miniargv_cb_increment_int || callbackfn == miniargv_cb_decrement_int)
+    return sizeof(int);
+  if (callbackfn == miniargv_cb_set_long || callbackfn == miniargv_cb_set_long_to_zero || callbackfn == miniargv_cb_set_long_to_one || callbackfn == miniargv_cb_set_long_to_minus_one || callbackfn == miniargv_cb_increment_long || callbackfn == miniargv_cb_decrement_long)
+    return sizeof(long);
+  if (callbackfn == miniargv_cb_set_const_str)
+    return sizeof(const char*);
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_overlay_set (miniargv_overlay* overlay, const miniargv_definition* argdef, const char* value)
+{
+  int i;
+  int result;
+  size_t size;
+  miniargv_definition overlay_argdef;
+  miniargv_overlay_value newvalue;
+  if (!argdef || !argdef->userdata || (size = miniargv_overlay_value_size(argdef->callbackfn)) == 0)
+    return -1;
+  //find existing entry for the variable (which may have been set by another definition)
+  for (i = 0; i < overlay->count && overlay->entries[i].userdata != argdef->userdata; i++)
+    ;
+  if (i >= MINIARGV_OVERLAY_SIZE)
+    return -1;
+  //call callback function on copy of current value
+  memcpy(&newvalue, (i < overlay->count ? &overlay->entries[i].value : argdef->userdata), size);
+  overlay_argdef = *argdef;
+  overlay_argdef.userdata = &newvalue;
+  if ((result = (argdef->callbackfn)(&overlay_argdef, value, NULL)) != 0)
+    return result;
+  if (i == overlay->count) {
+    overlay->entries[i].userdata = argdef->userdata;
+    overlay->mask |= MINIARGV_OVERLAY_BIT(argdef->userdata);
+    overlay->count++;
+  }
+  overlay->entries[i].value = newvalue;
+  return 0;
+}
+
+DLL_EXPORT_MINIARGV int miniargv_overlay_set_longarg (miniargv_overlay* overlay, const char* longarg, const char* value)
+{
+  const miniargv_definition* argdef;
+  if ((argdef = miniargv_find_longarg(longarg, 0, overlay->argdef)) == NULL)
+    return -1;
+  return miniargv_overlay_set(overlay, argdef, value);
+}
+
+DLL_EXPORT_MINIARGV const void* miniargv_overlay_get (const miniargv_overlay* overlay, const miniargv_definition* argdef)
+{
+  int i;
+  if (overlay->mask & MINIARGV_OVERLAY_BIT(argdef->userdata)) {
+    for (i = 0; i < overlay->count; i++) {
+      if (overlay->entries[i].userdata == argdef->userdata)
+        return &overlay->entries[i].value;
+    }
+  }
+  return argdef->userdata;
+}
@@ -0,0 +1,183 @@
+#include "miniargv_internal.h"
+
+/* "did you mean" suggestions for misspelled long argument names, using a BK-tree over the names in the lookup index */
+
+//maximum length of names that are compared (longer names are never suggested)
+#define MINIARGV_SUGGEST_MAX_LENGTH 128
+
+/* node of BK-tree (children are at a distinct edit distance from their parent) */
+struct miniargv_bktree_node_struct {
+  const miniargv_definition* argdef;
+  size_t longarglen;
+  int position;                     //position in lookup index (suggestions at the same distance are ordered like the definitions)
+  int distance;                     //edit distance to parent
+  int firstchild;                   //index of first child + 1, or 0 if there are none
+  int nextsibling;                  //index of next child of the same parent + 1, or 0 if there are none
+};
+
+/* BK-tree of long argument names for a definition table */
+struct miniargv_bktree_struct {
+  struct miniargv_cache_object_struct header;
+  int count;                        //number of nodes (the first one is the root)
+  struct miniargv_bktree_node_struct* nodes;
+};
+
+/* edit distance (Levenshtein) between two names of at most MINIARGV_SUGGEST_MAX_LENGTH characters */
+static int miniargv_suggest_distance (const char* a, size_t alen, const char* b, size_t blen)
+{
+  int row[MINIARGV_SUGGEST_MAX_LENGTH + 1];
+  int diagonal;
+  int above;
+  size_t i;
+  size_t j;
+  for (j = 0; j <= blen; j++)
+    row[j] = (int)j;
+  for (i = 1; i <= alen; i++) {
+    diagonal = row[0];
+    row[0] = (int)i;
+    for (j = 1; j <= blen; j++) {
+      above = row[j];
+      row[j] = diagonal + (a[i - 1] == b[j - 1] ? 0 : 1);
+      if (row[j] > above + 1)
+        row[j] = above + 1;
+      if (row[j] > row[j - 1] + 1)
+        row[j] = row[j - 1] + 1;
+      diagonal = above;
+    }
+  }
+  return row[blen];
+}
+
+static void miniargv_bktree_free (struct miniargv_cache_object_struct* object)
+{
+  struct miniargv_bktree_struct* bktree = (struct miniargv_bktree_struct*)object;
+  free(bktree->nodes);
+  free(bktree);
+}
+
+/* build BK-tree of long argument names in lookup index, returns NULL on error */
+static struct miniargv_bktree_struct* miniargv_bktree_build (const miniargv_definition argdef[])
+{
+  int i;
+  int node;
+  int child;
+  int distance;
+  const struct miniargv_index_struct* index;
+  struct miniargv_bktree_struct* bktree;
+  struct miniargv_bktree_node_struct* current;
+  if ((index = miniargv_index_get(argdef)) == NULL)
+    return NULL;
+  if ((bktree = (struct miniargv_bktree_struct*)calloc(1, sizeof(struct miniargv_bktree_struct))) == NULL)
+    return NULL;
+  bktree->header.key = argdef;
+  bktree->header.kind = MINIARGV_CACHE_KIND_SUGGEST;
+  bktree->header.freefn = miniargv_bktree_free;
+  if ((bktree->nodes = (struct miniargv_bktree_node_struct*)malloc((index->count + 1) * sizeof(struct miniargv_bktree_node_struct))) == NULL) {
+    miniargv_bktree_free(&bktree->header);
+    return NULL;
+  }
+  for (i = 0; i < index->count; i++) {
+    if (!index->entries[i].argdef->longarg || index->entries[i].longarglen > MINIARGV_SUGGEST_MAX_LENGTH)
+      continue;
+    current = &bktree->nodes[bktree->count];
+    current->argdef = index->entries[i].argdef;
+    current->longarglen = index->entries[i].longarglen;
+    current->position = i;
+    current->distance = 0;
+    current->firstchild = 0;
+    current->nextsibling = 0;
+    //walk down the tree to the node without a child at the same distance (names that are already in the tree are skipped, so the first definition wins)
+    node = 0;
+    distance = -1;
+    while (bktree->count > 0 && (distance = miniargv_suggest_distance(current->argdef->longarg, current->longarglen, bktree->nodes[node].argdef->longarg, bktree->nodes[node].longarglen)) != 0) {
+      child = bktree->nodes[node].firstchild;
+      while (child && bktree->nodes[child - 1].distance != distance)
+        child = bktree->nodes[child - 1].nextsibling;
+      if (!child)
+        break;
+      node = child - 1;
+    }
+    if (distance == 0)
+      continue;
+    if (bktree->count > 0) {
+      current->distance = distance;
+      current->nextsibling = bktree->nodes[node].firstchild;
+      bktree->nodes[node].firstchild = bktree->count + 1;
+    }
+    bktree->count++;
+  }
+  return bktree;
+}
+
+/* get BK-tree for definition table (built on first use and kept until invalidated), returns NULL on error (only use between miniargv_cache_enter() and miniargv_cache_leave()) */
+static const struct miniargv_bktree_struct* miniargv_bktree_get (const miniargv_definition argdef[])
+{
+  struct miniargv_bktree_struct* bktree;
+  if ((bktree = (struct miniargv_bktree_struct*)miniargv_cache_get(argdef, MINIARGV_CACHE_KIND_SUGGEST, 0)) != NULL)
+    return bktree;
+  if ((bktree = miniargv_bktree_build(argdef)) == NULL)
+    return NULL;
+  return (const struct miniargv_bktree_struct*)miniargv_cache_add(&bktree->header);
+}
+
+DLL_EXPORT_MINIARGV int miniargv_suggest (const char* name, const miniargv_definition argdef[], const miniargv_definition* suggestions[], int maxsuggestions)
+{
+  const struct miniargv_bktree_struct* bktree;
+  const struct miniargv_bktree_node_struct* node;
+  int* pending;
+  int* distances;
+  int* positions;
+  int pendingcount;
+  int count = 0;
+  int maxdistance;
+  int distance;
+  int child;
+  int i;
+  size_t len;
+  if (!name || !argdef || maxsuggestions <= 0)
+    return 0;
+  //ignore leading dashes and value of command line argument
+  if (*name == '-')
+    name++;
+  if (*name == '-')
+    name++;
+  for (len = 0; name[len] && name[len] != '='; len++)
+    ;
+  if (len < 2 || len > MINIARGV_SUGGEST_MAX_LENGTH)
+    return 0;
+  maxdistance = (len < 4 ? 1 : MINIARGV_SUGGEST_DISTANCE);
+  miniargv_cache_enter();
+  if ((bktree = miniargv_bktree_get(argdef)) == NULL || bktree->count == 0 || (pending = (int*)malloc((bktree->count + 2 * maxsuggestions) * sizeof(int))) == NULL) {
+    miniargv_cache_leave();
+    return 0;
+  }
+  distances = pending + bktree->count;
+  positions = distances + maxsuggestions;
+  //only visit children whose distance to their parent is close enough to the distance of the name to that parent (triangle inequality)
+  pending[0] = 0;
+  pendingcount = 1;
+  while (pendingcount > 0) {
+    node = &bktree->nodes[pending[--pendingcount]];
+    distance = miniargv_suggest_distance(name, len, node->argdef->longarg, node->longarglen);
+    if (distance <= maxdistance && (count < maxsuggestions || distance < distances[count - 1] || (distance == distances[count - 1] && node->position < positions[count - 1]))) {
+      //insert in suggestions ordered by distance and position
+      i = (count < maxsuggestions ? count++ : count - 1);
+      while (i > 0 && (distances[i - 1] > distance || (distances[i - 1] == distance && positions[i - 1] > node->position))) {
+        distances[i] = distances[i - 1];
+        positions[i] = positions[i - 1];
+        suggestions[i] = suggestions[i - 1];
+        i--;
+      }
+      distances[i] = distance;
+      positions[i] = node->position;
+      suggestions[i] = node->argdef;
+    }
+    for (child = node->firstchild; child; child = bktree->nodes[child - 1].nextsibling) {
+      if (bktree->nodes[child - 1].distance >= distance - maxdistance && bktree->nodes[child - 1].distance <= distance + maxdistance)
+        pending[pendingcount++] = child - 1;
+    }
+  }
+  free(pending);
+  miniargv_cache_leave();
+  return count;
+}